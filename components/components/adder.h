@@ -0,0 +1,38 @@
+#pragma once
+#include "component.h"
+#include "sample.h"
+
+
+template <class Sample>
+class BasicAdder : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in_a = 0U;
+	static constexpr unsigned in_b = 1U;
+	static constexpr unsigned out  = 0U;
+
+	BasicAdder()
+	{
+		inputs.addPort<Sample>(in_a, 10);
+		inputs.addPort<Sample>(in_b, 10);
+		outputs.addPort<Sample>(out);
+	}
+
+	virtual void initialize(void) override { return; }
+
+	virtual void process(void) override
+	{
+		// Reading one sample from both inputs
+		auto a = inputs[in_a].receive<Sample>();
+		auto b = inputs[in_b].receive<Sample>();
+
+		// Checking inputs
+		if(!a || !b) return;
+
+		// Sending the saturated sum
+		outputs[out].send<Sample>(sample_traits<Sample>::add(a.value(), b.value()));
+	}
+};
+
+typedef BasicAdder<double> Adder;
@@ -0,0 +1,249 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_ARITHMETIC_H_INCLUDED
+#define MFLOW_COMPONENTS_ARITHMETIC_H_INCLUDED
+
+// Standard includes
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "kernels.h"
+#include "sample.h"
+
+
+/**
+ * @brief   Base class of the elementwise frame arithmetic components.
+ * @details The combiner receives one frame on each of its input ports and
+ *          aligns the streams by the frame sequence numbers: frames that
+ *          are older than the newest frame at the head of any input are
+ *          dropped, so a source that skipped frames does not permanently
+ *          skew the pairing. Derived classes compute the output frame from
+ *          the aligned input frames with the vectorized kernels.
+ */
+template <class Sample, unsigned Inputs>
+class FrameCombiner : public Component {
+public:
+
+	// Port index definitions, inputs are numbered from zero
+	static constexpr unsigned out = 0U;
+
+	// Capacity of the frame input queues
+	static constexpr unsigned input_capacity = 2U;
+
+	FrameCombiner() : m_dropped(0)
+	{
+		for(unsigned i = 0; i < Inputs; i++) inputs.addPort<Frame<Sample>>(i, input_capacity);
+		outputs.addPort<Frame<Sample>>(out);
+	}
+
+	virtual void initialize(void) override { return; }
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		configure();
+
+		// Reading an aligned set of input frames
+		if(!receive_aligned()) return;
+
+		// Combining the inputs into the output frame
+		Frame<Sample> result;
+		result.sequence = m_frames[0].sequence;
+		combine(result);
+
+		outputs[out].send<Frame<Sample>>(result);
+	}
+
+	/**
+	 * @brief  Queries the number of frames dropped during stream alignment.
+	 * @retval The number of dropped input frames.
+	 */
+	unsigned dropped(void) const { return m_dropped; }
+
+protected:
+
+	/**
+	 * @brief Reads the option ports of the derived component, called before each frame.
+	 */
+	virtual void configure(void) { }
+
+	/**
+	 * @brief Computes the output frame from the aligned input frames.
+	 * @param result [out] The output frame, its sequence number is already set.
+	 */
+	virtual void combine(Frame<Sample>& result) = 0;
+
+	Frame<Sample> m_frames[Inputs]; /**< The aligned input frames. */
+
+private:
+
+	bool receive(unsigned index)
+	{
+		auto frame = inputs[index].receive<Frame<Sample>>();
+		if(!frame) return false;
+
+		m_frames[index] = frame.value();
+		return true;
+	}
+
+	bool receive_aligned(void)
+	{
+		for(unsigned i = 0; i < Inputs; i++)
+		{
+			if(!receive(i)) return false;
+		}
+
+		while(true)
+		{
+			// Finding the newest frame, sequence numbers may wrap around
+			uint32_t newest = m_frames[0].sequence;
+			for(unsigned i = 1; i < Inputs; i++)
+			{
+				if((int32_t) (m_frames[i].sequence - newest) > 0) newest = m_frames[i].sequence;
+			}
+
+			// Dropping the frames older than the newest one
+			bool aligned = true;
+			for(unsigned i = 0; i < Inputs; i++)
+			{
+				while((int32_t) (m_frames[i].sequence - newest) < 0)
+				{
+					m_dropped++;
+					if(!receive(i)) return false;
+				}
+
+				if(m_frames[i].sequence != newest) aligned = false;
+			}
+
+			if(aligned) return true;
+		}
+	}
+
+	unsigned m_dropped;
+};
+
+/**
+ * @brief Sums the frames of all inputs elementwise.
+ */
+template <class Sample, unsigned Inputs>
+class BasicFrameAdd : public FrameCombiner<Sample, Inputs> {
+
+	static_assert(Inputs >= 2, "At least two inputs are required.");
+
+protected:
+	virtual void combine(Frame<Sample>& result) override
+	{
+		vector_add(this->m_frames[0].samples, this->m_frames[1].samples, result.samples, Frame<Sample>::length);
+		for(unsigned i = 2; i < Inputs; i++) vector_add(result.samples, this->m_frames[i].samples, result.samples, Frame<Sample>::length);
+	}
+};
+
+/**
+ * @brief Subtracts the frames of the second input from the first one elementwise.
+ */
+template <class Sample>
+class BasicFrameSubtract : public FrameCombiner<Sample, 2> {
+protected:
+	virtual void combine(Frame<Sample>& result) override
+	{
+		vector_sub(this->m_frames[0].samples, this->m_frames[1].samples, result.samples, Frame<Sample>::length);
+	}
+};
+
+/**
+ * @brief Multiplies the frames of all inputs elementwise.
+ */
+template <class Sample, unsigned Inputs>
+class BasicFrameMultiply : public FrameCombiner<Sample, Inputs> {
+
+	static_assert(Inputs >= 2, "At least two inputs are required.");
+
+protected:
+	virtual void combine(Frame<Sample>& result) override
+	{
+		vector_mul(this->m_frames[0].samples, this->m_frames[1].samples, result.samples, Frame<Sample>::length);
+		for(unsigned i = 2; i < Inputs; i++) vector_mul(result.samples, this->m_frames[i].samples, result.samples, Frame<Sample>::length);
+	}
+};
+
+/**
+ * @brief Multiplies the input frames with a gain received on an option port.
+ */
+template <class Sample>
+class BasicFrameScale : public FrameCombiner<Sample, 1> {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in   = 0U;
+	static constexpr unsigned gain = 1U;
+
+	BasicFrameScale() : m_gain(1.0f)
+	{
+		this->inputs.template addPort<float>(gain, 1);
+	}
+
+protected:
+	virtual void configure(void) override
+	{
+		if(this->inputs[gain].has_message())
+		{
+			auto value = this->inputs[gain].template receive<float>();
+			if(value) m_gain = value.value();
+		}
+	}
+
+	virtual void combine(Frame<Sample>& result) override
+	{
+		vector_scale(this->m_frames[0].samples, m_gain, result.samples, Frame<Sample>::length);
+	}
+
+private:
+	float m_gain;
+};
+
+/**
+ * @brief Gains of a mixer, one for every input.
+ */
+template <unsigned Inputs>
+struct MixGains {
+	float gain[Inputs]; /**< The gain applied to each input. */
+};
+
+/**
+ * @brief Sums the input frames weighted with gains received on an option port.
+ */
+template <class Sample, unsigned Inputs>
+class BasicFrameMix : public FrameCombiner<Sample, Inputs> {
+public:
+
+	// Port index definitions, the option port follows the inputs
+	static constexpr unsigned gains = Inputs;
+
+	BasicFrameMix()
+	{
+		this->inputs.template addPort<MixGains<Inputs>>(gains, 1);
+		for(unsigned i = 0; i < Inputs; i++) m_gains.gain[i] = 1.0f;
+	}
+
+protected:
+	virtual void configure(void) override
+	{
+		if(this->inputs[gains].has_message())
+		{
+			auto value = this->inputs[gains].template receive<MixGains<Inputs>>();
+			if(value) m_gains = value.value();
+		}
+	}
+
+	virtual void combine(Frame<Sample>& result) override
+	{
+		vector_scale(this->m_frames[0].samples, m_gains.gain[0], result.samples, Frame<Sample>::length);
+		for(unsigned i = 1; i < Inputs; i++) vector_mac(this->m_frames[i].samples, m_gains.gain[i], result.samples, Frame<Sample>::length);
+	}
+
+private:
+	MixGains<Inputs> m_gains;
+};
+
+#endif // MFLOW_COMPONENTS_ARITHMETIC_H_INCLUDED
@@ -0,0 +1,189 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_BIQUAD_H_INCLUDED
+#define MFLOW_COMPONENTS_BIQUAD_H_INCLUDED
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "sample.h"
+
+
+// Maximum number of second order sections in a cascade
+#ifndef MFLOW_BIQUAD_MAX_SECTIONS
+#define MFLOW_BIQUAD_MAX_SECTIONS (8)
+#endif
+
+// Maximum number of interleaved channels in a frame
+#ifndef MFLOW_BIQUAD_MAX_CHANNELS
+#define MFLOW_BIQUAD_MAX_CHANNELS (4)
+#endif
+
+/**
+ * @brief Coefficients of a second order section, normalized to a0 = 1.
+ */
+struct BiquadSection {
+	float b0; /**< Feedforward coefficient of x[n].     */
+	float b1; /**< Feedforward coefficient of x[n - 1]. */
+	float b2; /**< Feedforward coefficient of x[n - 2]. */
+	float a1; /**< Feedback coefficient of y[n - 1].    */
+	float a2; /**< Feedback coefficient of y[n - 2].    */
+};
+
+/**
+ * @brief Coefficients of a biquad cascade, sent on the coefficients option port.
+ */
+struct BiquadCoefficients {
+	unsigned      sections;                           /**< The number of valid sections.   */
+	BiquadSection section[MFLOW_BIQUAD_MAX_SECTIONS]; /**< The sections in filtering order. */
+};
+
+/**
+ * @brief   Arithmetic used by the biquad sections for a sample type.
+ * @details Double precision samples are filtered in double precision, all
+ *          other sample types in single precision, because the recursive
+ *          structure is sensitive to the quantization of fixed-point state.
+ */
+template <class Sample>
+struct biquad_arithmetic {
+	typedef float real;
+	static inline real   load(const Sample& sample) { return sample_traits<Sample>::to_float(sample); }
+	static inline Sample store(real value)          { return sample_traits<Sample>::from_float(value); }
+};
+
+template <>
+struct biquad_arithmetic<double> {
+	typedef double real;
+	static inline real   load(const double& sample) { return sample; }
+	static inline double store(real value)          { return value; }
+};
+
+/**
+ * @brief   IIR filter built from a cascade of biquad sections.
+ * @details The sections use the transposed direct form II structure. The
+ *          input frames may carry several interleaved channels, which are
+ *          filtered independently with the same coefficients. The frame is
+ *          processed one section at a time, so the coefficients of a section
+ *          are loaded once per frame instead of once per sample. When the
+ *          frame length is not a multiple of the channel count, the channel
+ *          position carries over to the next frame.
+ */
+template <class Sample>
+class BasicBiquadCascade : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in           = 0U;
+	static constexpr unsigned coefficients = 1U;
+	static constexpr unsigned channels     = 2U;
+	static constexpr unsigned out          = 0U;
+
+	typedef typename biquad_arithmetic<Sample>::real real;
+
+	BasicBiquadCascade() : m_channels(1), m_channel(0)
+	{
+		inputs.addPort<Frame<Sample>>(in, 2);
+		inputs.addPort<BiquadCoefficients>(coefficients, 1);
+		inputs.addPort<unsigned>(channels, 1);
+		outputs.addPort<Frame<Sample>>(out);
+
+		m_coefficients.sections = 0;
+		reset();
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the initial coefficients
+		auto value = inputs[coefficients].receive<BiquadCoefficients>();
+		if(value) set_coefficients(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes, the state is kept when only the coefficients change
+		if(inputs[coefficients].has_message())
+		{
+			auto value = inputs[coefficients].receive<BiquadCoefficients>();
+			if(value) set_coefficients(value.value());
+		}
+
+		if(inputs[channels].has_message())
+		{
+			auto value = inputs[channels].receive<unsigned>();
+			if(value)
+			{
+				m_channels = value.value() == 0 ? 1U : value.value() > MFLOW_BIQUAD_MAX_CHANNELS ? MFLOW_BIQUAD_MAX_CHANNELS : value.value();
+				reset();
+			}
+		}
+
+		// Reading the next input frame
+		auto frame = inputs[in].receive<Frame<Sample>>();
+		if(!frame) return;
+
+		const std::size_t length = Frame<Sample>::length;
+		real              work[length];
+
+		for(std::size_t i = 0; i < length; i++) work[i] = biquad_arithmetic<Sample>::load(frame.value()[i]);
+
+		// Filtering the whole frame with one section after the other
+		for(unsigned s = 0; s < m_coefficients.sections; s++)
+		{
+			const real b0 = m_coefficients.section[s].b0;
+			const real b1 = m_coefficients.section[s].b1;
+			const real b2 = m_coefficients.section[s].b2;
+			const real a1 = m_coefficients.section[s].a1;
+			const real a2 = m_coefficients.section[s].a2;
+
+			real*    z1      = m_z1[s];
+			real*    z2      = m_z2[s];
+			unsigned channel = m_channel;
+
+			for(std::size_t i = 0; i < length; i++)
+			{
+				const real x = work[i];
+				const real y = b0 * x + z1[channel];
+
+				z1[channel] = b1 * x - a1 * y + z2[channel];
+				z2[channel] = b2 * x - a2 * y;
+				work[i]     = y;
+
+				if(++channel == m_channels) channel = 0;
+			}
+		}
+
+		m_channel = (unsigned) ((m_channel + length) % m_channels);
+
+		Frame<Sample> output;
+		output.sequence = frame.value().sequence;
+
+		for(std::size_t i = 0; i < length; i++) output[i] = biquad_arithmetic<Sample>::store(work[i]);
+
+		outputs[out].send<Frame<Sample>>(output);
+	}
+
+private:
+
+	void set_coefficients(const BiquadCoefficients& value)
+	{
+		m_coefficients = value;
+		if(m_coefficients.sections > MFLOW_BIQUAD_MAX_SECTIONS) m_coefficients.sections = MFLOW_BIQUAD_MAX_SECTIONS;
+	}
+
+	void reset(void)
+	{
+		m_channel = 0;
+
+		for(unsigned s = 0; s < MFLOW_BIQUAD_MAX_SECTIONS; s++)
+		{
+			for(unsigned c = 0; c < MFLOW_BIQUAD_MAX_CHANNELS; c++) m_z1[s][c] = m_z2[s][c] = 0;
+		}
+	}
+
+	BiquadCoefficients m_coefficients;
+	real               m_z1[MFLOW_BIQUAD_MAX_SECTIONS][MFLOW_BIQUAD_MAX_CHANNELS];
+	real               m_z2[MFLOW_BIQUAD_MAX_SECTIONS][MFLOW_BIQUAD_MAX_CHANNELS];
+	unsigned           m_channels;
+	unsigned           m_channel;
+};
+
+#endif // MFLOW_COMPONENTS_BIQUAD_H_INCLUDED
@@ -0,0 +1,170 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_ENVELOPE_H_INCLUDED
+#define MFLOW_COMPONENTS_ENVELOPE_H_INCLUDED
+
+// Standard includes
+#include <cmath>
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "kernels.h"
+#include "sample.h"
+
+
+/**
+ * @brief Sum of squares of samples, using the vectorized dot product kernels.
+ */
+template <class Sample>
+inline double block_energy(const Sample* samples, float* work, std::size_t length)
+{
+	// Converting to single precision for the vectorized kernel
+	for(std::size_t i = 0; i < length; i++) work[i] = sample_traits<Sample>::to_float(samples[i]);
+	return vector_dot(work, work, length);
+}
+
+inline double block_energy(const float* samples, float*, std::size_t length)
+{
+	return vector_dot(samples, samples, length);
+}
+
+inline double block_energy(const double* samples, float*, std::size_t length)
+{
+	return vector_dot(samples, samples, length);
+}
+
+/**
+ * @brief   Envelope follower and block RMS detector operating on frames.
+ * @details The envelope follows the rectified signal with separate attack
+ *          and release time constants given in samples, zero follows the
+ *          signal instantly. The RMS is computed over blocks of samples with
+ *          the vectorized dot product kernel, blocks may span several frames.
+ *          At the end of every block the RMS and the current envelope are
+ *          sent to the connected outputs, so the outputs run at the block
+ *          rate instead of the sample rate.
+ */
+template <class Sample>
+class BasicEnvelope : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in       = 0U;
+	static constexpr unsigned attack   = 1U;
+	static constexpr unsigned release  = 2U;
+	static constexpr unsigned block    = 3U;
+	static constexpr unsigned envelope = 0U;
+	static constexpr unsigned rms      = 1U;
+
+	BasicEnvelope()
+		: m_attack(1.0f),
+		  m_release(1.0f),
+		  m_envelope(0.0f),
+		  m_block(Frame<Sample>::length),
+		  m_filled(0),
+		  m_energy(0.0)
+	{
+		inputs.addPort<Frame<Sample>>(in, 2);
+		inputs.addPort<float>(attack, 1);
+		inputs.addPort<float>(release, 1);
+		inputs.addPort<unsigned>(block, 1);
+		outputs.addPort<Sample>(envelope);
+		outputs.addPort<Sample>(rms);
+	}
+
+	virtual void initialize(void) override { return; }
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[attack].has_message())
+		{
+			auto value = inputs[attack].receive<float>();
+			if(value) m_attack = coefficient(value.value());
+		}
+
+		if(inputs[release].has_message())
+		{
+			auto value = inputs[release].receive<float>();
+			if(value) m_release = coefficient(value.value());
+		}
+
+		if(inputs[block].has_message())
+		{
+			auto value = inputs[block].receive<unsigned>();
+			if(value)
+			{
+				m_block  = value.value() ? value.value() : 1U;
+				m_filled = 0;
+				m_energy = 0.0;
+			}
+		}
+
+		// Reading the next input frame
+		auto frame = inputs[in].receive<Frame<Sample>>();
+		if(!frame) return;
+
+		const Sample* samples = frame.value().samples;
+		std::size_t   start   = 0;
+
+		while(start < Frame<Sample>::length)
+		{
+			// Processing the part of the frame up to the end of the block
+			std::size_t length = Frame<Sample>::length - start;
+			if(length > m_block - m_filled) length = m_block - m_filled;
+
+			m_energy += block_energy(samples + start, m_work, length);
+
+			for(std::size_t i = start; i < start + length; i++)
+			{
+				const float x = std::fabs(sample_traits<Sample>::to_float(samples[i]));
+				m_envelope += (x > m_envelope ? m_attack : m_release) * (x - m_envelope);
+			}
+
+			start    += length;
+			m_filled += (unsigned) length;
+
+			if(m_filled == m_block && !emit()) return;
+		}
+	}
+
+private:
+
+	// Smoothing coefficient of a time constant in samples
+	static float coefficient(float samples)
+	{
+		return samples > 0.0f ? 1.0f - std::exp(-1.0f / samples) : 1.0f;
+	}
+
+	bool emit(void)
+	{
+		const float value = (float) std::sqrt(m_energy / m_block);
+
+		m_filled = 0;
+		m_energy = 0.0;
+
+		if(outputs[rms].is_connected())
+		{
+			if(outputs[rms].send<Sample>(sample_traits<Sample>::from_float(value)) != MessageStatus::Okay) return false;
+		}
+
+		if(outputs[envelope].is_connected())
+		{
+			if(outputs[envelope].send<Sample>(sample_traits<Sample>::from_float(m_envelope)) != MessageStatus::Okay) return false;
+		}
+
+		return true;
+	}
+
+	float    m_work[Frame<Sample>::length];
+	float    m_attack;
+	float    m_release;
+	float    m_envelope;
+	unsigned m_block;
+	unsigned m_filled;
+	double   m_energy;
+};
+
+typedef BasicEnvelope<double> Envelope;
+
+#endif // MFLOW_COMPONENTS_ENVELOPE_H_INCLUDED
@@ -0,0 +1,376 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_FFT_H_INCLUDED
+#define MFLOW_COMPONENTS_FFT_H_INCLUDED
+
+// Standard includes
+#include <cmath>
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "sample.h"
+
+
+// Maximum transform size of the FFT components
+#ifndef MFLOW_FFT_MAX_SIZE
+#define MFLOW_FFT_MAX_SIZE (512)
+#endif
+
+/**
+ * @brief Window functions applied to the samples before the transform.
+ */
+enum FftWindow : unsigned {
+	FftWindowRectangular = 0U, /**< No windowing.          */
+	FftWindowHann        = 1U, /**< Hann (raised cosine).  */
+	FftWindowHamming     = 2U, /**< Hamming.               */
+	FftWindowBlackman    = 3U  /**< Blackman.              */
+};
+
+/**
+ * @brief Output formats of the FFT components.
+ */
+enum FftFormat : unsigned {
+	FftFormatMagnitude = 0U, /**< One magnitude value per bin.                 */
+	FftFormatComplex   = 1U  /**< Interleaved real and imaginary parts per bin. */
+};
+
+/**
+ * @brief   Spectrum of one block of samples.
+ * @details Contains the bins from DC up to the Nyquist frequency, that is
+ *          size / 2 + 1 values in magnitude format or twice as many in the
+ *          complex format. The bins are not normalized by the size.
+ */
+struct Spectrum {
+	uint32_t sequence;                        /**< Sequence number of the spectrum.       */
+	unsigned bins;                            /**< The number of frequency bins.          */
+	unsigned format;                          /**< The format of the values (FftFormat).  */
+	float    values[MFLOW_FFT_MAX_SIZE + 2];  /**< The bins in the format specified.      */
+};
+
+/**
+ * @brief   Real-input FFT with precomputed twiddle factors.
+ * @details A real block of size N is transformed with an in-place iterative
+ *          radix-2 complex FFT of size N / 2, by packing the even samples
+ *          into the real and the odd samples into the imaginary parts. The
+ *          spectrum of the real block is then recovered with one additional
+ *          pass using the same twiddle table. The table and the window are
+ *          only recomputed when the configuration changes.
+ */
+class FftKernel {
+public:
+
+	FftKernel(void) : m_size(0), m_window_type(FftWindowRectangular) { }
+
+	/**
+	 * @brief  Configures the transform size and the window function.
+	 * @param  size   [in] The transform size, a power of two from 4 up to MFLOW_FFT_MAX_SIZE.
+	 * @param  window [in] The window function (FftWindow).
+	 * @retval True when the configuration is valid, false otherwise.
+	 */
+	bool configure(unsigned size, unsigned window)
+	{
+		// Checking the transform size
+		if(size < 4 || size > MFLOW_FFT_MAX_SIZE || (size & (size - 1)) != 0) return false;
+
+		bool rebuild_window = window != m_window_type;
+
+		if(size != m_size)
+		{
+			m_size         = size;
+			rebuild_window = true;
+
+			// Twiddle factors exp(-2 pi i k / N) for the first half period
+			for(unsigned k = 0; k < size / 2; k++)
+			{
+				m_twiddle_re[k] = (float)  std::cos(6.283185307179586 * k / size);
+				m_twiddle_im[k] = (float) -std::sin(6.283185307179586 * k / size);
+			}
+		}
+
+		if(rebuild_window)
+		{
+			m_window_type = window;
+
+			for(unsigned n = 0; n < size; n++)
+			{
+				const double phase = 6.283185307179586 * n / size;
+
+				switch(window)
+				{
+					case FftWindowHann:     m_window[n] = (float) (0.5  - 0.5  * std::cos(phase)); break;
+					case FftWindowHamming:  m_window[n] = (float) (0.54 - 0.46 * std::cos(phase)); break;
+					case FftWindowBlackman: m_window[n] = (float) (0.42 - 0.5  * std::cos(phase) + 0.08 * std::cos(2.0 * phase)); break;
+					default:                m_window[n] = 1.0f; break;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief  Queries the configured transform size.
+	 * @retval The number of samples in one block.
+	 */
+	unsigned size(void) const { return m_size; }
+
+	/**
+	 * @brief Transforms one block of real samples.
+	 * @param input  [in]  The size samples of the block, the window is applied here.
+	 * @param out_re [out] The real parts of the size / 2 + 1 bins.
+	 * @param out_im [out] The imaginary parts of the size / 2 + 1 bins.
+	 */
+	void transform(const float* input, float* out_re, float* out_im)
+	{
+		const unsigned half = m_size / 2;
+
+		// Packing the windowed samples in bit-reversed order
+		unsigned bits = 0;
+		while((1U << bits) < half) bits++;
+
+		for(unsigned k = 0; k < half; k++)
+		{
+			unsigned reversed = 0;
+			for(unsigned b = 0; b < bits; b++) reversed |= ((k >> b) & 1U) << (bits - 1 - b);
+
+			m_re[reversed] = input[2 * k]     * m_window[2 * k];
+			m_im[reversed] = input[2 * k + 1] * m_window[2 * k + 1];
+		}
+
+		// Radix-2 butterflies of the half size complex transform
+		for(unsigned length = 2; length <= half; length <<= 1)
+		{
+			const unsigned stride = m_size / length;
+
+			for(unsigned start = 0; start < half; start += length)
+			{
+				for(unsigned j = 0; j < length / 2; j++)
+				{
+					const float    w_re = m_twiddle_re[j * stride];
+					const float    w_im = m_twiddle_im[j * stride];
+					const unsigned a    = start + j;
+					const unsigned b    = a + length / 2;
+
+					const float t_re = m_re[b] * w_re - m_im[b] * w_im;
+					const float t_im = m_re[b] * w_im + m_im[b] * w_re;
+
+					m_re[b] = m_re[a] - t_re;
+					m_im[b] = m_im[a] - t_im;
+					m_re[a] = m_re[a] + t_re;
+					m_im[a] = m_im[a] + t_im;
+				}
+			}
+		}
+
+		// Separating the spectra of the even and odd samples
+		out_re[0]    = m_re[0] + m_im[0];
+		out_im[0]    = 0.0f;
+		out_re[half] = m_re[0] - m_im[0];
+		out_im[half] = 0.0f;
+
+		for(unsigned k = 1; k < half; k++)
+		{
+			const float z_re = m_re[k];
+			const float z_im = m_im[k];
+			const float c_re = m_re[half - k];
+			const float c_im = -m_im[half - k];
+
+			// Even part (Z[k] + conj(Z[N/2 - k])) / 2, odd part (Z[k] - conj(Z[N/2 - k])) / 2i
+			const float e_re = 0.5f * (z_re + c_re);
+			const float e_im = 0.5f * (z_im + c_im);
+			const float o_re = 0.5f * (z_im - c_im);
+			const float o_im = -0.5f * (z_re - c_re);
+
+			out_re[k] = e_re + m_twiddle_re[k] * o_re - m_twiddle_im[k] * o_im;
+			out_im[k] = e_im + m_twiddle_re[k] * o_im + m_twiddle_im[k] * o_re;
+		}
+	}
+
+private:
+	unsigned m_size;                                /**< The transform size.                     */
+	unsigned m_window_type;                         /**< The window function of the table.       */
+	float    m_window[MFLOW_FFT_MAX_SIZE];          /**< The window function samples.            */
+	float    m_twiddle_re[MFLOW_FFT_MAX_SIZE / 2];  /**< Real parts of the twiddle factors.      */
+	float    m_twiddle_im[MFLOW_FFT_MAX_SIZE / 2];  /**< Imaginary parts of the twiddle factors. */
+	float    m_re[MFLOW_FFT_MAX_SIZE / 2];          /**< Real parts of the working buffer.       */
+	float    m_im[MFLOW_FFT_MAX_SIZE / 2];          /**< Imaginary parts of the working buffer.  */
+};
+
+/**
+ * @brief   Spectral analysis component computing the FFT of overlapping blocks.
+ * @details The incoming frames are collected into a sliding block of the
+ *          configured size, and a spectrum is emitted every hop samples once
+ *          the block is full. A hop smaller than the size yields overlapping
+ *          blocks, a larger hop skips samples between the blocks. A change of
+ *          the size scales the hop by the same ratio, so the overlap between
+ *          the blocks is kept.
+ */
+template <class Sample>
+class BasicFftAnalyzer : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in     = 0U;
+	static constexpr unsigned size   = 1U;
+	static constexpr unsigned window = 2U;
+	static constexpr unsigned hop    = 3U;
+	static constexpr unsigned format = 4U;
+	static constexpr unsigned out    = 0U;
+
+	BasicFftAnalyzer()
+		: m_size(0),
+		  m_window(FftWindowHann),
+		  m_hop(0),
+		  m_format(FftFormatMagnitude),
+		  m_position(0),
+		  m_filled(0),
+		  m_pending(0),
+		  m_sequence(0)
+	{
+		inputs.addPort<Frame<Sample>>(in, 2);
+		inputs.addPort<unsigned>(size, 1);
+		inputs.addPort<unsigned>(window, 1);
+		inputs.addPort<unsigned>(hop, 1);
+		inputs.addPort<unsigned>(format, 1);
+		outputs.addPort<Spectrum>(out);
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the transform size, the other options are optional
+		auto value = inputs[size].receive<unsigned>();
+		if(value) set_size(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		configure();
+
+		// Reading the next input frame
+		auto frame = inputs[in].receive<Frame<Sample>>();
+		if(!frame) return;
+
+		if(m_size == 0) return;
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+		{
+			// Storing the sample in the sliding block
+			m_samples[m_position] = sample_traits<Sample>::to_float(frame.value()[i]);
+			if(++m_position == m_size) m_position = 0;
+			if(m_filled < m_size) m_filled++;
+
+			// Emitting a spectrum every hop samples
+			if(++m_pending >= m_hop && m_filled == m_size)
+			{
+				m_pending = 0;
+				if(analyze() != MessageStatus::Okay) return;
+			}
+		}
+	}
+
+private:
+
+	void configure(void)
+	{
+		if(inputs[size].has_message())
+		{
+			auto value = inputs[size].receive<unsigned>();
+			if(value) set_size(value.value());
+		}
+
+		if(inputs[window].has_message())
+		{
+			auto value = inputs[window].receive<unsigned>();
+			if(value)
+			{
+				m_window = value.value();
+				m_kernel.configure(m_size, m_window);
+			}
+		}
+
+		if(inputs[hop].has_message())
+		{
+			auto value = inputs[hop].receive<unsigned>();
+			if(value) m_hop = value.value() ? value.value() : m_size;
+		}
+
+		if(inputs[format].has_message())
+		{
+			auto value = inputs[format].receive<unsigned>();
+			if(value) m_format = value.value();
+		}
+	}
+
+	void set_size(unsigned value)
+	{
+		if(!m_kernel.configure(value, m_window)) return;
+
+		// Restarting the block collection, the hop is scaled with the size to keep the overlap ratio
+		if(m_hop == 0)
+		{
+			m_hop = value;
+		}
+		else if(m_size != 0)
+		{
+			const uint64_t scaled = (uint64_t) m_hop * value / m_size;
+			m_hop = scaled > 0 ? (unsigned) scaled : 1U;
+		}
+
+		m_size     = value;
+		m_position = 0;
+		m_filled   = 0;
+		m_pending  = 0;
+	}
+
+	MessageStatus analyze(void)
+	{
+		// Unrolling the sliding block in chronological order
+		for(unsigned n = 0, p = m_position; n < m_size; n++)
+		{
+			m_block[n] = m_samples[p];
+			if(++p == m_size) p = 0;
+		}
+
+		const unsigned bins = m_size / 2 + 1;
+
+		m_kernel.transform(m_block, m_re, m_im);
+
+		m_spectrum.sequence = m_sequence++;
+		m_spectrum.bins     = bins;
+		m_spectrum.format   = m_format;
+
+		for(unsigned k = 0; k < bins; k++)
+		{
+			if(m_format == FftFormatComplex)
+			{
+				m_spectrum.values[2 * k]     = m_re[k];
+				m_spectrum.values[2 * k + 1] = m_im[k];
+			}
+			else
+			{
+				m_spectrum.values[k] = std::sqrt(m_re[k] * m_re[k] + m_im[k] * m_im[k]);
+			}
+		}
+
+		return outputs[out].send<Spectrum>(m_spectrum);
+	}
+
+	FftKernel m_kernel;
+	Spectrum  m_spectrum;
+	float     m_samples[MFLOW_FFT_MAX_SIZE];
+	float     m_block[MFLOW_FFT_MAX_SIZE];
+	float     m_re[MFLOW_FFT_MAX_SIZE / 2 + 1];
+	float     m_im[MFLOW_FFT_MAX_SIZE / 2 + 1];
+	unsigned  m_size;
+	unsigned  m_window;
+	unsigned  m_hop;
+	unsigned  m_format;
+	unsigned  m_position;
+	unsigned  m_filled;
+	unsigned  m_pending;
+	uint32_t  m_sequence;
+};
+
+#endif // MFLOW_COMPONENTS_FFT_H_INCLUDED
@@ -0,0 +1,378 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_FIR_H_INCLUDED
+#define MFLOW_COMPONENTS_FIR_H_INCLUDED
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "kernels.h"
+#include "sample.h"
+
+
+// Maximum number of taps of the FIR filters
+#ifndef MFLOW_FIR_MAX_TAPS
+#define MFLOW_FIR_MAX_TAPS (128)
+#endif
+
+// Maximum rate change factor of the polyphase filters
+#ifndef MFLOW_FIR_MAX_FACTOR
+#define MFLOW_FIR_MAX_FACTOR (16)
+#endif
+
+/**
+ * @brief   Coefficients of a FIR filter, sent on the taps option port.
+ * @details The taps are always specified in single precision, filters with
+ *          fixed-point samples convert them to their sample type, so the
+ *          taps of those filters must lie in the [-1, 1) range.
+ */
+struct FirTaps {
+	unsigned count;                     /**< The number of valid taps.           */
+	float    taps[MFLOW_FIR_MAX_TAPS];  /**< The impulse response of the filter. */
+};
+
+/**
+ * @brief   Delay line of a FIR filter.
+ * @details Every sample is stored twice, one length apart, so the most
+ *          recent samples are always available as one contiguous window
+ *          in chronological order. This lets the filters compute outputs
+ *          with a single vectorized inner product instead of wrapping the
+ *          index of a circular buffer for every tap.
+ */
+template <class Sample>
+class FirHistory {
+public:
+
+	FirHistory(void) : m_length(0), m_position(0) { }
+
+	/**
+	 * @brief Resizes the delay line and clears its contents.
+	 * @param length [in] The number of samples in the window.
+	 */
+	void reset(unsigned length)
+	{
+		m_length   = length;
+		m_position = 0;
+
+		for(unsigned i = 0; i < 2 * length; i++) m_values[i] = sample_traits<Sample>::zero();
+	}
+
+	/**
+	 * @brief Pushes a new sample into the delay line, discarding the oldest one.
+	 * @param sample [in] The sample to push.
+	 */
+	void push(const Sample& sample)
+	{
+		m_values[m_position]            = sample;
+		m_values[m_position + m_length] = sample;
+
+		if(++m_position == m_length) m_position = 0;
+	}
+
+	/**
+	 * @brief  Queries the window of the most recent samples.
+	 * @retval Pointer to the oldest sample, followed by the newer ones.
+	 */
+	const Sample* window(void) const
+	{
+		return m_values + m_position;
+	}
+
+private:
+	Sample   m_values[2 * MFLOW_FIR_MAX_TAPS]; /**< The samples stored twice.           */
+	unsigned m_length;                         /**< The number of samples in the window. */
+	unsigned m_position;                       /**< The position of the next sample.     */
+};
+
+/**
+ * @brief   Base class of the FIR filter components.
+ * @details Stores the time-reversed taps converted to the sample type, so
+ *          an output sample is the inner product of the taps and the
+ *          window of the delay line.
+ */
+template <class Sample>
+class FirBase : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in   = 0U;
+	static constexpr unsigned taps = 1U;
+	static constexpr unsigned out  = 0U;
+
+	FirBase() : m_count(0)
+	{
+		inputs.addPort<Frame<Sample>>(in, 2);
+		inputs.addPort<FirTaps>(taps, 1);
+		outputs.addPort<Frame<Sample>>(out);
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the initial taps
+		auto value = inputs[taps].receive<FirTaps>();
+		if(value) set_taps(value.value());
+	}
+
+protected:
+
+	/**
+	 * @brief Reads the option ports, called before each input frame.
+	 */
+	virtual void configure(void)
+	{
+		if(inputs[taps].has_message())
+		{
+			auto value = inputs[taps].receive<FirTaps>();
+			if(value) set_taps(value.value());
+		}
+	}
+
+	/**
+	 * @brief Applies a new set of taps and clears the filter state.
+	 * @param value [in] The taps received on the option port.
+	 */
+	virtual void set_taps(const FirTaps& value)
+	{
+		m_count = value.count < MFLOW_FIR_MAX_TAPS ? value.count : MFLOW_FIR_MAX_TAPS;
+
+		// Filters without taps pass the input through
+		if(m_count == 0)
+		{
+			m_count   = 1;
+			m_taps[0] = sample_traits<Sample>::from_float(1.0f);
+		}
+		else
+		{
+			for(unsigned i = 0; i < m_count; i++) m_taps[i] = sample_traits<Sample>::from_float(value.taps[m_count - 1 - i]);
+		}
+
+		m_history.reset(m_count);
+	}
+
+	FirHistory<Sample> m_history;                  /**< The delay line of the filter. */
+	Sample             m_taps[MFLOW_FIR_MAX_TAPS]; /**< The time-reversed taps.       */
+	unsigned           m_count;                    /**< The number of taps.           */
+};
+
+/**
+ * @brief Filters frames of samples with a FIR filter, one output sample per input sample.
+ */
+template <class Sample>
+class BasicFirFilter : public FirBase<Sample> {
+public:
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		this->configure();
+
+		// Reading the next input frame
+		auto frame = this->inputs[this->in].template receive<Frame<Sample>>();
+		if(!frame) return;
+
+		Frame<Sample> output;
+		output.sequence = frame.value().sequence;
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+		{
+			this->m_history.push(frame.value()[i]);
+			output[i] = vector_dot(this->m_taps, this->m_history.window(), this->m_count);
+		}
+
+		this->outputs[this->out].template send<Frame<Sample>>(output);
+	}
+};
+
+/**
+ * @brief   Decimating FIR filter, one output sample for every factor input samples.
+ * @details Only the retained output samples are computed, which is the
+ *          polyphase decomposition of the decimating filter expressed on
+ *          the input delay line.
+ */
+template <class Sample>
+class BasicFirDecimator : public FirBase<Sample> {
+public:
+
+	// Port index definitions
+	static constexpr unsigned factor = 2U;
+
+	BasicFirDecimator() : m_factor(1), m_phase(0)
+	{
+		this->inputs.template addPort<unsigned>(factor, 1);
+	}
+
+	virtual void initialize(void) override
+	{
+		FirBase<Sample>::initialize();
+
+		auto value = this->inputs[factor].template receive<unsigned>();
+		if(value) set_factor(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		this->configure();
+
+		if(this->inputs[factor].has_message())
+		{
+			auto value = this->inputs[factor].template receive<unsigned>();
+			if(value) set_factor(value.value());
+		}
+
+		// Reading the next input frame
+		auto frame = this->inputs[this->in].template receive<Frame<Sample>>();
+		if(!frame) return;
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+		{
+			this->m_history.push(frame.value()[i]);
+
+			// Computing only the retained output samples
+			if(++m_phase < m_factor) continue;
+			m_phase = 0;
+
+			if(m_output.append(vector_dot(this->m_taps, this->m_history.window(), this->m_count)))
+			{
+				if(this->outputs[this->out].template send<Frame<Sample>>(m_output.frame()) != MessageStatus::Okay) return;
+				m_output.next();
+			}
+		}
+	}
+
+private:
+
+	void set_factor(unsigned value)
+	{
+		m_factor = value ? value : 1U;
+		m_phase  = 0;
+	}
+
+	FrameAssembler<Sample> m_output;
+	unsigned               m_factor;
+	unsigned               m_phase;
+};
+
+/**
+ * @brief   Interpolating polyphase FIR filter, factor output samples for every input sample.
+ * @details The taps are split into factor subfilters, each one computing
+ *          one phase of the output from the input delay line, so the
+ *          zero-stuffed samples are never multiplied. The outputs of the
+ *          subfilters are scaled by the factor to preserve the passband
+ *          gain, the taps themselves are stored unscaled so they do not
+ *          saturate with fixed-point samples. Without taps the input
+ *          samples are repeated.
+ */
+template <class Sample>
+class BasicFirInterpolator : public FirBase<Sample> {
+public:
+
+	// Port index definitions
+	static constexpr unsigned factor = 2U;
+
+	BasicFirInterpolator() : m_factor(1), m_phase_length(0), m_gain(1.0f)
+	{
+		this->inputs.template addPort<unsigned>(factor, 1);
+		m_prototype.count = 0;
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the factor first, the subfilters depend on it
+		auto value = this->inputs[factor].template receive<unsigned>();
+		if(value) m_factor = clamp_factor(value.value());
+
+		FirBase<Sample>::initialize();
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		this->configure();
+
+		if(this->inputs[factor].has_message())
+		{
+			auto value = this->inputs[factor].template receive<unsigned>();
+			if(value)
+			{
+				m_factor = clamp_factor(value.value());
+				set_taps(m_prototype);
+			}
+		}
+
+		// Reading the next input frame
+		auto frame = this->inputs[this->in].template receive<Frame<Sample>>();
+		if(!frame) return;
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+		{
+			this->m_history.push(frame.value()[i]);
+
+			// Computing every phase of the output from the same window
+			for(unsigned phase = 0; phase < m_factor; phase++)
+			{
+				const Sample* subfilter = m_subfilters + phase * m_phase_length;
+
+				const Sample  sample    = vector_dot(subfilter, this->m_history.window(), m_phase_length);
+
+				if(m_output.append(sample_traits<Sample>::scale(sample, m_gain)))
+				{
+					if(this->outputs[this->out].template send<Frame<Sample>>(m_output.frame()) != MessageStatus::Okay) return;
+					m_output.next();
+				}
+			}
+		}
+	}
+
+protected:
+
+	virtual void set_taps(const FirTaps& value) override
+	{
+		m_prototype = value;
+
+		const unsigned count = value.count < MFLOW_FIR_MAX_TAPS ? value.count : MFLOW_FIR_MAX_TAPS;
+		if(count == 0)
+		{
+			// Without taps every subfilter passes the input sample, so it is repeated
+			m_phase_length = 1;
+			m_gain         = 1.0f;
+
+			for(unsigned phase = 0; phase < m_factor; phase++) m_subfilters[phase] = sample_traits<Sample>::from_float(1.0f);
+
+			this->m_history.reset(m_phase_length);
+			return;
+		}
+
+		m_phase_length = (count + m_factor - 1) / m_factor;
+		m_gain         = (float) m_factor;
+
+		// Subfilter p holds the taps p, p + factor, p + 2 * factor... in reversed order
+		for(unsigned phase = 0; phase < m_factor; phase++)
+		{
+			for(unsigned j = 0; j < m_phase_length; j++)
+			{
+				const unsigned tap   = phase + j * m_factor;
+				const float    value = tap < count ? m_prototype.taps[tap] : 0.0f;
+
+				m_subfilters[phase * m_phase_length + (m_phase_length - 1 - j)] = sample_traits<Sample>::from_float(value);
+			}
+		}
+
+		this->m_history.reset(m_phase_length);
+	}
+
+private:
+
+	static unsigned clamp_factor(unsigned value)
+	{
+		return value == 0 ? 1U : value > MFLOW_FIR_MAX_FACTOR ? MFLOW_FIR_MAX_FACTOR : value;
+	}
+
+	FrameAssembler<Sample> m_output;
+	FirTaps                m_prototype;
+	Sample                 m_subfilters[MFLOW_FIR_MAX_TAPS + MFLOW_FIR_MAX_FACTOR];
+	unsigned               m_factor;
+	unsigned               m_phase_length;
+	float                  m_gain;
+};
+
+#endif // MFLOW_COMPONENTS_FIR_H_INCLUDED
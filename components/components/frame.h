@@ -0,0 +1,111 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_FRAME_H_INCLUDED
+#define MFLOW_COMPONENTS_FRAME_H_INCLUDED
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+
+
+// Default number of samples carried by a single frame message
+#ifndef MFLOW_FRAME_LENGTH
+#define MFLOW_FRAME_LENGTH (32)
+#endif
+
+/**
+ * @brief   Fixed-length block of samples passed as a single message.
+ * @details Frames amortize the per-message queue overhead over many
+ *          samples. The frame is a plain old data type, so it can be
+ *          copied through the message queues. The sequence number is
+ *          incremented by the producer for every frame it emits, which
+ *          lets consumers detect dropped or misaligned frames.
+ */
+template <class Sample, std::size_t Length = MFLOW_FRAME_LENGTH>
+struct Frame {
+
+	static constexpr std::size_t length = Length; /**< Number of samples in the frame. */
+
+	uint32_t sequence;        /**< Sequence number of the frame assigned by the producer. */
+	Sample   samples[Length]; /**< The samples carried by the frame.                      */
+
+	// Element access operators
+	Sample&       operator[](std::size_t index)       { return samples[index]; }
+	const Sample& operator[](std::size_t index) const { return samples[index]; }
+};
+
+/**
+ * @brief   Reference to a block of samples owned by the producer.
+ * @details Views pass large blocks without copying the samples through the
+ *          message queues, only the pointer is copied. The producer keeps
+ *          the samples valid for the lifetime documented by the component,
+ *          consumers must not modify them.
+ */
+template <class Sample>
+struct FrameView {
+	uint32_t      sequence; /**< Sequence number of the view assigned by the producer. */
+	uint32_t      length;   /**< Number of samples in the view.                        */
+	const Sample* samples;  /**< The first sample of the view.                         */
+
+	// Element access operator
+	const Sample& operator[](std::size_t index) const { return samples[index]; }
+};
+
+/**
+ * @brief   Helper collecting individual samples into frames.
+ * @details Components producing a different number of output samples
+ *          than they consume (decimators, interpolators, detectors) use
+ *          the assembler to fill their output frames. The sequence number
+ *          of the frames is incremented for every completed frame.
+ */
+template <class Sample, std::size_t Length = MFLOW_FRAME_LENGTH>
+class FrameAssembler {
+public:
+
+	FrameAssembler(void) : m_fill(0)
+	{
+		m_frame.sequence = 0;
+	}
+
+	/**
+	 * @brief  Appends a sample to the frame under construction.
+	 * @param  sample [in] The sample to append.
+	 * @retval True when the frame is complete, it should be sent and #next() called.
+	 */
+	bool append(const Sample& sample)
+	{
+		m_frame.samples[m_fill++] = sample;
+		return m_fill == Length;
+	}
+
+	/**
+	 * @brief  Queries the frame under construction.
+	 * @retval Reference to the frame.
+	 */
+	const Frame<Sample, Length>& frame(void) const
+	{
+		return m_frame;
+	}
+
+	/**
+	 * @brief Starts the next frame after the completed one has been sent.
+	 */
+	void next(void)
+	{
+		m_fill = 0;
+		m_frame.sequence++;
+	}
+
+	/**
+	 * @brief Discards the samples of the frame under construction.
+	 */
+	void clear(void)
+	{
+		m_fill = 0;
+	}
+
+private:
+	Frame<Sample, Length> m_frame; /**< The frame under construction.               */
+	std::size_t           m_fill;  /**< The number of samples already in the frame. */
+};
+
+#endif // MFLOW_COMPONENTS_FRAME_H_INCLUDED
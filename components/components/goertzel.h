@@ -0,0 +1,165 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_GOERTZEL_H_INCLUDED
+#define MFLOW_COMPONENTS_GOERTZEL_H_INCLUDED
+
+// Standard includes
+#include <cmath>
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "sample.h"
+
+
+// Maximum number of tones detected by a Goertzel bank
+#ifndef MFLOW_GOERTZEL_MAX_TONES
+#define MFLOW_GOERTZEL_MAX_TONES (16)
+#endif
+
+/**
+ * @brief Frequencies of the tones to detect, sent on the tones option port.
+ */
+struct ToneList {
+	unsigned count;                               /**< Number of valid frequencies.                   */
+	float    frequency[MFLOW_GOERTZEL_MAX_TONES]; /**< Frequencies as a fraction of the sample rate. */
+};
+
+/**
+ * @brief Magnitudes of the tones in a block, emitted by the Goertzel bank.
+ */
+struct ToneMagnitudes {
+	uint32_t sequence;                            /**< Sequence number of the block.             */
+	unsigned count;                               /**< Number of valid magnitudes.               */
+	float    magnitude[MFLOW_GOERTZEL_MAX_TONES]; /**< Amplitudes in the order of the tone list. */
+};
+
+/**
+ * @brief   Bank of Goertzel filters measuring the amplitude of a few tones.
+ * @details Every tone costs one multiplication and two additions per sample,
+ *          so a handful of tones is much cheaper than a full FFT. The filter
+ *          states are kept in arrays and all tones are updated for a sample
+ *          in one loop, which the compiler can vectorize. After every block
+ *          of samples the amplitudes are emitted, scaled so that a sine wave
+ *          of amplitude A at one of the frequencies reads approximately A. The
+ *          frequencies need not fall on the bins of the block length, longer
+ *          blocks give narrower detection bands.
+ */
+template <class Sample>
+class BasicGoertzelBank : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in    = 0U;
+	static constexpr unsigned tones = 1U;
+	static constexpr unsigned block = 2U;
+	static constexpr unsigned out   = 0U;
+
+	BasicGoertzelBank() : m_count(0), m_block(Frame<Sample>::length), m_filled(0), m_sequence(0)
+	{
+		inputs.addPort<Frame<Sample>>(in, 2);
+		inputs.addPort<ToneList>(tones, 1);
+		inputs.addPort<unsigned>(block, 1);
+		outputs.addPort<ToneMagnitudes>(out);
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the tone list
+		auto value = inputs[tones].receive<ToneList>();
+		if(value) set_tones(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[tones].has_message())
+		{
+			auto value = inputs[tones].receive<ToneList>();
+			if(value) set_tones(value.value());
+		}
+
+		if(inputs[block].has_message())
+		{
+			auto value = inputs[block].receive<unsigned>();
+			if(value)
+			{
+				m_block = value.value() ? value.value() : 1U;
+				reset();
+			}
+		}
+
+		// Reading the next input frame
+		auto frame = inputs[in].receive<Frame<Sample>>();
+		if(!frame) return;
+
+		const unsigned count = m_count;
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+		{
+			const float x = sample_traits<Sample>::to_float(frame.value()[i]);
+
+			// Updating the filters of all tones
+			for(unsigned t = 0; t < count; t++)
+			{
+				const float s = x + m_coefficient[t] * m_s1[t] - m_s2[t];
+				m_s2[t] = m_s1[t];
+				m_s1[t] = s;
+			}
+
+			if(++m_filled == m_block && !emit()) return;
+		}
+	}
+
+private:
+
+	void set_tones(const ToneList& value)
+	{
+		m_count = value.count > MFLOW_GOERTZEL_MAX_TONES ? MFLOW_GOERTZEL_MAX_TONES : value.count;
+
+		for(unsigned t = 0; t < m_count; t++)
+		{
+			m_coefficient[t] = (float) (2.0 * std::cos(6.283185307179586 * (double) value.frequency[t]));
+		}
+
+		reset();
+	}
+
+	void reset(void)
+	{
+		for(unsigned t = 0; t < MFLOW_GOERTZEL_MAX_TONES; t++) m_s1[t] = m_s2[t] = 0.0f;
+		m_filled = 0;
+	}
+
+	bool emit(void)
+	{
+		ToneMagnitudes record;
+		record.sequence = m_sequence++;
+		record.count    = m_count;
+
+		// Amplitude from the squared magnitude of the last filter states
+		const float scale = 2.0f / (float) m_block;
+
+		for(unsigned t = 0; t < m_count; t++)
+		{
+			const float power = m_s1[t] * m_s1[t] + m_s2[t] * m_s2[t] - m_coefficient[t] * m_s1[t] * m_s2[t];
+			record.magnitude[t] = std::sqrt(power > 0.0f ? power : 0.0f) * scale;
+		}
+
+		reset();
+
+		return outputs[out].send<ToneMagnitudes>(record) == MessageStatus::Okay;
+	}
+
+	float    m_coefficient[MFLOW_GOERTZEL_MAX_TONES];
+	float    m_s1[MFLOW_GOERTZEL_MAX_TONES];
+	float    m_s2[MFLOW_GOERTZEL_MAX_TONES];
+	unsigned m_count;
+	unsigned m_block;
+	unsigned m_filled;
+	uint32_t m_sequence;
+};
+
+typedef BasicGoertzelBank<double> GoertzelBank;
+
+#endif // MFLOW_COMPONENTS_GOERTZEL_H_INCLUDED
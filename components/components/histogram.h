@@ -0,0 +1,214 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_HISTOGRAM_H_INCLUDED
+#define MFLOW_COMPONENTS_HISTOGRAM_H_INCLUDED
+
+// Standard includes
+#include <cmath>
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "sample.h"
+
+
+// Maximum number of bins of a histogram
+#ifndef MFLOW_HISTOGRAM_MAX_BINS
+#define MFLOW_HISTOGRAM_MAX_BINS (64)
+#endif
+
+/**
+ * @brief Spacing of the histogram bins.
+ */
+enum class HistogramScale : uint8_t {
+	Linear,     /**< Bins of equal width between min and max.                */
+	Logarithmic /**< Bins of equal ratio between min and max, both positive. */
+};
+
+/**
+ * @brief Configuration of the Histogram component.
+ */
+struct HistogramConfig {
+	HistogramScale scale;  /**< Spacing of the bins.                                 */
+	float          min;    /**< Lower edge of the first bin.                         */
+	float          max;    /**< Upper edge of the last bin.                          */
+	unsigned       bins;   /**< Number of bins.                                      */
+	unsigned       period; /**< Samples between emissions, zero to emit on triggers. */
+};
+
+/**
+ * @brief Histogram emitted by the Histogram component.
+ */
+struct Histogram {
+	uint32_t       sequence;                         /**< Sequence number of the histogram.           */
+	uint32_t       count;                            /**< Number of samples counted.                  */
+	uint32_t       underflow;                        /**< Samples below min, or not positive for log. */
+	uint32_t       overflow;                         /**< Samples at or above max.                    */
+	HistogramScale scale;                            /**< Spacing of the bins.                        */
+	float          min;                              /**< Lower edge of the first bin.                */
+	float          max;                              /**< Upper edge of the last bin.                 */
+	unsigned       bins;                             /**< Number of valid bins.                       */
+	uint32_t       counts[MFLOW_HISTOGRAM_MAX_BINS]; /**< Sample count of every bin.                  */
+};
+
+/**
+ * @brief   Component accumulating the histogram of a stream.
+ * @details The bin index is computed without branches: the sample is mapped
+ *          to a bin coordinate where the underflow and overflow bins sit
+ *          just outside the regular ones, clamped and truncated, and the
+ *          counter at the index is incremented. Logarithmic bins map the
+ *          base two logarithm of the sample, non-positive samples produce
+ *          NaN, which the clamping sends to the underflow bin. The histogram
+ *          is emitted and cleared after every period samples, or whenever a
+ *          message arrives on the trigger port.
+ */
+template <class Sample>
+class BasicHistogram : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in       = 0U;
+	static constexpr unsigned frame_in = 1U;
+	static constexpr unsigned config   = 2U;
+	static constexpr unsigned trigger  = 3U;
+	static constexpr unsigned out      = 0U;
+
+	BasicHistogram() : m_offset(0.0f), m_scale(1.0f), m_count(0), m_sequence(0)
+	{
+		inputs.addPort<Sample>(in, 1);
+		inputs.addPort<Frame<Sample>>(frame_in, 1);
+		inputs.addPort<HistogramConfig>(config, 1);
+		inputs.addPort<bool>(trigger, 1);
+		outputs.addPort<Histogram>(out);
+
+		set_config({ HistogramScale::Linear, -1.0f, 1.0f, 16U, 0U });
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the histogram configuration
+		auto value = inputs[config].receive<HistogramConfig>();
+		if(value) set_config(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[config].has_message())
+		{
+			auto value = inputs[config].receive<HistogramConfig>();
+			if(value) set_config(value.value());
+		}
+
+		// Waiting for samples, frames or triggers
+		auto index = await({in, frame_in, trigger});
+		if(!index) return;
+
+		if(index.value() == in)
+		{
+			auto value = inputs[in].receive<Sample>();
+			if(!value) return;
+
+			const Sample sample = value.value();
+			update(&sample, 1);
+		}
+		else if(index.value() == frame_in)
+		{
+			auto frame = inputs[frame_in].receive<Frame<Sample>>();
+			if(frame) update(frame.value().samples, Frame<Sample>::length);
+		}
+		else
+		{
+			auto value = inputs[trigger].receive<bool>();
+			if(value) emit();
+		}
+	}
+
+private:
+
+	void set_config(const HistogramConfig& value)
+	{
+		m_config      = value;
+		m_config.bins = value.bins == 0 ? 1U : value.bins > MFLOW_HISTOGRAM_MAX_BINS ? MFLOW_HISTOGRAM_MAX_BINS : value.bins;
+
+		// Mapping the range to bin coordinates, regular bins start at one
+		float low  = m_config.min;
+		float high = m_config.max;
+
+		if(m_config.scale == HistogramScale::Logarithmic)
+		{
+			low  = std::log2(low  > 0.0f ? low  : 1e-30f);
+			high = std::log2(high > 0.0f ? high : 1e-30f);
+		}
+
+		m_scale  = high > low ? (float) m_config.bins / (high - low) : 0.0f;
+		m_offset = 1.0f - low * m_scale;
+
+		clear();
+	}
+
+	void clear(void)
+	{
+		for(unsigned i = 0; i < MFLOW_HISTOGRAM_MAX_BINS + 2; i++) m_bins[i] = 0;
+		m_count = 0;
+	}
+
+	void update(const Sample* samples, std::size_t length)
+	{
+		const float limit       = (float) m_config.bins + 1.0f;
+		const bool  logarithmic = m_config.scale == HistogramScale::Logarithmic;
+		std::size_t start       = 0;
+
+		while(start < length)
+		{
+			// Counting up to the end of the emission period
+			std::size_t count = length - start;
+			if(m_config.period && count > m_config.period - m_count) count = m_config.period - m_count;
+
+			for(std::size_t i = start; i < start + count; i++)
+			{
+				float x = sample_traits<Sample>::to_float(samples[i]);
+				if(logarithmic) x = std::log2(x);
+
+				// NaN compares false, so fmax selects the zero
+				const float position = std::fmin(std::fmax(x * m_scale + m_offset, 0.0f), limit);
+				m_bins[(unsigned) position]++;
+			}
+
+			start   += count;
+			m_count += (uint32_t) count;
+
+			if(m_config.period && m_count == m_config.period && !emit()) return;
+		}
+	}
+
+	bool emit(void)
+	{
+		Histogram record;
+		record.sequence  = m_sequence++;
+		record.count     = m_count;
+		record.underflow = m_bins[0];
+		record.overflow  = m_bins[m_config.bins + 1];
+		record.scale     = m_config.scale;
+		record.min       = m_config.min;
+		record.max       = m_config.max;
+		record.bins      = m_config.bins;
+
+		for(unsigned i = 0; i < m_config.bins; i++) record.counts[i] = m_bins[i + 1];
+
+		clear();
+
+		return outputs[out].send<Histogram>(record) == MessageStatus::Okay;
+	}
+
+	HistogramConfig m_config;
+	uint32_t        m_bins[MFLOW_HISTOGRAM_MAX_BINS + 2];
+	float           m_offset;
+	float           m_scale;
+	uint32_t        m_count;
+	uint32_t        m_sequence;
+};
+
+typedef BasicHistogram<double> HistogramAccumulator;
+
+#endif // MFLOW_COMPONENTS_HISTOGRAM_H_INCLUDED
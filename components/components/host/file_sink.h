@@ -0,0 +1,429 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_HOST_FILE_SINK_H_INCLUDED
+#define MFLOW_COMPONENTS_HOST_FILE_SINK_H_INCLUDED
+
+#if !defined(ESP_PLATFORM)
+
+// Standard includes
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Linux includes
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "io_uring.h"
+#include "os.h"
+#include "sample.h"
+
+
+// Number of write buffers of a file sink, the bound of writes in flight
+#ifndef MFLOW_FILE_SINK_BUFFERS
+#define MFLOW_FILE_SINK_BUFFERS (4)
+#endif
+
+// Size of the write buffers of a file sink in bytes
+#ifndef MFLOW_FILE_SINK_BUFFER_SIZE
+#define MFLOW_FILE_SINK_BUFFER_SIZE (1U << 20)
+#endif
+
+// Maximum length of the file path of a file sink
+#ifndef MFLOW_FILE_SINK_MAX_PATH
+#define MFLOW_FILE_SINK_MAX_PATH (256)
+#endif
+
+/**
+ * @brief Configuration of the FileSink component.
+ */
+struct FileSinkConfig {
+	char path[MFLOW_FILE_SINK_MAX_PATH]; /**< Path of the file, null terminated.               */
+	bool append;                         /**< Append to an existing file instead of truncating. */
+};
+
+/**
+ * @brief   Sink component recording the received samples to a binary file.
+ * @details The raw samples are copied into large page aligned buffers, and
+ *          every full buffer is written with one asynchronous vectored write
+ *          at its file offset. The writes are submitted to io_uring, when
+ *          the kernel does not allow io_uring they are handed to a writer
+ *          thread calling pwritev. At most MFLOW_FILE_SINK_BUFFERS buffers
+ *          are in flight: when all of them are and the current one is full,
+ *          samples are dropped and counted instead of blocking the graph.
+ *          A buffer is only reused after its write completed, a failed
+ *          submission to io_uring is retried while the buffer waits.
+ *          A message on the flush port writes the partially filled buffer,
+ *          a new configuration finishes the current file and opens the new
+ *          one. The file is completed when the component stops.
+ */
+template <class Sample>
+class BasicFileSink : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in       = 0U;
+	static constexpr unsigned frame_in = 1U;
+	static constexpr unsigned config   = 2U;
+	static constexpr unsigned flush    = 3U;
+
+	static_assert(MFLOW_FILE_SINK_BUFFER_SIZE % sizeof(Sample) == 0, "The buffer size must be a multiple of the sample size.");
+
+	BasicFileSink()
+		: m_fd(-1),
+		  m_offset(0),
+		  m_current(-1),
+		  m_fill(0),
+		  m_free_count(0),
+		  m_buffer_count(0),
+		  m_writer(nullptr),
+		  m_writer_done(false),
+		  m_requests(nullptr),
+		  m_completions(nullptr),
+		  m_written(0),
+		  m_dropped(0),
+		  m_errors(0)
+	{
+		inputs.addPort<Sample>(in, 1);
+		inputs.addPort<Frame<Sample>>(frame_in, 4);
+		inputs.addPort<FileSinkConfig>(config, 1);
+		inputs.addPort<bool>(flush, 1);
+
+		// Using the buffers that could be allocated, samples are dropped without any
+		for(unsigned b = 0; b < MFLOW_FILE_SINK_BUFFERS; b++)
+		{
+			m_buffers[m_buffer_count] = static_cast<uint8_t*>(std::aligned_alloc(buffer_alignment, MFLOW_FILE_SINK_BUFFER_SIZE));
+			if(m_buffers[m_buffer_count] == nullptr) continue;
+
+			m_free[m_free_count++] = m_buffer_count;
+			m_buffer_count++;
+		}
+
+		if(m_buffer_count < MFLOW_FILE_SINK_BUFFERS) MFLOW_LOGE("", "File sink allocated only %u of %u buffers.", m_buffer_count, (unsigned) MFLOW_FILE_SINK_BUFFERS);
+	}
+
+	virtual ~BasicFileSink()
+	{
+		for(unsigned b = 0; b < m_buffer_count; b++) std::free(m_buffers[b]);
+	}
+
+	virtual void initialize(void) override
+	{
+		// Using io_uring when available, a writer thread otherwise
+		if(!m_ring.open(MFLOW_FILE_SINK_BUFFERS))
+		{
+			m_requests    = os_queue_create(sizeof(Request), MFLOW_FILE_SINK_BUFFERS + 1);
+			m_completions = os_queue_create(sizeof(Request), MFLOW_FILE_SINK_BUFFERS + 1);
+			m_writer_done = false;
+			m_writer      = os_thread_create(BasicFileSink::run_writer, (void*) this, "file_sink", 8192, 1);
+		}
+
+		// Reading the file configuration
+		auto value = inputs[config].receive<FileSinkConfig>();
+		if(value) open(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[config].has_message())
+		{
+			auto value = inputs[config].receive<FileSinkConfig>();
+			if(value)
+			{
+				finish();
+				open(value.value());
+			}
+		}
+
+		if(inputs[flush].has_message())
+		{
+			auto value = inputs[flush].receive<bool>();
+			if(value && m_current >= 0 && m_fill > 0) submit();
+		}
+
+		// Releasing the buffers of completed writes
+		reap(false);
+
+		// Waiting for samples or frames to record
+		auto index = await({in, frame_in, config, flush});
+		if(!index) return;
+
+		if(index.value() == in)
+		{
+			auto value = inputs[in].receive<Sample>();
+			if(!value) return;
+
+			const Sample sample = value.value();
+			write(&sample, sizeof(Sample));
+		}
+		else if(index.value() == frame_in)
+		{
+			auto frame = inputs[frame_in].receive<Frame<Sample>>();
+			if(frame) write(frame.value().samples, sizeof(frame.value().samples));
+		}
+	}
+
+	virtual void finalize(void) override
+	{
+		finish();
+
+		// Stopping the writer thread, the queues are deleted once it no longer accesses them
+		if(m_writer != nullptr)
+		{
+			Request request = { stop_request, 0, 0, 0 };
+			os_queue_send(m_requests, &request, MFLOW_OS_WAIT_FOREVER);
+			while(!m_writer_done.load(std::memory_order_acquire)) os_delay(1);
+
+			os_thread_release(m_writer);
+			os_queue_delete(m_requests);
+			os_queue_delete(m_completions);
+			m_writer = nullptr;
+		}
+
+		m_ring.close();
+
+		if(m_dropped || m_errors) MFLOW_LOGW("", "File sink dropped %llu samples, %u writes failed.", (unsigned long long) m_dropped, m_errors);
+	}
+
+	/**
+	 * @brief  Queries the number of bytes written to the file.
+	 */
+	uint64_t written(void) const { return m_written; }
+
+	/**
+	 * @brief  Queries the number of samples dropped because all buffers were in flight.
+	 */
+	uint64_t dropped(void) const { return m_dropped; }
+
+	/**
+	 * @brief  Queries the number of failed writes.
+	 */
+	unsigned errors(void) const { return m_errors; }
+
+private:
+
+	// Alignment of the buffers, a page
+	static constexpr std::size_t buffer_alignment = 4096U;
+
+	// Buffer index of the request stopping the writer thread
+	static constexpr unsigned stop_request = 0xFFFFFFFFU;
+
+	/**
+	 * @brief Write request of a buffer, and its completion from the writer thread.
+	 */
+	struct Request {
+		unsigned buffer; /**< Index of the buffer.                                 */
+		int      fd;     /**< The file to write.                                   */
+		uint64_t offset; /**< File offset of the buffer.                           */
+		int64_t  length; /**< Bytes to write, the result in completions.           */
+	};
+
+	void open(const FileSinkConfig& value)
+	{
+		FileSinkConfig settings = value;
+		settings.path[MFLOW_FILE_SINK_MAX_PATH - 1] = '\0';
+
+		m_fd     = ::open(settings.path, O_WRONLY | O_CREAT | O_CLOEXEC | (settings.append ? 0 : O_TRUNC), 0644);
+		m_offset = 0;
+
+		if(m_fd < 0)
+		{
+			MFLOW_LOGE("", "File sink cannot open %s.", settings.path);
+			return;
+		}
+
+		// Continuing at the end of the existing file
+		struct stat status;
+		if(settings.append && fstat(m_fd, &status) == 0) m_offset = (uint64_t) status.st_size;
+	}
+
+	// Writes the partial buffer, waits for all writes and closes the file
+	void finish(void)
+	{
+		if(m_current >= 0 && m_fill > 0) submit();
+		while(m_free_count < m_buffer_count) reap(true);
+
+		if(m_fd >= 0) ::close(m_fd);
+		m_fd = -1;
+	}
+
+	void write(const void* data, std::size_t length)
+	{
+		const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+		// Dropping the samples while no file is open
+		if(m_fd < 0)
+		{
+			m_dropped += length / sizeof(Sample);
+			return;
+		}
+
+		while(length > 0)
+		{
+			// Dropping the samples when every buffer is in flight
+			if(m_current < 0 && !acquire())
+			{
+				m_dropped += length / sizeof(Sample);
+				return;
+			}
+
+			std::size_t count = MFLOW_FILE_SINK_BUFFER_SIZE - m_fill;
+			if(count > length) count = length;
+
+			std::memcpy(m_buffers[m_current] + m_fill, bytes, count);
+			m_fill += count;
+			bytes  += count;
+			length -= count;
+
+			if(m_fill == MFLOW_FILE_SINK_BUFFER_SIZE) submit();
+		}
+	}
+
+	bool acquire(void)
+	{
+		if(m_free_count == 0) reap(false);
+		if(m_free_count == 0) return false;
+
+		m_current = (int) m_free[--m_free_count];
+		m_fill    = 0;
+		return true;
+	}
+
+	// Submits the current buffer at the end of the file
+	void submit(void)
+	{
+		const unsigned    buffer = (unsigned) m_current;
+		const std::size_t length = m_fill;
+
+		m_current = -1;
+		m_fill    = 0;
+
+		m_vectors[buffer].iov_base = m_buffers[buffer];
+		m_vectors[buffer].iov_len  = length;
+		m_offsets[buffer]          = m_offset;
+		m_offset                  += length;
+
+		start(buffer);
+	}
+
+	// Starts writing the remaining part of a buffer
+	void start(unsigned buffer)
+	{
+		if(m_writer != nullptr)
+		{
+			Request request = { buffer, m_fd, m_offsets[buffer], (int64_t) m_vectors[buffer].iov_len };
+			os_queue_send(m_requests, &request, MFLOW_OS_WAIT_FOREVER);
+		}
+		else if(!m_ring.prepare_writev(m_fd, &m_vectors[buffer], 1, m_offsets[buffer], buffer))
+		{
+			// The write was not queued, so the buffer can be reused
+			m_errors++;
+			m_free[m_free_count++] = buffer;
+		}
+		else
+		{
+			// A failed submission leaves the write queued in the ring, reap() submits it again
+			m_ring.submit();
+		}
+	}
+
+	// Releases the buffers of completed writes, optionally waiting for one
+	void reap(bool wait)
+	{
+		if(m_free_count == m_buffer_count) return;
+
+		if(m_writer != nullptr)
+		{
+			Request request;
+			while(os_queue_receive(m_completions, &request, wait ? MFLOW_OS_WAIT_FOREVER : 0))
+			{
+				complete(request.buffer, request.length);
+				wait = false;
+			}
+			return;
+		}
+
+		IoUring::Completion completion;
+
+		// Submitting the writes left queued by a failed submission, the buffers stay in flight until they complete
+		if(!m_ring.submit(wait ? 1U : 0U) && wait) os_delay(1);
+
+		while(m_ring.reap(completion)) complete((unsigned) completion.user_data, completion.result);
+	}
+
+	void complete(unsigned buffer, int64_t result)
+	{
+		if(result < 0 || (result == 0 && m_vectors[buffer].iov_len > 0))
+		{
+			m_errors++;
+		}
+		else if((std::size_t) result < m_vectors[buffer].iov_len)
+		{
+			// Continuing a short write with the rest of the buffer
+			m_written                  += (uint64_t) result;
+			m_vectors[buffer].iov_base  = static_cast<uint8_t*>(m_vectors[buffer].iov_base) + result;
+			m_vectors[buffer].iov_len  -= (std::size_t) result;
+			m_offsets[buffer]          += (uint64_t) result;
+			start(buffer);
+			return;
+		}
+		else m_written += (uint64_t) result;
+
+		m_free[m_free_count++] = buffer;
+	}
+
+	static void run_writer(void* p_sink)
+	{
+		BasicFileSink* sink = static_cast<BasicFileSink*>(p_sink);
+		Request        request;
+
+		// Writing the requested buffers until the stop request, short writes are continued by the sink
+		while(os_queue_receive(sink->m_requests, &request, MFLOW_OS_WAIT_FOREVER) && request.buffer != stop_request)
+		{
+			const struct iovec vector = sink->m_vectors[request.buffer];
+			ssize_t            count;
+
+			do count = pwritev(request.fd, &vector, 1, (off_t) request.offset);
+			while(count < 0 && errno == EINTR);
+
+			request.length = count < 0 ? -errno : (int64_t) count;
+			os_queue_send(sink->m_completions, &request, MFLOW_OS_WAIT_FOREVER);
+		}
+
+		// Signalling the stop after the last access to the queues
+		sink->m_writer_done.store(true, std::memory_order_release);
+		os_thread_exit();
+	}
+
+	uint8_t*          m_buffers[MFLOW_FILE_SINK_BUFFERS];
+	struct iovec      m_vectors[MFLOW_FILE_SINK_BUFFERS];
+	uint64_t          m_offsets[MFLOW_FILE_SINK_BUFFERS];
+	unsigned          m_free[MFLOW_FILE_SINK_BUFFERS];
+	IoUring           m_ring;
+	int               m_fd;
+	uint64_t          m_offset;
+	int               m_current;
+	std::size_t       m_fill;
+	unsigned          m_free_count;
+	unsigned          m_buffer_count;
+	os_thread_t       m_writer;
+	std::atomic<bool> m_writer_done;
+	os_queue_t        m_requests;
+	os_queue_t        m_completions;
+	uint64_t          m_written;
+	uint64_t          m_dropped;
+	unsigned          m_errors;
+};
+
+typedef BasicFileSink<double> FileSink;
+
+#endif // !ESP_PLATFORM
+
+#endif // MFLOW_COMPONENTS_HOST_FILE_SINK_H_INCLUDED
@@ -0,0 +1,267 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_HOST_IO_URING_H_INCLUDED
+#define MFLOW_COMPONENTS_HOST_IO_URING_H_INCLUDED
+
+#if !defined(ESP_PLATFORM)
+
+// Standard includes
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Linux includes
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Define MFLOW_NO_IO_URING to always use the fallback paths
+#if defined(__has_include) && !defined(MFLOW_NO_IO_URING)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define MFLOW_HAS_IO_URING (1)
+#endif
+#endif
+
+#if defined(MFLOW_HAS_IO_URING) && !defined(__NR_io_uring_setup)
+#undef MFLOW_HAS_IO_URING
+#endif
+
+
+/**
+ * @brief   Minimal io_uring submission and completion ring.
+ * @details The ring is set up with the raw system calls, so no liburing is
+ *          needed. Only vectored writes are submitted, which every kernel
+ *          with io_uring supports. The ring is used from a single thread:
+ *          submissions are batched in the submission queue until #submit()
+ *          and completions are read from the shared memory completion queue
+ *          without a system call. When the kernel or the sandbox does not
+ *          allow io_uring, #open() fails and the caller falls back to a
+ *          blocking write path.
+ */
+class IoUring {
+public:
+
+	/**
+	 * @brief Result of a completed operation.
+	 */
+	struct Completion {
+		uint64_t user_data; /**< The tag given at submission.                      */
+		int32_t  result;    /**< Number of bytes written, or a negative error code. */
+	};
+
+	IoUring(void)
+		: m_fd(-1),
+		  m_sq_ring(nullptr),
+		  m_cq_ring(nullptr),
+		  m_sqes(nullptr),
+		  m_sq_ring_size(0),
+		  m_cq_ring_size(0),
+		  m_sqes_size(0),
+		  m_pending(0)
+	{
+		// Nothing to do here...
+	}
+
+	~IoUring() { close(); }
+
+	IoUring(const IoUring&)            = delete;
+	IoUring& operator=(const IoUring&) = delete;
+
+	/**
+	 * @brief  Sets up the ring.
+	 * @param  entries [in] The number of submission queue entries.
+	 * @retval True when io_uring is available, false otherwise.
+	 */
+	bool open(unsigned entries)
+	{
+#if defined(MFLOW_HAS_IO_URING)
+		struct io_uring_params params;
+		std::memset(&params, 0, sizeof(params));
+
+		m_fd = (int) syscall(__NR_io_uring_setup, entries, &params);
+		if(m_fd < 0) return false;
+
+		// Mapping the rings, newer kernels share one mapping for both
+		m_sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+		m_cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+		m_sqes_size    = params.sq_entries * sizeof(struct io_uring_sqe);
+
+		const bool single = params.features & IORING_FEAT_SINGLE_MMAP;
+		if(single && m_cq_ring_size > m_sq_ring_size) m_sq_ring_size = m_cq_ring_size;
+
+		m_sq_ring = map(m_sq_ring_size, IORING_OFF_SQ_RING);
+		m_cq_ring = single ? m_sq_ring : map(m_cq_ring_size, IORING_OFF_CQ_RING);
+		m_sqes    = map(m_sqes_size, IORING_OFF_SQES);
+
+		if(m_sq_ring == nullptr || m_cq_ring == nullptr || m_sqes == nullptr)
+		{
+			close();
+			return false;
+		}
+
+		if(single) m_cq_ring_size = 0;
+
+		m_sq_head  = pointer<unsigned>(m_sq_ring, params.sq_off.head);
+		m_sq_tail  = pointer<unsigned>(m_sq_ring, params.sq_off.tail);
+		m_sq_mask  = *pointer<unsigned>(m_sq_ring, params.sq_off.ring_mask);
+		m_sq_array = pointer<unsigned>(m_sq_ring, params.sq_off.array);
+		m_cq_head  = pointer<unsigned>(m_cq_ring, params.cq_off.head);
+		m_cq_tail  = pointer<unsigned>(m_cq_ring, params.cq_off.tail);
+		m_cq_mask  = *pointer<unsigned>(m_cq_ring, params.cq_off.ring_mask);
+		m_cqes     = pointer<struct io_uring_cqe>(m_cq_ring, params.cq_off.cqes);
+		m_entries  = params.sq_entries;
+
+		return true;
+#else
+		(void) entries;
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief Releases the ring, operations in flight are not waited for.
+	 */
+	void close(void)
+	{
+		if(m_sqes)                              munmap(m_sqes, m_sqes_size);
+		if(m_cq_ring && m_cq_ring != m_sq_ring) munmap(m_cq_ring, m_cq_ring_size);
+		if(m_sq_ring)                           munmap(m_sq_ring, m_sq_ring_size);
+		if(m_fd >= 0)                           ::close(m_fd);
+
+		m_fd      = -1;
+		m_sq_ring = m_cq_ring = m_sqes = nullptr;
+	}
+
+	/**
+	 * @brief  Queries whether the ring is set up.
+	 */
+	bool is_open(void) const { return m_fd >= 0; }
+
+	/**
+	 * @brief   Queues a vectored write at a file offset.
+	 * @details The vector and the data must stay valid until the completion.
+	 * @param   fd        [in] The file descriptor to write.
+	 * @param   vector    [in] The buffers to write.
+	 * @param   count     [in] The number of buffers.
+	 * @param   offset    [in] The file offset of the write.
+	 * @param   user_data [in] Tag returned with the completion.
+	 * @retval  True when queued, false when the submission queue is full.
+	 */
+	bool prepare_writev(int fd, const struct iovec* vector, unsigned count, uint64_t offset, uint64_t user_data)
+	{
+#if defined(MFLOW_HAS_IO_URING)
+		const unsigned tail = *m_sq_tail;
+		if(tail - __atomic_load_n(m_sq_head, __ATOMIC_ACQUIRE) >= m_entries) return false;
+
+		const unsigned       index = tail & m_sq_mask;
+		struct io_uring_sqe* sqe   = static_cast<struct io_uring_sqe*>(m_sqes) + index;
+
+		std::memset(sqe, 0, sizeof(*sqe));
+		sqe->opcode    = IORING_OP_WRITEV;
+		sqe->fd        = fd;
+		sqe->addr      = (uint64_t) (uintptr_t) vector;
+		sqe->len       = count;
+		sqe->off       = offset;
+		sqe->user_data = user_data;
+
+		m_sq_array[index] = index;
+		__atomic_store_n(m_sq_tail, tail + 1, __ATOMIC_RELEASE);
+		m_pending++;
+
+		return true;
+#else
+		(void) fd; (void) vector; (void) count; (void) offset; (void) user_data;
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief  Submits the queued operations, optionally waiting for completions.
+	 * @param  wait_for [in] The number of completions to wait for.
+	 * @retval True on success, false on error.
+	 */
+	bool submit(unsigned wait_for = 0)
+	{
+#if defined(MFLOW_HAS_IO_URING)
+		if(m_pending == 0 && wait_for == 0) return true;
+
+		const unsigned flags = wait_for ? IORING_ENTER_GETEVENTS : 0U;
+		int            status;
+
+		do status = (int) syscall(__NR_io_uring_enter, m_fd, m_pending, wait_for, flags, nullptr, 0);
+		while(status < 0 && errno == EINTR);
+
+		if(status < 0) return false;
+
+		m_pending -= (unsigned) status < m_pending ? (unsigned) status : m_pending;
+		return true;
+#else
+		(void) wait_for;
+		return false;
+#endif
+	}
+
+	/**
+	 * @brief  Reads a completion without blocking.
+	 * @param  completion [out] The result of the completed operation.
+	 * @retval True when a completion was read, false when none is available.
+	 */
+	bool reap(Completion& completion)
+	{
+#if defined(MFLOW_HAS_IO_URING)
+		const unsigned head = *m_cq_head;
+		if(head == __atomic_load_n(m_cq_tail, __ATOMIC_ACQUIRE)) return false;
+
+		const struct io_uring_cqe& cqe = m_cqes[head & m_cq_mask];
+		completion.user_data = cqe.user_data;
+		completion.result    = cqe.res;
+
+		__atomic_store_n(m_cq_head, head + 1, __ATOMIC_RELEASE);
+		return true;
+#else
+		(void) completion;
+		return false;
+#endif
+	}
+
+private:
+
+	void* map(std::size_t size, uint64_t offset)
+	{
+		void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_fd, (off_t) offset);
+		return address == MAP_FAILED ? nullptr : address;
+	}
+
+	template <class Type>
+	static Type* pointer(void* base, uint32_t offset)
+	{
+		return reinterpret_cast<Type*>(static_cast<uint8_t*>(base) + offset);
+	}
+
+	int         m_fd;
+	void*       m_sq_ring;
+	void*       m_cq_ring;
+	void*       m_sqes;
+	std::size_t m_sq_ring_size;
+	std::size_t m_cq_ring_size;
+	std::size_t m_sqes_size;
+	unsigned    m_pending;
+	unsigned    m_entries;
+	unsigned*   m_sq_head;
+	unsigned*   m_sq_tail;
+	unsigned    m_sq_mask;
+	unsigned*   m_sq_array;
+	unsigned*   m_cq_head;
+	unsigned*   m_cq_tail;
+	unsigned    m_cq_mask;
+
+#if defined(MFLOW_HAS_IO_URING)
+	struct io_uring_cqe* m_cqes;
+#endif
+};
+
+#endif // !ESP_PLATFORM
+
+#endif // MFLOW_COMPONENTS_HOST_IO_URING_H_INCLUDED
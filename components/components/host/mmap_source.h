@@ -0,0 +1,294 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_HOST_MMAP_SOURCE_H_INCLUDED
+#define MFLOW_COMPONENTS_HOST_MMAP_SOURCE_H_INCLUDED
+
+#if !defined(ESP_PLATFORM)
+
+// Standard includes
+#include <cstdint>
+#include <cstring>
+
+// Linux includes
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "os.h"
+#include "sample.h"
+
+
+// Maximum length of the file path of a mapped file source
+#ifndef MFLOW_MMAP_SOURCE_MAX_PATH
+#define MFLOW_MMAP_SOURCE_MAX_PATH (256)
+#endif
+
+// Distance of the read-ahead advice in front of the read position in bytes
+#ifndef MFLOW_MMAP_SOURCE_READ_AHEAD
+#define MFLOW_MMAP_SOURCE_READ_AHEAD (8U << 20)
+#endif
+
+/**
+ * @brief Configuration of the MmapSource component.
+ */
+struct MmapSourceConfig {
+	char     path[MFLOW_MMAP_SOURCE_MAX_PATH]; /**< Path of the file, null terminated.                */
+	uint64_t offset;                           /**< Bytes to skip at the start of the file.           */
+	uint32_t view_length;                      /**< Samples per view message, zero for frame length.  */
+	uint32_t rate;                             /**< Samples per second, zero for no pacing.           */
+	bool     loop;                             /**< Restart at the offset at the end of the file.     */
+};
+
+/**
+ * @brief   Source component reading a binary sample file through a memory mapping.
+ * @details The file holds raw samples, like the recordings of the FileSink. It
+ *          is mapped read-only with sequential access advice, and pages ahead
+ *          of the read position are requested in large steps, so the kernel
+ *          reads the file in the background. The view output sends FrameView
+ *          messages pointing directly into the mapping, no sample is copied.
+ *          The views stay valid until the second configuration after them or
+ *          the destruction of the component, so views still queued when a new
+ *          file is configured remain readable. The offset is rounded up to the
+ *          alignment of the samples. The frame output copies the samples into
+ *          regular frames for components consuming frames, independently of
+ *          the view length. A frame left incomplete at the end of the file is
+ *          continued when looping and discarded on a new configuration.
+ *          Without a rate the file is emitted as fast as the consumers accept
+ *          it, otherwise the emission is paced to the rate without drift. At
+ *          the end of the file the source restarts when looping, or waits for
+ *          a new configuration.
+ */
+template <class Sample>
+class BasicMmapSource : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned config    = 0U;
+	static constexpr unsigned view      = 0U;
+	static constexpr unsigned frame_out = 1U;
+
+	BasicMmapSource()
+		: m_data(nullptr),
+		  m_size(0),
+		  m_retired(nullptr),
+		  m_retired_size(0),
+		  m_begin(0),
+		  m_end(0),
+		  m_position(0),
+		  m_advised(0),
+		  m_view_sequence(0),
+		  m_start(0),
+		  m_emitted(0),
+		  m_loops(0)
+	{
+		inputs.addPort<MmapSourceConfig>(config, 1);
+		outputs.addPort<FrameView<Sample>>(view);
+		outputs.addPort<Frame<Sample>>(frame_out);
+
+		std::memset(&m_config, 0, sizeof(m_config));
+	}
+
+	virtual ~BasicMmapSource()
+	{
+		// Unmapping the previous and the current file
+		retire();
+		retire();
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the file configuration
+		auto value = inputs[config].receive<MmapSourceConfig>();
+		if(value) open(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes, waiting for one at the end of the file
+		if(inputs[config].has_message() || m_position == m_end)
+		{
+			auto value = inputs[config].receive<MmapSourceConfig>();
+			if(!value) return;
+
+			open(value.value());
+		}
+
+		if(m_position == m_end) return;
+
+		// Emitting the next view of the mapping
+		const std::size_t available = (m_end - m_position) / sizeof(Sample);
+		const std::size_t length    = available < m_config.view_length ? available : m_config.view_length;
+
+		FrameView<Sample> record;
+		record.sequence = m_view_sequence++;
+		record.length   = (uint32_t) length;
+		record.samples  = reinterpret_cast<const Sample*>(m_data + m_position);
+
+		m_position += length * sizeof(Sample);
+		advise();
+
+		if(outputs[view].is_connected())
+		{
+			if(outputs[view].send<FrameView<Sample>>(record) != MessageStatus::Okay) return;
+		}
+
+		if(outputs[frame_out].is_connected())
+		{
+			if(!send_frames(record)) return;
+		}
+
+		// Restarting at the end of the file when looping
+		if(m_position == m_end && m_config.loop)
+		{
+			m_position = m_begin;
+			m_advised  = m_begin;
+			m_loops++;
+		}
+
+		pace(length);
+	}
+
+	/**
+	 * @brief  Queries the number of times the file was restarted.
+	 */
+	unsigned loops(void) const { return m_loops; }
+
+private:
+
+	void open(const MmapSourceConfig& value)
+	{
+		retire();
+
+		m_config = value;
+		m_config.path[MFLOW_MMAP_SOURCE_MAX_PATH - 1] = '\0';
+		if(m_config.view_length == 0) m_config.view_length = Frame<Sample>::length;
+
+		const int fd = ::open(m_config.path, O_RDONLY | O_CLOEXEC);
+		if(fd < 0)
+		{
+			MFLOW_LOGE("", "Mapped source cannot open %s.", m_config.path);
+			return;
+		}
+
+		// Mapping the whole file, the descriptor is not needed afterwards
+		struct stat status;
+		if(fstat(fd, &status) == 0 && status.st_size > 0)
+		{
+			void* address = mmap(nullptr, (std::size_t) status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if(address != MAP_FAILED)
+			{
+				m_data = static_cast<const uint8_t*>(address);
+				m_size = (std::size_t) status.st_size;
+			}
+		}
+
+		::close(fd);
+
+		if(m_data == nullptr) return;
+
+		madvise(const_cast<uint8_t*>(m_data), m_size, MADV_SEQUENTIAL);
+
+		// The views point into the mapping, so the offset is rounded up to the sample alignment
+		uint64_t offset = m_config.offset;
+		if(offset % alignof(Sample) != 0)
+		{
+			offset += alignof(Sample) - offset % alignof(Sample);
+			MFLOW_LOGW("", "Mapped source offset rounded up to %llu.", (unsigned long long) offset);
+		}
+
+		// Emitting whole samples between the offset and the end of the file
+		m_begin    = offset < m_size ? (std::size_t) offset : m_size;
+		m_end      = m_begin + (m_size - m_begin) / sizeof(Sample) * sizeof(Sample);
+		m_position = m_begin;
+		m_advised  = m_begin;
+		m_start    = os_tick_count();
+		m_emitted  = 0;
+
+		// Frames do not span files
+		m_assembler.clear();
+
+		advise();
+	}
+
+	// Unmaps the previous file and keeps the current one mapped for the views in flight
+	void retire(void)
+	{
+		if(m_retired != nullptr) munmap(const_cast<uint8_t*>(m_retired), m_retired_size);
+
+		m_retired      = m_data;
+		m_retired_size = m_size;
+
+		m_data     = nullptr;
+		m_size     = 0;
+		m_begin    = 0;
+		m_end      = 0;
+		m_position = 0;
+	}
+
+	// Requests the pages ahead of the read position once per read-ahead distance
+	void advise(void)
+	{
+		if(m_position + MFLOW_MMAP_SOURCE_READ_AHEAD / 2 < m_advised || m_advised >= m_end) return;
+
+		// Aligning the advice to pages
+		const std::size_t page  = (std::size_t) sysconf(_SC_PAGESIZE);
+		const std::size_t start = m_advised / page * page;
+		std::size_t       stop  = m_position + MFLOW_MMAP_SOURCE_READ_AHEAD;
+		if(stop > m_end) stop = m_end;
+
+		madvise(const_cast<uint8_t*>(m_data) + start, stop - start, MADV_WILLNEED);
+		m_advised = stop;
+	}
+
+	// Copies the samples of a view into frame messages, carrying the rest over to the next view
+	bool send_frames(const FrameView<Sample>& record)
+	{
+		for(std::size_t i = 0; i < record.length; i++)
+		{
+			if(!m_assembler.append(record.samples[i])) continue;
+
+			if(outputs[frame_out].send<Frame<Sample>>(m_assembler.frame()) != MessageStatus::Okay) return false;
+			m_assembler.next();
+		}
+
+		return true;
+	}
+
+	// Blocks while the emitted samples are ahead of the rate
+	void pace(std::size_t length)
+	{
+		if(m_config.rate == 0) return;
+
+		m_emitted += length;
+
+		const uint64_t target  = m_emitted * 1000U / m_config.rate;
+		const uint32_t elapsed = os_ticks_to_ms(os_tick_count() - m_start);
+
+		if(target > elapsed) os_delay((uint32_t) (target - elapsed));
+	}
+
+	MmapSourceConfig m_config;
+	const uint8_t*   m_data;
+	std::size_t      m_size;
+	const uint8_t*   m_retired;
+	std::size_t      m_retired_size;
+	std::size_t      m_begin;
+	std::size_t      m_end;
+	std::size_t      m_position;
+	std::size_t      m_advised;
+	uint32_t         m_view_sequence;
+	FrameAssembler<Sample> m_assembler;
+	os_tick_t        m_start;
+	uint64_t         m_emitted;
+	unsigned         m_loops;
+};
+
+typedef BasicMmapSource<double> MmapSource;
+
+#endif // !ESP_PLATFORM
+
+#endif // MFLOW_COMPONENTS_HOST_MMAP_SOURCE_H_INCLUDED
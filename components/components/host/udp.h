@@ -0,0 +1,544 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_HOST_UDP_H_INCLUDED
+#define MFLOW_COMPONENTS_HOST_UDP_H_INCLUDED
+
+#if !defined(ESP_PLATFORM)
+
+// Standard includes
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+// Linux includes
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "os.h"
+#include "sample.h"
+#include "wait_set.h"
+
+
+// Number of datagrams moved by one recvmmsg or sendmmsg call
+#ifndef MFLOW_UDP_BATCH
+#define MFLOW_UDP_BATCH (32)
+#endif
+
+// Maximum size of a received datagram in bytes, longer ones are truncated and discarded
+#ifndef MFLOW_UDP_MAX_DATAGRAM
+#define MFLOW_UDP_MAX_DATAGRAM (2048)
+#endif
+
+// Maximum number of batches read on one readiness of the socket
+#ifndef MFLOW_UDP_SOURCE_ROUNDS
+#define MFLOW_UDP_SOURCE_ROUNDS (8)
+#endif
+
+// Size of the socket receive buffer of a UDP source in bytes
+#ifndef MFLOW_UDP_RECEIVE_BUFFER
+#define MFLOW_UDP_RECEIVE_BUFFER (4 << 20)
+#endif
+
+// Maximum length of the address string of a UDP configuration
+#ifndef MFLOW_UDP_MAX_ADDRESS
+#define MFLOW_UDP_MAX_ADDRESS (16)
+#endif
+
+/**
+ * @brief Configuration of the UdpSource and UdpSink components.
+ */
+struct UdpConfig {
+	char     address[MFLOW_UDP_MAX_ADDRESS]; /**< IPv4 address, null terminated. Empty binds any address. */
+	uint16_t port;                           /**< UDP port, zero binds an ephemeral port.                 */
+};
+
+// Fills a socket address from a configuration, returns false for invalid addresses
+inline bool udp_resolve(const UdpConfig& value, struct sockaddr_in& address)
+{
+	char text[MFLOW_UDP_MAX_ADDRESS];
+	std::memcpy(text, value.address, sizeof(text));
+	text[MFLOW_UDP_MAX_ADDRESS - 1] = '\0';
+
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family = AF_INET;
+	address.sin_port   = htons(value.port);
+
+	if(text[0] == '\0')
+	{
+		address.sin_addr.s_addr = htonl(INADDR_ANY);
+		return true;
+	}
+
+	return inet_pton(AF_INET, text, &address.sin_addr) == 1;
+}
+
+/**
+ * @brief   Source component receiving datagrams from a UDP socket in batches.
+ * @details The socket is watched together with the configuration port in a
+ *          wait set, so no helper thread is needed. On readiness up to
+ *          MFLOW_UDP_BATCH datagrams are read with one recvmmsg call, each
+ *          directly into a slot of a buffer pool. The view output sends a
+ *          FrameView per datagram pointing into its slot, the payload is
+ *          interpreted as raw samples and no sample is copied. The slots are
+ *          reused in ring order, skipping only the ones whose view was sent,
+ *          and the pool covers the queue of the view consumer and one batch,
+ *          so a view stays valid until the consumer receives its next
+ *          message. The frame output expects datagrams holding exactly one
+ *          frame, as sent by the UdpSink, and copies them into the queue.
+ *          Messages are sent without blocking: when a consumer is full the
+ *          message is dropped, so the socket keeps being drained and the
+ *          kernel buffer does not overflow unnoticed. A datagram that no
+ *          output accepted is counted once, as dropped when a consumer was
+ *          full and as malformed otherwise.
+ */
+template <class Sample>
+class BasicUdpSource : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned config    = 0U;
+	static constexpr unsigned view      = 0U;
+	static constexpr unsigned frame_out = 1U;
+
+	static_assert(sizeof(Frame<Sample>) <= MFLOW_UDP_MAX_DATAGRAM, "A frame must fit into a datagram.");
+
+	BasicUdpSource()
+		: m_fd(-1),
+		  m_local_port(0),
+		  m_pool(nullptr),
+		  m_ring(nullptr),
+		  m_slots(0),
+		  m_head(0),
+		  m_sequence(0),
+		  m_received(0),
+		  m_dropped(0),
+		  m_malformed(0)
+	{
+		inputs.addPort<UdpConfig>(config, 1);
+		outputs.addPort<FrameView<Sample>>(view);
+		outputs.addPort<Frame<Sample>>(frame_out);
+
+		m_wait.add_port(config);
+	}
+
+	virtual ~BasicUdpSource()
+	{
+		close();
+		std::free(m_pool);
+		std::free(m_ring);
+	}
+
+	virtual void initialize(void) override
+	{
+		// Sizing the pool after the queue of the view consumer, which is known once connected
+		m_slots = MFLOW_UDP_BATCH + 1 + (unsigned) outputs[view].capacity();
+		m_pool  = static_cast<uint8_t*>(std::aligned_alloc(64, (std::size_t) m_slots * MFLOW_UDP_MAX_DATAGRAM));
+		m_ring  = static_cast<unsigned*>(std::malloc(m_slots * sizeof(unsigned)));
+
+		// Without the pool the socket is never opened
+		if(m_pool == nullptr || m_ring == nullptr)
+		{
+			MFLOW_LOGE("", "UDP source cannot allocate its pool of %u datagrams.", m_slots);
+			std::free(m_pool);
+			std::free(m_ring);
+			m_pool  = nullptr;
+			m_ring  = nullptr;
+			m_slots = 0;
+		}
+
+		for(unsigned i = 0; i < m_slots; i++) m_ring[i] = i;
+
+		// Reading the socket configuration
+		auto value = inputs[config].receive<UdpConfig>();
+		if(value) open(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		if(await(m_wait) != MessageStatus::Okay) return;
+
+		// Applying configuration changes
+		if(m_wait.port_ready(config))
+		{
+			auto value = inputs[config].receive<UdpConfig>();
+			if(value) open(value.value());
+			return;
+		}
+
+		if(m_fd >= 0 && m_wait.fd_events(m_fd)) receive();
+	}
+
+	/**
+	 * @brief  Queries the local port of the socket, useful after binding port zero.
+	 */
+	uint16_t local_port(void) const { return m_local_port; }
+
+	/**
+	 * @brief  Queries the number of received datagrams.
+	 */
+	uint64_t received(void) const { return m_received; }
+
+	/**
+	 * @brief  Queries the number of datagrams no output accepted because a consumer was full.
+	 */
+	uint64_t dropped(void) const { return m_dropped; }
+
+	/**
+	 * @brief  Queries the number of datagrams no output accepted for their size.
+	 */
+	uint64_t malformed(void) const { return m_malformed; }
+
+private:
+
+	void open(const UdpConfig& value)
+	{
+		close();
+
+		if(m_pool == nullptr) return;
+
+		struct sockaddr_in address;
+		if(!udp_resolve(value, address))
+		{
+			MFLOW_LOGE("", "UDP source has an invalid address.");
+			return;
+		}
+
+		m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+		if(m_fd < 0) return;
+
+		// Enlarging the receive buffer to absorb bursts while the graph is busy
+		const int size = MFLOW_UDP_RECEIVE_BUFFER;
+		setsockopt(m_fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+
+		if(bind(m_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0 || !m_wait.add_fd(m_fd))
+		{
+			MFLOW_LOGE("", "UDP source cannot bind port %u.", (unsigned) value.port);
+			close();
+			return;
+		}
+
+		socklen_t length = sizeof(address);
+		getsockname(m_fd, reinterpret_cast<struct sockaddr*>(&address), &length);
+		m_local_port = ntohs(address.sin_port);
+	}
+
+	void close(void)
+	{
+		if(m_fd < 0) return;
+
+		m_wait.remove_fd(m_fd);
+		::close(m_fd);
+
+		m_fd         = -1;
+		m_local_port = 0;
+	}
+
+	// Reads batches of datagrams into the pool until the socket is drained
+	void receive(void)
+	{
+		for(unsigned round = 0; round < MFLOW_UDP_SOURCE_ROUNDS; round++)
+		{
+			for(unsigned i = 0; i < MFLOW_UDP_BATCH; i++)
+			{
+				m_vectors[i].iov_base = slot(m_ring[(m_head + i) % m_slots]);
+				m_vectors[i].iov_len  = MFLOW_UDP_MAX_DATAGRAM;
+
+				std::memset(&m_messages[i], 0, sizeof(m_messages[i]));
+				m_messages[i].msg_hdr.msg_iov    = &m_vectors[i];
+				m_messages[i].msg_hdr.msg_iovlen = 1;
+			}
+
+			const int count = recvmmsg(m_fd, m_messages, MFLOW_UDP_BATCH, MSG_DONTWAIT, nullptr);
+			if(count <= 0) return;
+
+			// Keeping the slots of the sent views in ring order, the others are reused first
+			unsigned kept[MFLOW_UDP_BATCH];
+			unsigned freed[MFLOW_UDP_BATCH];
+			unsigned kept_count  = 0;
+			unsigned freed_count = 0;
+
+			for(int i = 0; i < count; i++)
+			{
+				const unsigned index = m_ring[(m_head + i) % m_slots];
+
+				if(dispatch(slot(index), m_messages[i].msg_len, m_messages[i].msg_hdr.msg_flags)) kept[kept_count++] = index;
+				else                                                                               freed[freed_count++] = index;
+			}
+
+			for(unsigned i = 0; i < kept_count; i++)  m_ring[(m_head + i) % m_slots]              = kept[i];
+			for(unsigned i = 0; i < freed_count; i++) m_ring[(m_head + kept_count + i) % m_slots] = freed[i];
+
+			m_head = (m_head + kept_count) % m_slots;
+
+			if(count < MFLOW_UDP_BATCH) return;
+		}
+	}
+
+	// Maps a received datagram to the output messages, returns whether a view refers to it
+	bool dispatch(const uint8_t* data, unsigned length, int flags)
+	{
+		m_received++;
+
+		if(flags & MSG_TRUNC)
+		{
+			m_malformed++;
+			return false;
+		}
+
+		bool referenced = false;
+		bool accepted   = false;
+		bool full       = false;
+		bool wrong_size = false;
+
+		if(outputs[view].is_connected())
+		{
+			FrameView<Sample> record;
+			record.sequence = m_sequence++;
+			record.length   = length / sizeof(Sample);
+			record.samples  = reinterpret_cast<const Sample*>(data);
+
+			const MessageStatus status = outputs[view].try_send<FrameView<Sample>>(record);
+
+			referenced = status == MessageStatus::Okay;
+			accepted   = referenced;
+			full       = status == MessageStatus::Full;
+		}
+
+		if(outputs[frame_out].is_connected())
+		{
+			if(length != sizeof(Frame<Sample>)) wrong_size = true;
+			else
+			{
+				const MessageStatus status = outputs[frame_out].try_send<Frame<Sample>>(*reinterpret_cast<const Frame<Sample>*>(data));
+
+				accepted = accepted || status == MessageStatus::Okay;
+				full     = full || status == MessageStatus::Full;
+			}
+		}
+
+		// Counting the datagram once, only when no output accepted it
+		if(!accepted && full)            m_dropped++;
+		else if(!accepted && wrong_size) m_malformed++;
+
+		return referenced;
+	}
+
+	uint8_t* slot(unsigned index) { return m_pool + (std::size_t) index * MFLOW_UDP_MAX_DATAGRAM; }
+
+	WaitSet         m_wait;
+	int             m_fd;
+	uint16_t        m_local_port;
+	uint8_t*        m_pool;
+	unsigned*       m_ring;
+	unsigned        m_slots;
+	unsigned        m_head;
+	uint32_t        m_sequence;
+	struct mmsghdr  m_messages[MFLOW_UDP_BATCH];
+	struct iovec    m_vectors[MFLOW_UDP_BATCH];
+	uint64_t        m_received;
+	uint64_t        m_dropped;
+	uint64_t        m_malformed;
+};
+
+/**
+ * @brief   Sink component sending messages as UDP datagrams in batches.
+ * @details Every frame is sent as one datagram holding the frame as it is,
+ *          the format the frame output of the UdpSource expects. The frames
+ *          waiting in the queue are collected, up to MFLOW_UDP_BATCH of
+ *          them, and sent with one sendmmsg call directly from the received
+ *          messages. The samples of a view are sent without copying, split
+ *          into datagrams of at most MFLOW_UDP_MAX_DATAGRAM bytes. Datagrams
+ *          the kernel refuses, for example while nothing listens on a local
+ *          destination, are dropped and counted. Both ends must use the same
+ *          sample type and byte order.
+ */
+template <class Sample>
+class BasicUdpSink : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned frame_in = 0U;
+	static constexpr unsigned view_in  = 1U;
+	static constexpr unsigned config   = 2U;
+
+	BasicUdpSink()
+		: m_fd(-1),
+		  m_sent(0),
+		  m_dropped(0)
+	{
+		inputs.addPort<Frame<Sample>>(frame_in, MFLOW_UDP_BATCH);
+		inputs.addPort<FrameView<Sample>>(view_in, 4);
+		inputs.addPort<UdpConfig>(config, 1);
+	}
+
+	virtual ~BasicUdpSink()
+	{
+		close();
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the destination configuration
+		auto value = inputs[config].receive<UdpConfig>();
+		if(value) open(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		auto index = await({frame_in, view_in, config});
+		if(!index) return;
+
+		switch(index.value())
+		{
+			case frame_in: send_frames(); break;
+			case view_in:  send_view();   break;
+
+			case config:
+			{
+				// Applying configuration changes
+				auto value = inputs[config].receive<UdpConfig>();
+				if(value) open(value.value());
+				break;
+			}
+		}
+	}
+
+	/**
+	 * @brief  Queries the number of sent datagrams.
+	 */
+	uint64_t sent(void) const { return m_sent; }
+
+	/**
+	 * @brief  Queries the number of datagrams dropped on send errors.
+	 */
+	uint64_t dropped(void) const { return m_dropped; }
+
+private:
+
+	void open(const UdpConfig& value)
+	{
+		close();
+
+		struct sockaddr_in address;
+		if(!udp_resolve(value, address))
+		{
+			MFLOW_LOGE("", "UDP sink has an invalid address.");
+			return;
+		}
+
+		// Connecting the socket, so the datagrams need no destination address
+		m_fd = socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+		if(m_fd < 0) return;
+
+		if(connect(m_fd, reinterpret_cast<struct sockaddr*>(&address), sizeof(address)) != 0)
+		{
+			MFLOW_LOGE("", "UDP sink cannot reach port %u.", (unsigned) value.port);
+			close();
+		}
+	}
+
+	void close(void)
+	{
+		if(m_fd >= 0) ::close(m_fd);
+		m_fd = -1;
+	}
+
+	// Sends the frames waiting in the queue as one batch
+	void send_frames(void)
+	{
+		unsigned count = 0;
+
+		while(count < MFLOW_UDP_BATCH && inputs[frame_in].has_message())
+		{
+			auto frame = inputs[frame_in].receive<Frame<Sample>>();
+			if(!frame) break;
+
+			m_frames[count] = frame.value();
+			prepare(count, &m_frames[count], sizeof(Frame<Sample>));
+			count++;
+		}
+
+		send(count);
+	}
+
+	// Sends the samples of a view split into datagrams
+	void send_view(void)
+	{
+		auto value = inputs[view_in].receive<FrameView<Sample>>();
+		if(!value) return;
+
+		const FrameView<Sample> record   = value.value();
+		const std::size_t       per_part = MFLOW_UDP_MAX_DATAGRAM / sizeof(Sample);
+		std::size_t             position = 0;
+
+		while(position < record.length)
+		{
+			unsigned count = 0;
+
+			while(count < MFLOW_UDP_BATCH && position < record.length)
+			{
+				const std::size_t length = record.length - position < per_part ? record.length - position : per_part;
+
+				prepare(count++, record.samples + position, length * sizeof(Sample));
+				position += length;
+			}
+
+			send(count);
+		}
+	}
+
+	void prepare(unsigned index, const void* data, std::size_t length)
+	{
+		m_vectors[index].iov_base = const_cast<void*>(data);
+		m_vectors[index].iov_len  = length;
+
+		std::memset(&m_messages[index], 0, sizeof(m_messages[index]));
+		m_messages[index].msg_hdr.msg_iov    = &m_vectors[index];
+		m_messages[index].msg_hdr.msg_iovlen = 1;
+	}
+
+	// Sends the prepared datagrams, skipping the ones the kernel refuses
+	void send(unsigned count)
+	{
+		unsigned sent = 0;
+
+		while(sent < count)
+		{
+			const int status = m_fd < 0 ? -1 : sendmmsg(m_fd, m_messages + sent, count - sent, 0);
+
+			if(status > 0)
+			{
+				sent   += (unsigned) status;
+				m_sent += (unsigned) status;
+			}
+			else if(status < 0 && errno == EINTR) continue;
+			else
+			{
+				// The first datagram failed, dropping it and retrying the rest
+				sent++;
+				m_dropped++;
+				if(m_fd < 0) { m_dropped += count - sent; break; }
+			}
+		}
+	}
+
+	int            m_fd;
+	Frame<Sample>  m_frames[MFLOW_UDP_BATCH];
+	struct mmsghdr m_messages[MFLOW_UDP_BATCH];
+	struct iovec   m_vectors[MFLOW_UDP_BATCH];
+	uint64_t       m_sent;
+	uint64_t       m_dropped;
+};
+
+typedef BasicUdpSource<double> UdpSource;
+typedef BasicUdpSink<double>   UdpSink;
+
+#endif // !ESP_PLATFORM
+
+#endif // MFLOW_COMPONENTS_HOST_UDP_H_INCLUDED
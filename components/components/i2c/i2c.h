@@ -2,73 +2,279 @@
 #ifndef MFLOW_ESP_IDF_I2C_H_INCLUDED
 #define MFLOW_ESP_IDF_I2C_H_INCLUDED
 
-// FreeRTOS includes
-#include "freertos/FreeRTOS.h"
-#include "freertos/semphr.h"
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 
-// ESP-IDF includes
-#include "driver/i2c.h"
+// Driver includes
+#include "i2c_driver.h"
 
 // Project includes
 #include "component.h"
+#include "os.h"
+
+
+// Number of command chains in the shared pool
+#ifndef MFLOW_I2C_POOL_SIZE
+#define MFLOW_I2C_POOL_SIZE (8)
+#endif
+
+// Maximum number of start-address-data-stop transactions in a command chain
+#ifndef MFLOW_I2C_MAX_TRANSACTIONS
+#define MFLOW_I2C_MAX_TRANSACTIONS (8)
+#endif
+
+// Maximum number of bytes written by the multi-byte writes of a command chain
+#ifndef MFLOW_I2C_MAX_WRITE
+#define MFLOW_I2C_MAX_WRITE (32)
+#endif
+
+// Maximum number of bytes read by a command chain
+#ifndef MFLOW_I2C_MAX_READ
+#define MFLOW_I2C_MAX_READ (64)
+#endif
+
+class I2C_CommandPool;
+
+/**
+ * @brief   Completion message of an asynchronous command chain.
+ * @details Emitted by the I2C_Master on its result port, carrying the bytes
+ *          read by the chain in the order of the queued reads.
+ */
+struct I2C_Completion {
+	uint32_t tag;                       /**< Tag assigned by the issuer of the chain. */
+	bool     status;                    /**< True if the chain executed successfully. */
+	uint8_t  length;                    /**< Number of valid bytes in data.           */
+	uint8_t  data[MFLOW_I2C_MAX_READ];  /**< The bytes read by the chain.             */
+};
 
+/**
+ * @brief   Reusable I2C command chain owned by the I2C_CommandPool.
+ * @details The command link is built in a buffer of the chain and the
+ *          synchronization semaphore is created once with the pool, so
+ *          issuing a transaction allocates nothing. Written data is copied
+ *          into the chain and read data is collected in the chain, so the
+ *          issuer does not have to keep its buffers alive until execution.
+ *
+ *          Chains are sent to the I2C_Master by pointer. A synchronous issuer
+ *          waits with #wait_for_execute() and releases the chain afterwards,
+ *          an asynchronous chain is released by the master, which sends the
+ *          result as an I2C_Completion message instead.
+ */
 class I2C_CommandChain {
 public:
 
-	// The I2C master component needs access to the command chain handle
+	// The I2C master and the pool need access to the internals of the chain
 	friend class I2C_Master;
+	friend class I2C_CommandPool;
 
-	I2C_CommandChain(void)
-		: m_commands(i2c_cmd_link_create()),
-		  m_synch(xSemaphoreCreateBinary()),
-		  m_status(false)
-	{}
+	I2C_CommandChain(const I2C_CommandChain&)            = delete;
+	I2C_CommandChain& operator=(const I2C_CommandChain&) = delete;
 
 	void queue_start(void) {
-		i2c_master_start(m_commands);
+		check(i2c_master_start(m_commands));
 	}
 
-	void queue_stop(void)  {
-		i2c_master_stop(m_commands);
+	void queue_stop(void) {
+		check(i2c_master_stop(m_commands));
 	}
 
-	void queue_read(uint8_t data[], uint8_t length) {
-		i2c_master_read(m_commands, data, length, I2C_MASTER_LAST_NACK);
+	/**
+	 * @brief Queues reading the specified number of bytes into the chain.
+	 */
+	void queue_read(uint8_t length) {
+
+		if(length == 0 || m_read_length + length > MFLOW_I2C_MAX_READ)
+		{
+			m_overflow = true;
+			return;
+		}
+
+		check(i2c_master_read(m_commands, &m_read[m_read_length], length, I2C_MASTER_LAST_NACK));
+		m_read_length += length;
 	}
 
-	void queue_read_byte(uint8_t* byte, uint8_t length) {
-		i2c_master_read_byte(m_commands, byte, I2C_MASTER_LAST_NACK);
+	void queue_read_byte(void) {
+		queue_read(1);
 	}
 
-	void queue_write(uint8_t data[], uint8_t length) {
-		i2c_master_write(m_commands, data, length, true);
+	/**
+	 * @brief Queues writing the specified bytes, which are copied into the chain.
+	 */
+	void queue_write(const uint8_t data[], uint8_t length) {
+
+		if(length == 0 || m_write_length + length > MFLOW_I2C_MAX_WRITE)
+		{
+			m_overflow = true;
+			return;
+		}
+
+		std::memcpy(&m_write[m_write_length], data, length);
+		check(i2c_master_write(m_commands, &m_write[m_write_length], length, true));
+		m_write_length += length;
 	}
 
 	void queue_write_byte(uint8_t byte) {
-		i2c_master_write_byte(m_commands, byte, true);
+		check(i2c_master_write_byte(m_commands, byte, true));
 	}
 
+	/**
+	 * @brief Requests the result to be sent as an I2C_Completion message with the specified tag.
+	 */
+	void set_asynchronous(uint32_t tag) {
+		m_asynchronous = true;
+		m_tag          = tag;
+	}
+
+	/**
+	 * @brief  Blocks until the I2C_Master executed a synchronous chain.
+	 * @retval True if the chain executed successfully.
+	 */
 	bool wait_for_execute(void) {
+		os_semaphore_take(m_synch, MFLOW_OS_WAIT_FOREVER);
+		return m_status;
+	}
 
-		xSemaphoreTake(m_synch, portMAX_DELAY);
+	// Accessors of the bytes read by an executed chain
+	const uint8_t* read_data(void)   const { return m_read; }
+	uint8_t        read_length(void) const { return m_read_length; }
 
-		i2c_cmd_link_delete(m_commands);
-		vSemaphoreDelete(m_synch);
+	/**
+	 * @brief Returns the chain to its pool.
+	 */
+	void release(void);
 
-		return m_status;
+private:
+
+	I2C_CommandChain(void)
+		: m_commands(nullptr),
+		  m_synch(os_semaphore_create()),
+		  m_pool(nullptr)
+	{
+		reset();
+	}
+
+	// Rebuilds the empty command link in the buffer of the chain
+	void reset(void) {
+
+		// Discarding the signal of an execution nobody waited for, so it does not end the next wait early
+		os_semaphore_take(m_synch, 0);
+
+		m_commands     = i2c_cmd_link_create_static(m_link, sizeof(m_link));
+		m_write_length = 0;
+		m_read_length  = 0;
+		m_tag          = 0;
+		m_status       = false;
+		m_overflow     = m_commands == nullptr;
+		m_asynchronous = false;
+	}
+
+	void check(esp_err_t status) {
+		if(status != ESP_OK) m_overflow = true;
 	}
 
 	void set_execution_result(bool status) {
 		m_status = status;
-		xSemaphoreGive(m_synch);
+		os_semaphore_give(m_synch);
+	}
+
+	alignas(std::max_align_t) uint8_t m_link[I2C_LINK_RECOMMENDED_SIZE(MFLOW_I2C_MAX_TRANSACTIONS)];
+
+	i2c_cmd_handle_t m_commands;
+	os_semaphore_t   m_synch;
+	I2C_CommandPool* m_pool;
+	uint8_t          m_write[MFLOW_I2C_MAX_WRITE];
+	uint8_t          m_read[MFLOW_I2C_MAX_READ];
+	uint8_t          m_write_length;
+	uint8_t          m_read_length;
+	uint32_t         m_tag;
+	bool             m_status;
+	bool             m_overflow;
+	bool             m_asynchronous;
+};
+
+/**
+ * @brief   Fixed pool of reusable command chains.
+ * @details The free chains are kept in an operating system queue, so acquiring and
+ *          releasing is safe from any task, and acquiring blocks while all
+ *          chains are in flight, which bounds the number of pipelined
+ *          transactions.
+ */
+class I2C_CommandPool {
+public:
+
+	/**
+	 * @brief  Queries the pool shared by all I2C components, creating it on the first call.
+	 * @retval Reference to the shared pool.
+	 */
+	static I2C_CommandPool& shared(void)
+	{
+		static I2C_CommandPool pool;
+		return pool;
+	}
+
+	/**
+	 * @brief  Takes an empty command chain from the pool.
+	 * @param  timeout_ms [in] The maximum time to wait for a free chain in milliseconds.
+	 * @retval Pointer to the chain, nullptr on timeout.
+	 */
+	I2C_CommandChain* acquire(uint32_t timeout_ms = MFLOW_OS_WAIT_FOREVER)
+	{
+		I2C_CommandChain* chain = nullptr;
+		if(!os_queue_receive(m_free, &chain, timeout_ms)) return nullptr;
+
+		chain->reset();
+		return chain;
+	}
+
+	/**
+	 * @brief Returns a command chain to the pool.
+	 */
+	void release(I2C_CommandChain* chain)
+	{
+		if(chain != nullptr) os_queue_send(m_free, &chain, 0);
+	}
+
+	/**
+	 * @brief  Queries the number of free chains.
+	 */
+	unsigned available(void) const
+	{
+		return os_queue_count(m_free);
 	}
 
+	I2C_CommandPool(const I2C_CommandPool&)            = delete;
+	I2C_CommandPool& operator=(const I2C_CommandPool&) = delete;
+
 private:
-	i2c_cmd_handle_t  m_commands;
-	SemaphoreHandle_t m_synch;
-	bool              m_status;
+
+	I2C_CommandPool(void) : m_free(os_queue_create(sizeof(I2C_CommandChain*), MFLOW_I2C_POOL_SIZE))
+	{
+		for(unsigned i = 0; i < MFLOW_I2C_POOL_SIZE; i++)
+		{
+			I2C_CommandChain* chain = &m_chains[i];
+			chain->m_pool = this;
+			release(chain);
+		}
+	}
+
+	I2C_CommandChain m_chains[MFLOW_I2C_POOL_SIZE];
+	os_queue_t       m_free;
 };
 
+inline void I2C_CommandChain::release(void)
+{
+	m_pool->release(this);
+}
+
+/**
+ * @brief   Component executing I2C command chains on an I2C bus.
+ * @details Chains arrive by pointer on the command port. Synchronous chains
+ *          wake their waiting issuer, asynchronous chains are released to
+ *          the pool and their result is sent on the result port, so issuers
+ *          can pipeline many transactions without blocking.
+ */
 class I2C_Master : public Component
 {
 public:
@@ -80,16 +286,22 @@ public:
 	static constexpr unsigned scl_pin  = 3U;
 	static constexpr unsigned speed_hz = 4U;
 
+	// Output port index definitions
+	static constexpr unsigned result   = 0U;
+
 	I2C_Master() : m_port(0)
 	{
 		// Adding input port for receiving command chains
-		inputs.addPort<I2C_CommandChain>(command, 10);
+		inputs.addPort<I2C_CommandChain*>(command, MFLOW_I2C_POOL_SIZE);
 
 		// Adding configuration inputs
 		inputs.addPort<unsigned>(port,     1);
 		inputs.addPort<unsigned>(sda_pin,  1);
 		inputs.addPort<unsigned>(scl_pin,  1);
 		inputs.addPort<unsigned>(speed_hz, 1);
+
+		// Adding output port for the results of asynchronous chains
+		outputs.addPort<I2C_Completion>(result);
 	}
 
 	virtual void initialize(void) override {
@@ -104,35 +316,52 @@ public:
 		if(!port_config || !sda_config || !scl_config || !speed_config) return;
 
 		// Saving port identifier
-		m_port = port_config;
+		m_port = port_config.value();
 
 		// Configuring I2C bus parameters
 		i2c_config_t config;
 		config.mode = I2C_MODE_MASTER;
-		config.sda_io_num = sda_pin;
+		config.sda_io_num = sda_config.value();
 		config.sda_pullup_en = GPIO_PULLUP_ENABLE;
-		config.scl_io_num = scl_pin;
+		config.scl_io_num = scl_config.value();
 		config.scl_pullup_en = GPIO_PULLUP_ENABLE;
-		config.master.clk_speed = speed_hz;
+		config.master.clk_speed = speed_config.value();
 
 		// Applying configuration
-		i2c_param_config(port, &config);
-		i2c_driver_install(port, config.mode, 0, 0, 0);
+		i2c_param_config(m_port, &config);
+		i2c_driver_install(m_port, config.mode, 0, 0, 0);
 	}
 
 	virtual void process(void) override {
 
 		// Waiting for a command chain to arrive and execute
-		auto commands = inputs[command].receive<I2C_CommandChain>();
+		auto commands = inputs[command].receive<I2C_CommandChain*>();
 
 		// Checking validity of received message
-		if(!commands) return;
+		if(!commands || commands.value() == nullptr) return;
+
+		I2C_CommandChain* chain = commands.value();
+
+		// Executing command chain, chains with rejected commands are not started
+		int status = chain->m_overflow ? ESP_FAIL : i2c_master_cmd_begin(m_port, chain->m_commands, 100 / portTICK_RATE_MS);
+
+		if(!chain->m_asynchronous)
+		{
+			// Sending signal to the caller that the operation finished
+			chain->set_execution_result(status == ESP_OK);
+			return;
+		}
+
+		// Releasing the chain before sending its result, so the receiver can reuse it
+		I2C_Completion completion;
+		completion.tag    = chain->m_tag;
+		completion.status = status == ESP_OK;
+		completion.length = chain->m_read_length;
+		std::memcpy(completion.data, chain->m_read, chain->m_read_length);
 
-		// Executing command chain
-		int status = i2c_master_cmd_begin(m_port, commands.value().m_commands, 100 / portTICK_RATE_MS);
+		chain->release();
 
-		// Sending signal to the caller that the operation finished
-		commands.value().set_execution_result(status == ESP_OK);
+		if(outputs[result].is_connected()) outputs[result].send<I2C_Completion>(completion);
 	}
 
 private:
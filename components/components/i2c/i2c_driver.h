@@ -0,0 +1,285 @@
+#pragma once
+#ifndef MFLOW_ESP_IDF_I2C_DRIVER_H_INCLUDED
+#define MFLOW_ESP_IDF_I2C_DRIVER_H_INCLUDED
+
+/**
+ * @file    i2c_driver.h
+ * @brief   Selects the I2C master driver used by the I2C components.
+ * @details On the ESP platform the ESP-IDF driver is used. On other hosts a
+ *          mock with the same interface executes the command links against
+ *          I2C_MockDevice objects attached to bus addresses, so the I2C
+ *          components can be exercised without hardware.
+ */
+
+#ifdef ESP_PLATFORM
+
+// ESP-IDF includes
+#include "driver/i2c.h"
+
+#else
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+
+// Maximum number of I2C ports of the mock driver
+#ifndef MFLOW_I2C_MOCK_PORTS
+#define MFLOW_I2C_MOCK_PORTS (2)
+#endif
+
+typedef int      esp_err_t;
+typedef int      i2c_port_t;
+typedef uint32_t TickType_t;
+
+// The mock driver counts time in milliseconds
+#ifndef portTICK_RATE_MS
+#define portTICK_RATE_MS (1)
+#endif
+
+#define ESP_OK   (0)
+#define ESP_FAIL (-1)
+
+#define I2C_MASTER_WRITE (0)
+#define I2C_MASTER_READ  (1)
+
+typedef enum { I2C_MASTER_ACK, I2C_MASTER_NACK, I2C_MASTER_LAST_NACK } i2c_ack_type_t;
+typedef enum { I2C_MODE_SLAVE, I2C_MODE_MASTER } i2c_mode_t;
+typedef enum { GPIO_PULLUP_DISABLE, GPIO_PULLUP_ENABLE } gpio_pullup_t;
+
+typedef struct {
+	i2c_mode_t    mode;
+	int           sda_io_num;
+	gpio_pullup_t sda_pullup_en;
+	int           scl_io_num;
+	gpio_pullup_t scl_pullup_en;
+	struct { uint32_t clk_speed; } master;
+} i2c_config_t;
+
+/**
+ * @brief Simulated I2C slave device attached to the mock driver.
+ */
+class I2C_MockDevice {
+public:
+
+	virtual ~I2C_MockDevice() { }
+
+	/**
+	 * @brief  Called after the address byte selecting the device.
+	 * @param  read [in] True for a read transfer, false for a write transfer.
+	 * @retval True to acknowledge the address.
+	 */
+	virtual bool start(bool read) { (void) read; return true; }
+
+	/**
+	 * @brief  Called for every byte written to the device.
+	 * @retval True to acknowledge the byte.
+	 */
+	virtual bool write(uint8_t byte) = 0;
+
+	/**
+	 * @brief  Called for every byte read from the device.
+	 * @retval The byte driven by the device.
+	 */
+	virtual uint8_t read(void) = 0;
+
+	/**
+	 * @brief Called on the stop condition.
+	 */
+	virtual void stop(void) { }
+};
+
+/**
+ * @brief Single queued operation of a mock command link.
+ */
+struct i2c_mock_operation {
+	enum { Start, Stop, Write, WriteByte, Read } type;
+	uint8_t*       data;   /**< Target of reads, source of writes. */
+	size_t         length; /**< Number of bytes transferred.       */
+	uint8_t        byte;   /**< The byte of single byte writes.    */
+	bool           ack;    /**< Whether writes check the ACK bit.  */
+	i2c_ack_type_t nack;   /**< ACK generated by reads.            */
+};
+
+// Maximum number of operations of a link built in a buffer of the specified size
+#define I2C_MOCK_LINK_OPERATIONS(SIZE) (((SIZE) - sizeof(i2c_mock_link)) / sizeof(i2c_mock_operation))
+
+/**
+ * @brief Mock command link, the operations follow the header in the same buffer.
+ */
+struct i2c_mock_link {
+	size_t capacity; /**< Number of operation slots after the header. */
+	size_t count;    /**< Number of queued operations.                */
+	bool   overflow; /**< Set when an operation did not fit.          */
+	bool   dynamic;  /**< Set when the link owns its buffer.          */
+
+	i2c_mock_operation* operations(void) { return reinterpret_cast<i2c_mock_operation*>(this + 1); }
+};
+
+typedef i2c_mock_link* i2c_cmd_handle_t;
+
+// Buffer size needed by a link with the specified number of start-address-data-stop transactions
+#define I2C_LINK_RECOMMENDED_SIZE(TRANSACTIONS) (sizeof(i2c_mock_link) + sizeof(i2c_mock_operation) * (5 * (TRANSACTIONS) + 2))
+
+/**
+ * @brief  Queries the device slot of a port and 7-bit address.
+ * @retval Reference to the attached device pointer, nullptr if none is attached.
+ */
+inline I2C_MockDevice*& i2c_mock_device(i2c_port_t port, uint8_t address)
+{
+	static I2C_MockDevice* devices[MFLOW_I2C_MOCK_PORTS][128] = { };
+	return devices[port % MFLOW_I2C_MOCK_PORTS][address & 0x7F];
+}
+
+/**
+ * @brief Attaches a simulated device to the bus, nullptr detaches the current one.
+ */
+inline void i2c_mock_attach(i2c_port_t port, uint8_t address, I2C_MockDevice* device)
+{
+	i2c_mock_device(port, address) = device;
+}
+
+inline i2c_cmd_handle_t i2c_cmd_link_create_static(uint8_t* buffer, uint32_t size)
+{
+	if(buffer == nullptr || size < sizeof(i2c_mock_link)) return nullptr;
+
+	i2c_mock_link* link = new (buffer) i2c_mock_link;
+	link->capacity = I2C_MOCK_LINK_OPERATIONS(size);
+	link->count    = 0;
+	link->overflow = false;
+	link->dynamic  = false;
+
+	return link;
+}
+
+inline void i2c_cmd_link_delete_static(i2c_cmd_handle_t) { }
+
+inline i2c_cmd_handle_t i2c_cmd_link_create(void)
+{
+	const uint32_t  size   = I2C_LINK_RECOMMENDED_SIZE(4);
+	i2c_cmd_handle_t link  = i2c_cmd_link_create_static(new uint8_t[size], size);
+
+	link->dynamic = true;
+	return link;
+}
+
+inline void i2c_cmd_link_delete(i2c_cmd_handle_t link)
+{
+	if(link != nullptr && link->dynamic) delete[] reinterpret_cast<uint8_t*>(link);
+}
+
+inline esp_err_t i2c_mock_queue(i2c_cmd_handle_t link, const i2c_mock_operation& operation)
+{
+	if(link == nullptr) return ESP_FAIL;
+
+	if(link->count == link->capacity)
+	{
+		link->overflow = true;
+		return ESP_FAIL;
+	}
+
+	link->operations()[link->count++] = operation;
+	return ESP_OK;
+}
+
+inline esp_err_t i2c_master_start(i2c_cmd_handle_t link)
+{
+	return i2c_mock_queue(link, { i2c_mock_operation::Start, nullptr, 0, 0, false, I2C_MASTER_ACK });
+}
+
+inline esp_err_t i2c_master_stop(i2c_cmd_handle_t link)
+{
+	return i2c_mock_queue(link, { i2c_mock_operation::Stop, nullptr, 0, 0, false, I2C_MASTER_ACK });
+}
+
+inline esp_err_t i2c_master_write(i2c_cmd_handle_t link, const uint8_t* data, size_t length, bool ack)
+{
+	return i2c_mock_queue(link, { i2c_mock_operation::Write, const_cast<uint8_t*>(data), length, 0, ack, I2C_MASTER_ACK });
+}
+
+inline esp_err_t i2c_master_write_byte(i2c_cmd_handle_t link, uint8_t byte, bool ack)
+{
+	return i2c_mock_queue(link, { i2c_mock_operation::WriteByte, nullptr, 1, byte, ack, I2C_MASTER_ACK });
+}
+
+inline esp_err_t i2c_master_read(i2c_cmd_handle_t link, uint8_t* data, size_t length, i2c_ack_type_t nack)
+{
+	return i2c_mock_queue(link, { i2c_mock_operation::Read, data, length, 0, false, nack });
+}
+
+inline esp_err_t i2c_master_read_byte(i2c_cmd_handle_t link, uint8_t* data, i2c_ack_type_t nack)
+{
+	return i2c_mock_queue(link, { i2c_mock_operation::Read, data, 1, 0, false, nack });
+}
+
+/**
+ * @brief   Executes a command link against the attached devices.
+ * @details The first byte written after a start condition addresses the
+ *          device. Writes to an absent device or bytes not acknowledged by
+ *          the device fail the whole link when ACK checking is enabled.
+ */
+inline esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t link, TickType_t)
+{
+	if(link == nullptr || link->overflow) return ESP_FAIL;
+
+	I2C_MockDevice* device    = nullptr;
+	bool            addressed = false;
+
+	for(size_t i = 0; i < link->count; i++)
+	{
+		const i2c_mock_operation& operation = link->operations()[i];
+
+		switch(operation.type)
+		{
+			case i2c_mock_operation::Start:
+				device    = nullptr;
+				addressed = true;
+				break;
+
+			case i2c_mock_operation::Stop:
+				if(device != nullptr) device->stop();
+				device    = nullptr;
+				addressed = false;
+				break;
+
+			case i2c_mock_operation::Write:
+			case i2c_mock_operation::WriteByte:
+				for(size_t b = 0; b < operation.length; b++)
+				{
+					const uint8_t byte = operation.type == i2c_mock_operation::Write ? operation.data[b] : operation.byte;
+					bool          ack;
+
+					if(addressed)
+					{
+						// Selecting the device with the address byte
+						addressed = false;
+						device    = i2c_mock_device(port, byte >> 1);
+						ack       = device != nullptr && device->start((byte & 1) == I2C_MASTER_READ);
+					}
+					else
+					{
+						ack = device != nullptr && device->write(byte);
+					}
+
+					if(operation.ack && !ack) return ESP_FAIL;
+				}
+				break;
+
+			case i2c_mock_operation::Read:
+				if(device == nullptr) return ESP_FAIL;
+				for(size_t b = 0; b < operation.length; b++) operation.data[b] = device->read();
+				break;
+		}
+	}
+
+	return ESP_OK;
+}
+
+inline esp_err_t i2c_param_config(i2c_port_t, const i2c_config_t*) { return ESP_OK; }
+
+inline esp_err_t i2c_driver_install(i2c_port_t, i2c_mode_t, size_t, size_t, int) { return ESP_OK; }
+
+#endif // ESP_PLATFORM
+
+#endif // MFLOW_ESP_IDF_I2C_DRIVER_H_INCLUDED
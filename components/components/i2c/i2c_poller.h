@@ -0,0 +1,238 @@
+#pragma once
+#ifndef MFLOW_ESP_IDF_I2C_POLLER_H_INCLUDED
+#define MFLOW_ESP_IDF_I2C_POLLER_H_INCLUDED
+
+// Standard includes
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "i2c.h"
+#include "os.h"
+
+
+// Maximum number of register bursts read in one polling period
+#ifndef MFLOW_I2C_POLL_MAX_BURSTS
+#define MFLOW_I2C_POLL_MAX_BURSTS (4)
+#endif
+
+/**
+ * @brief Burst read of consecutive registers of a device.
+ */
+struct I2C_PollBurst {
+	uint8_t address;  /**< 7-bit address of the device.         */
+	uint8_t reg;      /**< The first register of the burst.     */
+	uint8_t length;   /**< Number of bytes read from the device. */
+};
+
+/**
+ * @brief Encoding of a value in the bytes of a burst.
+ */
+enum class I2C_PollFormat : uint8_t {
+	U8, S8,
+	U16_BE, S16_BE, U16_LE, S16_LE,
+	U24_BE, S24_BE,
+	U32_BE, S32_BE
+};
+
+/**
+ * @brief   Value extracted from a burst and sent on a channel output.
+ * @details The value is decoded from the bytes starting at offset in the
+ *          specified burst and converted as raw * scale + bias.
+ */
+struct I2C_PollChannel {
+	uint8_t        burst;  /**< Index of the burst containing the value. */
+	uint8_t        offset; /**< Offset of the first byte in the burst.   */
+	I2C_PollFormat format; /**< Encoding of the value.                   */
+	float          scale;  /**< Scale applied to the raw value.          */
+	float          bias;   /**< Bias added to the scaled value.          */
+};
+
+/**
+ * @brief Polling plan of an I2C_Poller, sent on the plan option port.
+ */
+template <unsigned Channels>
+struct I2C_PollPlan {
+	unsigned        bursts;                           /**< Number of valid bursts.           */
+	I2C_PollBurst   burst[MFLOW_I2C_POLL_MAX_BURSTS]; /**< The bursts in reading order.      */
+	I2C_PollChannel channel[Channels];                /**< The values sent on the channels.  */
+};
+
+/**
+ * @brief   Component polling registers of several devices with one I2C transaction.
+ * @details Every period a single command chain is built from the plan: a
+ *          register pointer write followed by a repeated start and a burst
+ *          read for every burst, so the I2C_Master runs the whole period with
+ *          one driver call. The read bytes are decoded into the channels and
+ *          sent on the channel outputs. Periods where the transaction fails
+ *          send nothing and are counted.
+ */
+template <unsigned Channels>
+class I2C_Poller : public Component {
+public:
+
+	static_assert(Channels >= 1, "I2C_Poller needs at least one channel");
+
+	// Input port index definitions
+	static constexpr unsigned plan     = 0U;
+	static constexpr unsigned interval = 1U;
+
+	// Output port index definitions, channel c is sent on first_channel + c
+	static constexpr unsigned command       = 0U;
+	static constexpr unsigned first_channel = 1U;
+
+	// Default time between two polling periods
+	static constexpr unsigned poll_interval_ms = 100U;
+
+	I2C_Poller() : m_interval(poll_interval_ms), m_wake(0), m_failures(0)
+	{
+		inputs.addPort<I2C_PollPlan<Channels>>(plan, 1);
+		inputs.addPort<unsigned>(interval, 1);
+
+		outputs.addPort<I2C_CommandChain*>(command);
+		for(unsigned c = 0; c < Channels; c++) outputs.addPort<float>(first_channel + c);
+
+		m_plan.bursts = 0;
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the polling plan
+		auto value = inputs[plan].receive<I2C_PollPlan<Channels>>();
+		if(value) set_plan(value.value());
+
+		m_wake = os_tick_count();
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[plan].has_message())
+		{
+			auto value = inputs[plan].receive<I2C_PollPlan<Channels>>();
+			if(value) set_plan(value.value());
+		}
+
+		if(inputs[interval].has_message())
+		{
+			auto value = inputs[interval].receive<unsigned>();
+			if(value) m_interval = value.value() ? value.value() : 1U;
+			m_wake = os_tick_count();
+		}
+
+		poll();
+
+		// Waiting for the next polling period without accumulating drift
+		os_delay_until(&m_wake, m_interval);
+	}
+
+	/**
+	 * @brief Queries the number of failed polling periods.
+	 */
+	uint32_t failures(void) const
+	{
+		return m_failures;
+	}
+
+private:
+
+	void set_plan(const I2C_PollPlan<Channels>& value)
+	{
+		m_plan = value;
+		if(m_plan.bursts > MFLOW_I2C_POLL_MAX_BURSTS) m_plan.bursts = MFLOW_I2C_POLL_MAX_BURSTS;
+
+		// Locating the bursts in the bytes read by the chain
+		unsigned start = 0;
+		for(unsigned b = 0; b < m_plan.bursts; b++)
+		{
+			m_start[b] = start;
+			start     += m_plan.burst[b].length;
+		}
+	}
+
+	void poll(void)
+	{
+		if(m_plan.bursts == 0) return;
+
+		I2C_CommandChain* chain = I2C_CommandPool::shared().acquire();
+		if(chain == nullptr) return;
+
+		// Building one chain reading every burst
+		for(unsigned b = 0; b < m_plan.bursts; b++)
+		{
+			const I2C_PollBurst& burst = m_plan.burst[b];
+
+			chain->queue_start();
+			chain->queue_write_byte((uint8_t) (burst.address << 1) | I2C_MASTER_WRITE);
+			chain->queue_write_byte(burst.reg);
+			chain->queue_start();
+			chain->queue_write_byte((uint8_t) (burst.address << 1) | I2C_MASTER_READ);
+			chain->queue_read(burst.length);
+		}
+
+		chain->queue_stop();
+
+		// Executing the chain on the I2C master
+		bool status = outputs[command].send<I2C_CommandChain*>(chain) == MessageStatus::Okay && chain->wait_for_execute();
+
+		if(status)
+		{
+			// Demultiplexing the bytes into the channels
+			for(unsigned c = 0; c < Channels; c++)
+			{
+				const I2C_PollChannel& channel = m_plan.channel[c];
+				if(channel.burst >= m_plan.bursts) continue;
+
+				const unsigned position = m_start[channel.burst] + channel.offset;
+				if(position + size(channel.format) > chain->read_length()) continue;
+
+				const float value = (float) decode(chain->read_data() + position, channel.format) * channel.scale + channel.bias;
+				outputs[first_channel + c].send<float>(value);
+			}
+		}
+		else
+		{
+			m_failures++;
+		}
+
+		chain->release();
+	}
+
+	static unsigned size(I2C_PollFormat format)
+	{
+		switch(format)
+		{
+			case I2C_PollFormat::U8:     case I2C_PollFormat::S8:     return 1;
+			case I2C_PollFormat::U24_BE: case I2C_PollFormat::S24_BE: return 3;
+			case I2C_PollFormat::U32_BE: case I2C_PollFormat::S32_BE: return 4;
+			default:                                                  return 2;
+		}
+	}
+
+	static int64_t decode(const uint8_t* bytes, I2C_PollFormat format)
+	{
+		switch(format)
+		{
+			case I2C_PollFormat::U8:     return bytes[0];
+			case I2C_PollFormat::S8:     return (int8_t) bytes[0];
+			case I2C_PollFormat::U16_BE: return (uint16_t) ((bytes[0] << 8) | bytes[1]);
+			case I2C_PollFormat::S16_BE: return (int16_t)  ((bytes[0] << 8) | bytes[1]);
+			case I2C_PollFormat::U16_LE: return (uint16_t) ((bytes[1] << 8) | bytes[0]);
+			case I2C_PollFormat::S16_LE: return (int16_t)  ((bytes[1] << 8) | bytes[0]);
+			case I2C_PollFormat::U24_BE: return ((uint32_t) bytes[0] << 16) | ((uint32_t) bytes[1] << 8) | bytes[2];
+			case I2C_PollFormat::S24_BE: return (int32_t) (((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8)) >> 8;
+			case I2C_PollFormat::U32_BE: return ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | bytes[3];
+			case I2C_PollFormat::S32_BE: return (int32_t) (((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) | ((uint32_t) bytes[2] << 8) | bytes[3]);
+		}
+
+		return 0;
+	}
+
+	I2C_PollPlan<Channels> m_plan;
+	unsigned               m_start[MFLOW_I2C_POLL_MAX_BURSTS];
+	unsigned               m_interval;
+	os_tick_t              m_wake;
+	uint32_t               m_failures;
+};
+
+#endif // MFLOW_ESP_IDF_I2C_POLLER_H_INCLUDED
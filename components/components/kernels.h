@@ -0,0 +1,401 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_KERNELS_H_INCLUDED
+#define MFLOW_COMPONENTS_KERNELS_H_INCLUDED
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+
+// Vector instruction set includes
+#if defined(MFLOW_USE_ESP_DSP)
+#include "esp_dsp.h"
+#elif defined(__AVX__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// Project includes
+#include "sample.h"
+
+
+// The kernels below process blocks of samples, the generic templates are
+// portable scalar implementations built on the sample traits. Overloads
+// for float and q15 samples use the vector instructions of the target:
+// AVX, SSE2 or NEON on hosts, and the ESP-DSP library on the ESP32 when
+// MFLOW_USE_ESP_DSP is defined (this requires the esp-dsp component).
+// The pointers do not have to be aligned, input and output may alias.
+
+/**
+ * @brief Elementwise sum of two blocks (out = a + b).
+ * @param a      [in]  Pointer to the first input block.
+ * @param b      [in]  Pointer to the second input block.
+ * @param out    [out] Pointer to the output block.
+ * @param length [in]  The number of samples in the blocks.
+ */
+template <class Sample>
+inline void vector_add(const Sample* a, const Sample* b, Sample* out, std::size_t length)
+{
+	for(std::size_t i = 0; i < length; i++) out[i] = sample_traits<Sample>::add(a[i], b[i]);
+}
+
+/**
+ * @brief Elementwise difference of two blocks (out = a - b).
+ * @param a      [in]  Pointer to the first input block.
+ * @param b      [in]  Pointer to the second input block.
+ * @param out    [out] Pointer to the output block.
+ * @param length [in]  The number of samples in the blocks.
+ */
+template <class Sample>
+inline void vector_sub(const Sample* a, const Sample* b, Sample* out, std::size_t length)
+{
+	for(std::size_t i = 0; i < length; i++) out[i] = sample_traits<Sample>::sub(a[i], b[i]);
+}
+
+/**
+ * @brief Elementwise product of two blocks (out = a * b).
+ * @param a      [in]  Pointer to the first input block.
+ * @param b      [in]  Pointer to the second input block.
+ * @param out    [out] Pointer to the output block.
+ * @param length [in]  The number of samples in the blocks.
+ */
+template <class Sample>
+inline void vector_mul(const Sample* a, const Sample* b, Sample* out, std::size_t length)
+{
+	for(std::size_t i = 0; i < length; i++) out[i] = sample_traits<Sample>::mul(a[i], b[i]);
+}
+
+/**
+ * @brief Multiplies a block with a constant gain (out = a * gain).
+ * @param a      [in]  Pointer to the input block.
+ * @param gain   [in]  The gain to apply.
+ * @param out    [out] Pointer to the output block.
+ * @param length [in]  The number of samples in the blocks.
+ */
+template <class Sample>
+inline void vector_scale(const Sample* a, float gain, Sample* out, std::size_t length)
+{
+	for(std::size_t i = 0; i < length; i++) out[i] = sample_traits<Sample>::scale(a[i], gain);
+}
+
+/**
+ * @brief Accumulates a block multiplied with a constant gain (out += a * gain).
+ * @param a      [in]     Pointer to the input block.
+ * @param gain   [in]     The gain to apply.
+ * @param out    [in,out] Pointer to the accumulating block.
+ * @param length [in]     The number of samples in the blocks.
+ */
+template <class Sample>
+inline void vector_mac(const Sample* a, float gain, Sample* out, std::size_t length)
+{
+	for(std::size_t i = 0; i < length; i++) out[i] = sample_traits<Sample>::add(out[i], sample_traits<Sample>::scale(a[i], gain));
+}
+
+/**
+ * @brief  Inner product of two blocks.
+ * @param  a      [in] Pointer to the first input block.
+ * @param  b      [in] Pointer to the second input block.
+ * @param  length [in] The number of samples in the blocks.
+ * @retval The sum of the elementwise products, saturated to the sample range.
+ */
+template <class Sample>
+inline Sample vector_dot(const Sample* a, const Sample* b, std::size_t length)
+{
+	float sum = 0.0f;
+	for(std::size_t i = 0; i < length; i++) sum += sample_traits<Sample>::to_float(a[i]) * sample_traits<Sample>::to_float(b[i]);
+	return sample_traits<Sample>::from_float(sum);
+}
+
+inline double vector_dot(const double* a, const double* b, std::size_t length)
+{
+	// Accumulating in double precision
+	double sum = 0.0;
+	for(std::size_t i = 0; i < length; i++) sum += a[i] * b[i];
+	return sum;
+}
+
+inline q15 vector_dot(const q15* a, const q15* b, std::size_t length)
+{
+	// Accumulating the Q30 products without intermediate rounding
+	int64_t sum = 0;
+	for(std::size_t i = 0; i < length; i++) sum += (int32_t) a[i].raw * b[i].raw;
+
+	sum = (sum + (1L << 14)) >> 15;
+	return q15{(int16_t) (sum > INT16_MAX ? INT16_MAX : sum < INT16_MIN ? INT16_MIN : sum)};
+}
+
+#if defined(MFLOW_USE_ESP_DSP)
+
+inline void vector_add(const float* a, const float* b, float* out, std::size_t length)
+{
+	dsps_add_f32(a, b, out, (int) length, 1, 1, 1);
+}
+
+inline void vector_sub(const float* a, const float* b, float* out, std::size_t length)
+{
+	dsps_sub_f32(a, b, out, (int) length, 1, 1, 1);
+}
+
+inline void vector_mul(const float* a, const float* b, float* out, std::size_t length)
+{
+	dsps_mul_f32(a, b, out, (int) length, 1, 1, 1);
+}
+
+inline void vector_scale(const float* a, float gain, float* out, std::size_t length)
+{
+	dsps_mulc_f32(a, out, (int) length, gain, 1, 1);
+}
+
+inline void vector_mac(const float* a, float gain, float* out, std::size_t length)
+{
+	// The multiply-add instruction of the FPU is used by the compiler for this loop
+	for(std::size_t i = 0; i < length; i++) out[i] += a[i] * gain;
+}
+
+inline float vector_dot(const float* a, const float* b, std::size_t length)
+{
+	float sum;
+	dsps_dotprod_f32(a, b, &sum, (int) length);
+	return sum;
+}
+
+#elif defined(__AVX__) || defined(__SSE2__)
+
+#if defined(__AVX__)
+#define MFLOW_KERNEL_WIDTH        (8U)
+#define MFLOW_KERNEL_FLOAT        __m256
+#define MFLOW_KERNEL_LOAD(p)      _mm256_loadu_ps(p)
+#define MFLOW_KERNEL_STORE(p, v)  _mm256_storeu_ps(p, v)
+#define MFLOW_KERNEL_SET(x)       _mm256_set1_ps(x)
+#define MFLOW_KERNEL_ADD(a, b)    _mm256_add_ps(a, b)
+#define MFLOW_KERNEL_SUB(a, b)    _mm256_sub_ps(a, b)
+#define MFLOW_KERNEL_MUL(a, b)    _mm256_mul_ps(a, b)
+#else
+#define MFLOW_KERNEL_WIDTH        (4U)
+#define MFLOW_KERNEL_FLOAT        __m128
+#define MFLOW_KERNEL_LOAD(p)      _mm_loadu_ps(p)
+#define MFLOW_KERNEL_STORE(p, v)  _mm_storeu_ps(p, v)
+#define MFLOW_KERNEL_SET(x)       _mm_set1_ps(x)
+#define MFLOW_KERNEL_ADD(a, b)    _mm_add_ps(a, b)
+#define MFLOW_KERNEL_SUB(a, b)    _mm_sub_ps(a, b)
+#define MFLOW_KERNEL_MUL(a, b)    _mm_mul_ps(a, b)
+#endif
+
+inline void vector_add(const float* a, const float* b, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % MFLOW_KERNEL_WIDTH;
+	std::size_t       i    = 0;
+	for(; i < body; i += MFLOW_KERNEL_WIDTH)
+	{
+		MFLOW_KERNEL_STORE(out + i, MFLOW_KERNEL_ADD(MFLOW_KERNEL_LOAD(a + i), MFLOW_KERNEL_LOAD(b + i)));
+	}
+	for(; i < length; i++) out[i] = a[i] + b[i];
+}
+
+inline void vector_sub(const float* a, const float* b, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % MFLOW_KERNEL_WIDTH;
+	std::size_t       i    = 0;
+	for(; i < body; i += MFLOW_KERNEL_WIDTH)
+	{
+		MFLOW_KERNEL_STORE(out + i, MFLOW_KERNEL_SUB(MFLOW_KERNEL_LOAD(a + i), MFLOW_KERNEL_LOAD(b + i)));
+	}
+	for(; i < length; i++) out[i] = a[i] - b[i];
+}
+
+inline void vector_mul(const float* a, const float* b, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % MFLOW_KERNEL_WIDTH;
+	std::size_t       i    = 0;
+	for(; i < body; i += MFLOW_KERNEL_WIDTH)
+	{
+		MFLOW_KERNEL_STORE(out + i, MFLOW_KERNEL_MUL(MFLOW_KERNEL_LOAD(a + i), MFLOW_KERNEL_LOAD(b + i)));
+	}
+	for(; i < length; i++) out[i] = a[i] * b[i];
+}
+
+inline void vector_scale(const float* a, float gain, float* out, std::size_t length)
+{
+	const MFLOW_KERNEL_FLOAT g = MFLOW_KERNEL_SET(gain);
+
+	const std::size_t body = length - length % MFLOW_KERNEL_WIDTH;
+	std::size_t       i    = 0;
+	for(; i < body; i += MFLOW_KERNEL_WIDTH)
+	{
+		MFLOW_KERNEL_STORE(out + i, MFLOW_KERNEL_MUL(MFLOW_KERNEL_LOAD(a + i), g));
+	}
+	for(; i < length; i++) out[i] = a[i] * gain;
+}
+
+inline void vector_mac(const float* a, float gain, float* out, std::size_t length)
+{
+	const MFLOW_KERNEL_FLOAT g = MFLOW_KERNEL_SET(gain);
+
+	const std::size_t body = length - length % MFLOW_KERNEL_WIDTH;
+	std::size_t       i    = 0;
+	for(; i < body; i += MFLOW_KERNEL_WIDTH)
+	{
+		MFLOW_KERNEL_STORE(out + i, MFLOW_KERNEL_ADD(MFLOW_KERNEL_LOAD(out + i), MFLOW_KERNEL_MUL(MFLOW_KERNEL_LOAD(a + i), g)));
+	}
+	for(; i < length; i++) out[i] += a[i] * gain;
+}
+
+inline float vector_dot(const float* a, const float* b, std::size_t length)
+{
+	MFLOW_KERNEL_FLOAT acc = MFLOW_KERNEL_SET(0.0f);
+
+	const std::size_t body = length - length % MFLOW_KERNEL_WIDTH;
+	std::size_t       i    = 0;
+	for(; i < body; i += MFLOW_KERNEL_WIDTH)
+	{
+		acc = MFLOW_KERNEL_ADD(acc, MFLOW_KERNEL_MUL(MFLOW_KERNEL_LOAD(a + i), MFLOW_KERNEL_LOAD(b + i)));
+	}
+
+	// Reducing the vector accumulator to a single value
+	float lanes[MFLOW_KERNEL_WIDTH];
+	MFLOW_KERNEL_STORE(lanes, acc);
+
+	float sum = 0.0f;
+	for(std::size_t lane = 0; lane < MFLOW_KERNEL_WIDTH; lane++) sum += lanes[lane];
+	for(; i < length; i++) sum += a[i] * b[i];
+
+	return sum;
+}
+
+#undef MFLOW_KERNEL_WIDTH
+#undef MFLOW_KERNEL_FLOAT
+#undef MFLOW_KERNEL_LOAD
+#undef MFLOW_KERNEL_STORE
+#undef MFLOW_KERNEL_SET
+#undef MFLOW_KERNEL_ADD
+#undef MFLOW_KERNEL_SUB
+#undef MFLOW_KERNEL_MUL
+
+inline void vector_add(const q15* a, const q15* b, q15* out, std::size_t length)
+{
+	const std::size_t body = length - length % 8;
+	std::size_t       i    = 0;
+	for(; i < body; i += 8)
+	{
+		const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_adds_epi16(va, vb));
+	}
+	for(; i < length; i++) out[i] = sample_traits<q15>::add(a[i], b[i]);
+}
+
+inline void vector_sub(const q15* a, const q15* b, q15* out, std::size_t length)
+{
+	const std::size_t body = length - length % 8;
+	std::size_t       i    = 0;
+	for(; i < body; i += 8)
+	{
+		const __m128i va = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+		const __m128i vb = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_subs_epi16(va, vb));
+	}
+	for(; i < length; i++) out[i] = sample_traits<q15>::sub(a[i], b[i]);
+}
+
+#elif defined(__ARM_NEON)
+
+inline void vector_add(const float* a, const float* b, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % 4;
+	std::size_t       i    = 0;
+	for(; i < body; i += 4) vst1q_f32(out + i, vaddq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+	for(; i < length; i++) out[i] = a[i] + b[i];
+}
+
+inline void vector_sub(const float* a, const float* b, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % 4;
+	std::size_t       i    = 0;
+	for(; i < body; i += 4) vst1q_f32(out + i, vsubq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+	for(; i < length; i++) out[i] = a[i] - b[i];
+}
+
+inline void vector_mul(const float* a, const float* b, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % 4;
+	std::size_t       i    = 0;
+	for(; i < body; i += 4) vst1q_f32(out + i, vmulq_f32(vld1q_f32(a + i), vld1q_f32(b + i)));
+	for(; i < length; i++) out[i] = a[i] * b[i];
+}
+
+inline void vector_scale(const float* a, float gain, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % 4;
+	std::size_t       i    = 0;
+	for(; i < body; i += 4) vst1q_f32(out + i, vmulq_n_f32(vld1q_f32(a + i), gain));
+	for(; i < length; i++) out[i] = a[i] * gain;
+}
+
+inline void vector_mac(const float* a, float gain, float* out, std::size_t length)
+{
+	const std::size_t body = length - length % 4;
+	std::size_t       i    = 0;
+	for(; i < body; i += 4) vst1q_f32(out + i, vmlaq_n_f32(vld1q_f32(out + i), vld1q_f32(a + i), gain));
+	for(; i < length; i++) out[i] += a[i] * gain;
+}
+
+inline float vector_dot(const float* a, const float* b, std::size_t length)
+{
+	float32x4_t acc = vdupq_n_f32(0.0f);
+
+	const std::size_t body = length - length % 4;
+	std::size_t       i    = 0;
+	for(; i < body; i += 4) acc = vmlaq_f32(acc, vld1q_f32(a + i), vld1q_f32(b + i));
+
+	// Reducing the vector accumulator to a single value
+	float sum = vgetq_lane_f32(acc, 0) + vgetq_lane_f32(acc, 1) + vgetq_lane_f32(acc, 2) + vgetq_lane_f32(acc, 3);
+	for(; i < length; i++) sum += a[i] * b[i];
+
+	return sum;
+}
+
+inline void vector_add(const q15* a, const q15* b, q15* out, std::size_t length)
+{
+	const std::size_t body = length - length % 8;
+	std::size_t       i    = 0;
+	for(; i < body; i += 8)
+	{
+		const int16x8_t va = vld1q_s16(reinterpret_cast<const int16_t*>(a + i));
+		const int16x8_t vb = vld1q_s16(reinterpret_cast<const int16_t*>(b + i));
+		vst1q_s16(reinterpret_cast<int16_t*>(out + i), vqaddq_s16(va, vb));
+	}
+	for(; i < length; i++) out[i] = sample_traits<q15>::add(a[i], b[i]);
+}
+
+inline void vector_sub(const q15* a, const q15* b, q15* out, std::size_t length)
+{
+	const std::size_t body = length - length % 8;
+	std::size_t       i    = 0;
+	for(; i < body; i += 8)
+	{
+		const int16x8_t va = vld1q_s16(reinterpret_cast<const int16_t*>(a + i));
+		const int16x8_t vb = vld1q_s16(reinterpret_cast<const int16_t*>(b + i));
+		vst1q_s16(reinterpret_cast<int16_t*>(out + i), vqsubq_s16(va, vb));
+	}
+	for(; i < length; i++) out[i] = sample_traits<q15>::sub(a[i], b[i]);
+}
+
+inline void vector_mul(const q15* a, const q15* b, q15* out, std::size_t length)
+{
+	const std::size_t body = length - length % 8;
+	std::size_t       i    = 0;
+	for(; i < body; i += 8)
+	{
+		// Saturating, rounding Q15 multiplication
+		const int16x8_t va = vld1q_s16(reinterpret_cast<const int16_t*>(a + i));
+		const int16x8_t vb = vld1q_s16(reinterpret_cast<const int16_t*>(b + i));
+		vst1q_s16(reinterpret_cast<int16_t*>(out + i), vqrdmulhq_s16(va, vb));
+	}
+	for(; i < length; i++) out[i] = sample_traits<q15>::mul(a[i], b[i]);
+}
+
+#endif
+
+#endif // MFLOW_COMPONENTS_KERNELS_H_INCLUDED
@@ -0,0 +1,299 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_MEDIAN_H_INCLUDED
+#define MFLOW_COMPONENTS_MEDIAN_H_INCLUDED
+
+// Standard includes
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "sample.h"
+
+
+// Maximum window width of the median filters
+#ifndef MFLOW_MEDIAN_MAX_WINDOW
+#define MFLOW_MEDIAN_MAX_WINDOW (4096)
+#endif
+
+/**
+ * @brief   Median of a sliding window with O(log N) update.
+ * @details The window is split into two indexed binary heaps: a max-heap
+ *          holding the lower half and a min-heap holding the upper half of
+ *          the samples, so the median is at the top of the heaps. Every
+ *          window slot records the heap and position of its sample. When
+ *          the window is full, the new sample replaces the oldest one in
+ *          its slot and is sifted within the same heap, followed by at most
+ *          one exchange of the heap tops. The heaps therefore never change
+ *          size and no memory is allocated after the window is configured.
+ */
+template <class Sample>
+class SlidingMedian {
+public:
+
+	SlidingMedian(void)
+		: m_values(nullptr), m_heap(nullptr), m_position(nullptr), m_low(nullptr), m_high(nullptr),
+		  m_window(0), m_count(0), m_oldest(0), m_low_size(0), m_high_size(0)
+	{ }
+
+	~SlidingMedian()
+	{
+		release();
+	}
+
+	/**
+	 * @brief Resizes the window and discards its contents.
+	 * @param window [in] The number of samples in the window.
+	 */
+	void reset(unsigned window)
+	{
+		window = window == 0 ? 1U : window > MFLOW_MEDIAN_MAX_WINDOW ? MFLOW_MEDIAN_MAX_WINDOW : window;
+
+		if(window != m_window)
+		{
+			release();
+
+			m_values   = new Sample[window];
+			m_heap     = new uint8_t[window];
+			m_position = new uint16_t[window];
+			m_low      = new uint16_t[(window + 1) / 2];
+			m_high     = new uint16_t[window / 2 + 1];
+			m_window   = window;
+		}
+
+		m_count     = 0;
+		m_oldest    = 0;
+		m_low_size  = 0;
+		m_high_size = 0;
+	}
+
+	/**
+	 * @brief Pushes a new sample into the window, replacing the oldest one when full.
+	 * @param sample [in] The sample to push.
+	 */
+	void push(const Sample& sample)
+	{
+		if(m_count < m_window)
+		{
+			// Filling the window, the lower half gets the extra sample
+			const uint16_t slot = (uint16_t) m_count++;
+			m_values[slot] = sample;
+
+			if(m_low_size <= m_high_size)
+			{
+				m_heap[slot] = low;
+				place(low, m_low_size++, slot);
+				sift_up(low, m_low_size - 1);
+			}
+			else
+			{
+				m_heap[slot] = high;
+				place(high, m_high_size++, slot);
+				sift_up(high, m_high_size - 1);
+			}
+		}
+		else
+		{
+			// Replacing the oldest sample in its slot
+			const uint16_t slot = (uint16_t) m_oldest;
+			if(++m_oldest == m_window) m_oldest = 0;
+
+			m_values[slot] = sample;
+			sift_up(m_heap[slot], m_position[slot]);
+			sift_down(m_heap[slot], m_position[slot]);
+		}
+
+		// Exchanging the tops when the new sample crossed the median
+		if(m_high_size > 0 && less(m_values[m_high[0]], m_values[m_low[0]]))
+		{
+			const uint16_t low_top  = m_low[0];
+			const uint16_t high_top = m_high[0];
+
+			m_heap[low_top]  = high;
+			m_heap[high_top] = low;
+			place(low,  0, high_top);
+			place(high, 0, low_top);
+
+			sift_down(low,  0);
+			sift_down(high, 0);
+		}
+	}
+
+	/**
+	 * @brief  Queries the median of the samples in the window.
+	 * @retval The middle sample, or the mean of the two middle samples for even counts.
+	 */
+	Sample median(void) const
+	{
+		if(m_count == 0) return sample_traits<Sample>::zero();
+		if(m_count % 2 == 1) return m_values[m_low[0]];
+
+		return sample_traits<Sample>::average(sample_traits<Sample>::widen(m_values[m_low[0]]) +
+		                                      sample_traits<Sample>::widen(m_values[m_high[0]]), 2);
+	}
+
+private:
+
+	static constexpr uint8_t low  = 0U; /**< Max-heap of the lower half.  */
+	static constexpr uint8_t high = 1U; /**< Min-heap of the upper half.  */
+
+	static bool less(const Sample& a, const Sample& b)
+	{
+		return sample_traits<Sample>::widen(a) < sample_traits<Sample>::widen(b);
+	}
+
+	// Checks whether the entry at position a should be above the one at b
+	bool above(uint8_t heap, unsigned a, unsigned b) const
+	{
+		const uint16_t* entries = heap == low ? m_low : m_high;
+		return heap == low ? less(m_values[entries[b]], m_values[entries[a]])
+		                   : less(m_values[entries[a]], m_values[entries[b]]);
+	}
+
+	void place(uint8_t heap, unsigned position, uint16_t slot)
+	{
+		(heap == low ? m_low : m_high)[position] = slot;
+		m_position[slot] = (uint16_t) position;
+	}
+
+	void exchange(uint8_t heap, unsigned a, unsigned b)
+	{
+		uint16_t*      entries = heap == low ? m_low : m_high;
+		const uint16_t slot    = entries[a];
+
+		place(heap, a, entries[b]);
+		place(heap, b, slot);
+	}
+
+	void sift_up(uint8_t heap, unsigned position)
+	{
+		while(position > 0)
+		{
+			const unsigned parent = (position - 1) / 2;
+			if(!above(heap, position, parent)) break;
+
+			exchange(heap, position, parent);
+			position = parent;
+		}
+	}
+
+	void sift_down(uint8_t heap, unsigned position)
+	{
+		const unsigned size = heap == low ? m_low_size : m_high_size;
+
+		while(true)
+		{
+			unsigned top   = position;
+			unsigned left  = 2 * position + 1;
+			unsigned right = left + 1;
+
+			if(left  < size && above(heap, left,  top)) top = left;
+			if(right < size && above(heap, right, top)) top = right;
+			if(top == position) break;
+
+			exchange(heap, position, top);
+			position = top;
+		}
+	}
+
+	void release(void)
+	{
+		delete[] m_values;
+		delete[] m_heap;
+		delete[] m_position;
+		delete[] m_low;
+		delete[] m_high;
+	}
+
+	Sample*   m_values;    /**< The samples of the window slots.             */
+	uint8_t*  m_heap;      /**< The heap containing each window slot.        */
+	uint16_t* m_position;  /**< The position of each window slot in its heap. */
+	uint16_t* m_low;       /**< The slots in the lower half max-heap.        */
+	uint16_t* m_high;      /**< The slots in the upper half min-heap.        */
+	unsigned  m_window;    /**< The number of slots in the window.           */
+	unsigned  m_count;     /**< The number of filled slots.                  */
+	unsigned  m_oldest;    /**< The slot of the oldest sample.               */
+	unsigned  m_low_size;  /**< The number of entries in the lower heap.     */
+	unsigned  m_high_size; /**< The number of entries in the upper heap.     */
+};
+
+/**
+ * @brief   Sliding-window median filter component for despiking.
+ * @details Accepts individual samples and frames, and emits the median of
+ *          the window on the matching output for every input sample. The
+ *          window width is read from an option port, like the width of the
+ *          MovingAverage component.
+ */
+template <class Sample>
+class BasicMedianFilter : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in        = 0U;
+	static constexpr unsigned width     = 1U;
+	static constexpr unsigned frame_in  = 2U;
+	static constexpr unsigned out       = 0U;
+	static constexpr unsigned frame_out = 1U;
+
+	BasicMedianFilter()
+	{
+		inputs.addPort<Sample>(in, 1);
+		inputs.addPort<unsigned>(width, 1);
+		inputs.addPort<Frame<Sample>>(frame_in, 1);
+		outputs.addPort<Sample>(out);
+		outputs.addPort<Frame<Sample>>(frame_out);
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading window width
+		auto value = inputs[width].receive<unsigned>();
+		m_median.reset(value ? value.value() : 1U);
+	}
+
+	virtual void process(void) override
+	{
+		// Checking if window width changed
+		if(inputs[width].has_message())
+		{
+			auto value = inputs[width].receive<unsigned>();
+			if(value) m_median.reset(value.value());
+		}
+
+		// Waiting for samples or frames
+		auto index = await({in, frame_in});
+		if(!index) return;
+
+		if(index.value() == in)
+		{
+			auto value = inputs[in].receive<Sample>();
+			if(!value) return;
+
+			m_median.push(value.value());
+			outputs[out].send<Sample>(m_median.median());
+		}
+		else
+		{
+			auto frame = inputs[frame_in].receive<Frame<Sample>>();
+			if(!frame) return;
+
+			Frame<Sample> output;
+			output.sequence = frame.value().sequence;
+
+			for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+			{
+				m_median.push(frame.value()[i]);
+				output[i] = m_median.median();
+			}
+
+			outputs[frame_out].send<Frame<Sample>>(output);
+		}
+	}
+
+private:
+	SlidingMedian<Sample> m_median;
+};
+
+typedef BasicMedianFilter<double> MedianFilter;
+
+#endif // MFLOW_COMPONENTS_MEDIAN_H_INCLUDED
@@ -1,8 +1,10 @@
 #pragma once
 #include "component.h"
+#include "sample.h"
 
 
-class MovingAverage : public Component {
+template <class Sample>
+class BasicMovingAverage : public Component {
 public:
 
 	// Port index definitions
@@ -10,11 +12,11 @@ public:
 	static constexpr unsigned width = 1U;
 	static constexpr unsigned out   = 0U;
 
-	MovingAverage() : m_previous_values(nullptr), m_width(0)
+	BasicMovingAverage() : m_previous_values(nullptr), m_width(0)
 	{
-		inputs.addPort<double>(in, 1);
+		inputs.addPort<Sample>(in, 1);
 		inputs.addPort<unsigned>(width, 1);
-		outputs.addPort<double>(out);
+		outputs.addPort<Sample>(out);
 	}
 
 	// Component initialization
@@ -24,10 +26,10 @@ public:
 		m_width = inputs[width].receive<unsigned>();
 
 		// Creating array for previous values
-		m_previous_values = new double[m_width];
+		m_previous_values = new Sample[m_width];
 
 		// Clearing array of previous values
-		for(int i = 0; i < m_width; i++) m_previous_values[i] = 0.0f;
+		for(unsigned i = 0; i < m_width; i++) m_previous_values[i] = sample_traits<Sample>::zero();
 	}
 
 	// Component behaviour
@@ -40,49 +42,51 @@ public:
 			m_width = inputs[width].receive<unsigned>();
 
 			// Deleting current buffer
-			delete m_previous_values;
+			delete[] m_previous_values;
 
 			// Allocating new buffer
-			m_previous_values = new double[m_width];
+			m_previous_values = new Sample[m_width];
 
 			// Initializing buffer
-			for(int i = 0; i < m_width; i++)
+			for(unsigned i = 0; i < m_width; i++)
 			{
-				m_previous_values[i] = 0.0f;
+				m_previous_values[i] = sample_traits<Sample>::zero();
 			}
 		}
 
 		// Reading input
-		auto input = inputs[in].receive<double>();
+		auto input = inputs[in].receive<Sample>();
 
 		// Checking input
 		if(!input) return;
 
 		// Initialize sum of elements
-		double sum = 0.0f;
+		typename sample_traits<Sample>::accumulator sum = 0;
 
 		// Shifting previous values array
-		for(int i = 0; i < m_width - 1; i++)
+		for(unsigned i = 0; i + 1 < m_width; i++)
 		{
 			m_previous_values[i] = m_previous_values[i + 1];
 		}
 
 		// Appending latest value
-		m_previous_values[m_width - 1] = input;
+		m_previous_values[m_width - 1] = input.value();
 
-		for(int i = 0; i < m_width; i++)
+		for(unsigned i = 0; i < m_width; i++)
 		{
-			sum += m_previous_values[i];
+			sum += sample_traits<Sample>::widen(m_previous_values[i]);
 		}
 
 		// Calculating average
-		double output = sum / m_width;
+		Sample output = sample_traits<Sample>::average(sum, m_width);
 
 		// Sending output message
-		outputs[out].send<double>(output);
+		outputs[out].send<Sample>(output);
 	}
 
 private:
-	double*  m_previous_values;
+	Sample*  m_previous_values;
 	unsigned m_width;
 };
+
+typedef BasicMovingAverage<double> MovingAverage;
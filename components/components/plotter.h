@@ -1,23 +1,234 @@
 #pragma once
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
 #include "component.h"
+#include "frame.h"
+#include "os.h"
+#include "ring_buffer.hpp"
+#include "sample.h"
 
-class Plotter : public Component
+/**
+ * @brief   Sink component printing the received samples to the console.
+ * @details Samples are formatted into a ring buffer on the component task
+ *          and written to the console in large chunks by a low-priority
+ *          writer task, so console throughput never stalls the signal
+ *          chain. When the ring buffer is full, records are dropped and
+ *          counted instead of blocking. The output can be decimated to
+ *          one record per column of samples, optionally recording the
+ *          min/max envelope of the column, and it can be switched to raw
+ *          binary samples instead of text lines.
+ */
+template <class Sample>
+class BasicPlotter : public Component
 {
 public:
 
-	static constexpr unsigned in = 1U;
+	// Port index definitions
+	static constexpr unsigned in         = 1U;
+	static constexpr unsigned frame_in   = 2U;
+	static constexpr unsigned binary     = 3U;
+	static constexpr unsigned decimation = 4U;
+	static constexpr unsigned envelope   = 5U;
 
-	Plotter()
+	// Writer configuration
+	static constexpr std::size_t buffer_size       = 4096U;
+	static constexpr unsigned    flush_interval_ms = 50U;
+	static constexpr unsigned    writer_priority   = 1U;
+	static constexpr uint32_t    flush_request     = 0x00000001U;
+
+	BasicPlotter()
+		: m_buffer(buffer_size),
+		  m_writer(nullptr),
+		  m_writer_should_run(false),
+		  m_writer_is_running(false),
+		  m_binary(false),
+		  m_envelope(false),
+		  m_decimation(1),
+		  m_count(0),
+		  m_min(sample_traits<Sample>::zero()),
+		  m_max(sample_traits<Sample>::zero()),
+		  m_dropped(0)
 	{
-		inputs.addPort<double>(in, 1);
+		inputs.addPort<Sample>(in, 1);
+		inputs.addPort<Frame<Sample>>(frame_in, 1);
+		inputs.addPort<bool>(binary, 1);
+		inputs.addPort<unsigned>(decimation, 1);
+		inputs.addPort<bool>(envelope, 1);
 	}
 
 	virtual void initialize(void) override {
 
+		// Starting the writer task below the priority of the components
+		m_writer_should_run = true;
+		m_writer_is_running = true;
+		m_writer = os_thread_create(BasicPlotter::run_writer, (void*) this, "", 3000, writer_priority);
 	}
 
 	virtual void process(void) override {
-		auto value = inputs[in].receive<double>();
-		if(value) printf("%lf\n", (double) value);
+
+		// Applying configuration changes
+		if(inputs[binary].has_message())
+		{
+			auto value = inputs[binary].receive<bool>();
+			if(value) m_binary = value.value();
+		}
+
+		if(inputs[decimation].has_message())
+		{
+			auto value = inputs[decimation].receive<unsigned>();
+			if(value) m_decimation = value.value() ? value.value() : 1U;
+			m_count = 0;
+		}
+
+		if(inputs[envelope].has_message())
+		{
+			auto value = inputs[envelope].receive<bool>();
+			if(value) m_envelope = value.value();
+			m_count = 0;
+		}
+
+		// Waiting for samples or frames to plot
+		auto index = await({in, frame_in});
+		if(!index) return;
+
+		if(index.value() == in)
+		{
+			auto value = inputs[in].receive<Sample>();
+			if(value) plot(value.value());
+		}
+		else
+		{
+			auto frame = inputs[frame_in].receive<Frame<Sample>>();
+			if(frame)
+			{
+				for(std::size_t i = 0; i < Frame<Sample>::length; i++) plot(frame.value()[i]);
+			}
+		}
+	}
+
+	virtual void finalize(void) override {
+
+		// Stopping the writer, it flushes the remaining records before exiting
+		m_writer_should_run = false;
+		os_thread_notify(m_writer, flush_request);
+
+		while(m_writer_is_running) os_delay(1);
+
+		os_thread_release(m_writer);
+		m_writer = nullptr;
+
+		if(m_dropped) MFLOW_LOGW("", "Plotter dropped %u records.", m_dropped);
+	}
+
+private:
+
+	void plot(const Sample& sample) {
+
+		// Tracking the envelope of the current column
+		if(m_count == 0 || less(sample, m_min)) m_min = sample;
+		if(m_count == 0 || less(m_max, sample)) m_max = sample;
+
+		// Emitting one record per column
+		if(++m_count < m_decimation) return;
+		m_count = 0;
+
+		char        record[2 * field_size + 2];
+		std::size_t length = 0;
+
+		if(m_binary)
+		{
+			std::memcpy(record, m_envelope ? &m_min : &sample, sizeof(Sample));
+			length = sizeof(Sample);
+
+			if(m_envelope)
+			{
+				std::memcpy(record + length, &m_max, sizeof(Sample));
+				length += sizeof(Sample);
+			}
+		}
+		else if(m_envelope)
+		{
+			length  = format(record, m_min);
+			record[length++] = ' ';
+			length += format(record + length, m_max);
+			record[length++] = '\n';
+		}
+		else
+		{
+			length  = format(record, sample);
+			record[length++] = '\n';
+		}
+
+		// Queueing the record, dropping it instead of blocking when the buffer is full
+		if(!m_buffer.write(record, length))
+		{
+			m_dropped++;
+		}
+		else if(m_buffer.read_available() >= m_buffer.capacity() / 2)
+		{
+			os_thread_notify(m_writer, flush_request);
+		}
+	}
+
+	void flush(void) {
+		std::size_t    length;
+		const uint8_t* chunk;
+
+		// Writing the buffered records in contiguous chunks
+		while((chunk = m_buffer.peek(length)), length > 0)
+		{
+			fwrite(chunk, 1, length, stdout);
+			m_buffer.consume(length);
+		}
+
+		fflush(stdout);
 	}
+
+	static void run_writer(void* p_plotter) {
+		BasicPlotter* plotter = static_cast<BasicPlotter*>(p_plotter);
+
+		// Flushing periodically, or earlier when the buffer fills up
+		while(plotter->m_writer_should_run)
+		{
+			os_thread_wait(0x00000000, flush_request, nullptr, flush_interval_ms);
+			plotter->flush();
+		}
+
+		plotter->flush();
+		plotter->m_writer_is_running = false;
+
+		os_thread_exit();
+	}
+
+	static bool less(const Sample& a, const Sample& b) {
+		return sample_traits<Sample>::widen(a) < sample_traits<Sample>::widen(b);
+	}
+
+	// Maximum number of characters of a formatted value
+	static constexpr std::size_t field_size = 40U;
+
+	// Text formatting of the supported sample types, the fixed-point ones are printed raw
+	static std::size_t format(char* buffer, double value) { return clamp(snprintf(buffer, field_size + 1, "%lf", value)); }
+	static std::size_t format(char* buffer, float value)  { return clamp(snprintf(buffer, field_size + 1, "%f", (double) value)); }
+	static std::size_t format(char* buffer, q15 value)    { return clamp(snprintf(buffer, field_size + 1, "%d", (int) value.raw)); }
+	static std::size_t format(char* buffer, q31 value)    { return clamp(snprintf(buffer, field_size + 1, "%" PRId32, value.raw)); }
+
+	static std::size_t clamp(int length) {
+		return length < 0 ? 0 : (std::size_t) length < field_size ? (std::size_t) length : field_size;
+	}
+
+	RingBuffer    m_buffer;
+	os_thread_t   m_writer;
+	volatile bool m_writer_should_run;
+	volatile bool m_writer_is_running;
+	bool          m_binary;
+	bool          m_envelope;
+	unsigned      m_decimation;
+	unsigned      m_count;
+	Sample        m_min;
+	Sample        m_max;
+	unsigned      m_dropped;
 };
+
+typedef BasicPlotter<double> Plotter;
@@ -1,58 +1,156 @@
 #pragma once
+#ifndef MFLOW_COMPONENTS_RECT_WAVE_H_INCLUDED
+#define MFLOW_COMPONENTS_RECT_WAVE_H_INCLUDED
+
+// Standard includes
+#include <algorithm>
+#include <cstdint>
+
+// Project includes
 #include "component.h"
+#include "frame.h"
+#include "os.h"
+#include "sample.h"
 
 
-class RectifiedWave : public Component {
+/**
+ * @brief   Rectangular wave generator producing samples of the specified type.
+ * @details The wave is high for the first duty percent of every period. The
+ *          high sample count is recomputed in integers only when the period
+ *          or the duty cycle changes, and a whole frame is generated per call
+ *          by filling the runs of constant level. The frame and the individual
+ *          samples are sent to the connected outputs.
+ *
+ *          The generator paces itself with a fixed interval per sample by
+ *          default, and the clk port is not read. When the interval is set
+ *          to zero, one frame of Frame::length samples is generated for
+ *          every message arriving on the clk port, so an external timer can
+ *          drive it.
+ */
+template <class Sample>
+class BasicRectifiedWave : public Component {
 public:
 
 	// Port index definitions
-	static constexpr unsigned period = 0U;
-	static constexpr unsigned duty   = 1U;
-	static constexpr unsigned clk    = 2U;
-	static constexpr unsigned out    = 0U;
+	static constexpr unsigned period    = 0U;
+	static constexpr unsigned duty      = 1U;
+	static constexpr unsigned clk       = 2U;
+	static constexpr unsigned interval  = 3U;
+	static constexpr unsigned out       = 0U;
+	static constexpr unsigned frame_out = 1U;
+
+	// Default time between two consecutive samples
+	static constexpr unsigned sample_interval_ms = 10U;
 
-	RectifiedWave() : m_counter(0), m_period(0), m_duty(100)
+	BasicRectifiedWave()
+		: m_counter(0),
+		  m_period(0),
+		  m_duty(100),
+		  m_high(0),
+		  m_level(sample_traits<Sample>::from_float(50.0f)),
+		  m_interval(sample_interval_ms),
+		  m_wake(0),
+		  m_sequence(0)
 	{
 		inputs.addPort<unsigned>(period, 1);
 		inputs.addPort<unsigned>(duty, 1);
 		inputs.addPort<bool>(clk, 1);
-		outputs.addPort<double>(out);
+		inputs.addPort<unsigned>(interval, 1);
+		outputs.addPort<Sample>(out);
+		outputs.addPort<Frame<Sample>>(frame_out);
 	}
 
 	virtual void initialize(void) override
 	{
 		m_period = inputs[period].receive<unsigned>();
-		m_duty = inputs[duty].receive<unsigned>();
+		m_duty   = inputs[duty].receive<unsigned>();
+		update_threshold();
+
+		m_wake = os_tick_count();
 	}
 
 	virtual void process(void) override
 	{
-		if(inputs[duty].has_message())
+		// Applying configuration changes
+		if(inputs[period].has_message() || inputs[duty].has_message())
 		{
-			m_duty = inputs[duty].receive<unsigned>();
+			if(inputs[period].has_message()) m_period = inputs[period].receive<unsigned>();
+			if(inputs[duty].has_message())   m_duty   = inputs[duty].receive<unsigned>();
+			update_threshold();
 		}
 
-		// Wait for clock
-		//if(!inputs[clk].receive<bool>()) return;
+		if(inputs[interval].has_message())
+		{
+			m_interval = inputs[interval].receive<unsigned>();
+			m_wake     = os_tick_count();
+		}
+
+		// Waiting for the clock when not paced by the interval
+		if(m_interval == 0 && !inputs[clk].receive<bool>()) return;
+
+		// Generating a whole frame from runs of constant level
+		Frame<Sample> frame;
+		frame.sequence = m_sequence++;
+
+		std::size_t filled = 0;
+		while(filled < Frame<Sample>::length)
+		{
+			if(m_period == 0)
+			{
+				std::fill_n(&frame[filled], Frame<Sample>::length - filled, sample_traits<Sample>::zero());
+				break;
+			}
+
+			const bool        high = m_counter < m_high;
+			const std::size_t run  = std::min<std::size_t>((high ? m_high : m_period) - m_counter, Frame<Sample>::length - filled);
 
-		// Creating output based on counter value
-		if(m_counter < (m_duty / 100.0f) * m_period)
+			std::fill_n(&frame[filled], run, high ? m_level : sample_traits<Sample>::zero());
+
+			filled    += run;
+			m_counter += (unsigned) run;
+			if(m_counter == m_period) m_counter = 0;
+		}
+
+		// Sending the frame and the individual samples to the connected outputs
+		if(outputs[frame_out].is_connected())
 		{
-			//printf("%lf, ", 6.0f);
-			outputs[out].send<double>(50.0f);
+			if(outputs[frame_out].send<Frame<Sample>>(frame) != MessageStatus::Okay) return;
 		}
-		else
+
+		if(outputs[out].is_connected())
 		{
-			//printf("%lf, ", 0.0f);
-			outputs[out].send<double>(0.0f);
+			for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+			{
+				if(outputs[out].send<Sample>(frame[i]) != MessageStatus::Okay) return;
+			}
 		}
 
-		// Increment sample counter
-		m_counter = (m_counter + 1) % m_period;
+		// Waiting for the next frame period without accumulating drift
+		if(m_interval != 0) os_delay_until(&m_wake, Frame<Sample>::length * m_interval);
 	}
 
 private:
-	unsigned m_counter;
-	unsigned m_period;
-	unsigned m_duty;
+
+	void update_threshold(void)
+	{
+		// Number of samples per period below the duty cycle fraction of the period
+		const unsigned percent = m_duty > 100U ? 100U : m_duty;
+		m_high = (unsigned) (((uint64_t) m_period * percent + 99U) / 100U);
+
+		if(m_period != 0) m_counter %= m_period;
+		else              m_counter  = 0;
+	}
+
+	unsigned   m_counter;
+	unsigned   m_period;
+	unsigned   m_duty;
+	unsigned   m_high;
+	Sample     m_level;
+	unsigned   m_interval;
+	os_tick_t  m_wake;
+	uint32_t   m_sequence;
 };
+
+typedef BasicRectifiedWave<double> RectifiedWave;
+
+#endif // MFLOW_COMPONENTS_RECT_WAVE_H_INCLUDED
@@ -0,0 +1,537 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_RESAMPLE_H_INCLUDED
+#define MFLOW_COMPONENTS_RESAMPLE_H_INCLUDED
+
+// Standard includes
+#include <cmath>
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "fir.h"
+#include "frame.h"
+#include "kernels.h"
+#include "sample.h"
+
+
+// Maximum rate change factor of the sample-rate converters
+#ifndef MFLOW_RESAMPLE_MAX_FACTOR
+#define MFLOW_RESAMPLE_MAX_FACTOR (256)
+#endif
+
+/**
+ * @brief   Designs a linear phase lowpass FIR filter with the frequency sampling method.
+ * @details The desired response is one up to the cutoff frequency and zero
+ *          above it, sampled on a grid eight times denser than the number of
+ *          taps. When a CIC order is specified, the passband follows the
+ *          inverse of the CIC droop, so the filter compensates a CIC stage
+ *          with the specified order and rate change factor that runs at the
+ *          low rate side of the filter. A linear stage changing the rate by
+ *          two at the far side of the CIC stage can be compensated as well.
+ *          The taps are Blackman windowed and normalized to unity gain at DC.
+ * @param   taps       [out] The designed taps.
+ * @param   count      [in]  The number of taps, should be odd.
+ * @param   cutoff     [in]  The cutoff frequency in cycles per sample.
+ * @param   cic_order  [in]  The order of the compensated CIC stage, zero for a plain lowpass.
+ * @param   cic_factor [in]  The rate change factor of the compensated CIC stage.
+ * @param   linear     [in]  True to compensate a linear stage as well.
+ */
+inline void design_fir(float* taps, unsigned count, float cutoff, unsigned cic_order = 0, unsigned cic_factor = 1, bool linear = false)
+{
+	const double   pi     = 3.141592653589793;
+	const double   center = (count - 1) / 2.0;
+	const unsigned grid   = 8 * count;
+
+	// Desired magnitude response at frequency f in cycles per sample
+	auto desired = [&](double f) -> double {
+
+		if(cic_order == 0 || f == 0.0) return 1.0;
+
+		const double droop        = std::sin(pi * f) / (cic_factor * std::sin(pi * f / cic_factor));
+		const double linear_droop = linear ? std::cos(pi * f / cic_factor) : 1.0;
+
+		return 1.0 / (std::pow(std::fabs(droop), (double) cic_order) * linear_droop * linear_droop);
+	};
+
+	double sum = 0.0;
+
+	for(unsigned n = 0; n < count; n++)
+	{
+		// Inverse DFT of the real, symmetric desired response
+		double value = desired(0.0);
+		for(unsigned k = 1; k < grid / 2 && (double) k / grid <= cutoff; k++)
+		{
+			const double f = (double) k / grid;
+			value += 2.0 * desired(f) * std::cos(2.0 * pi * f * (n - center));
+		}
+
+		// Blackman window
+		const double phase = count > 1 ? 2.0 * pi * n / (count - 1) : pi;
+		value *= 0.42 - 0.5 * std::cos(phase) + 0.08 * std::cos(2.0 * phase);
+
+		taps[n] = (float) value;
+		sum    += value;
+	}
+
+	for(unsigned n = 0; n < count; n++) taps[n] = (float) (taps[n] / sum);
+}
+
+/**
+ * @brief Decimating FIR stage computing only the retained outputs.
+ */
+class FirDecimatorStage {
+public:
+
+	FirDecimatorStage(void) : m_count(0), m_factor(1), m_phase(0) { }
+
+	void configure(const float* taps, unsigned count, unsigned factor)
+	{
+		m_count  = count < MFLOW_FIR_MAX_TAPS ? count : MFLOW_FIR_MAX_TAPS;
+		m_factor = factor;
+		m_phase  = 0;
+
+		for(unsigned i = 0; i < m_count; i++) m_taps[i] = taps[m_count - 1 - i];
+		m_history.reset(m_count);
+	}
+
+	bool push(float input, float& output)
+	{
+		m_history.push(input);
+
+		if(++m_phase < m_factor) return false;
+		m_phase = 0;
+
+		output = vector_dot(m_taps, m_history.window(), m_count);
+		return true;
+	}
+
+private:
+	FirHistory<float> m_history;
+	float             m_taps[MFLOW_FIR_MAX_TAPS];
+	unsigned          m_count;
+	unsigned          m_factor;
+	unsigned          m_phase;
+};
+
+/**
+ * @brief Interpolating polyphase FIR stage, the taps are scaled by the factor.
+ */
+class FirInterpolatorStage {
+public:
+
+	FirInterpolatorStage(void) : m_factor(1), m_phase_length(0) { }
+
+	void configure(const float* taps, unsigned count, unsigned factor)
+	{
+		m_factor       = factor;
+		m_phase_length = (count + factor - 1) / factor;
+
+		if(m_phase_length * factor > MFLOW_FIR_MAX_TAPS) m_phase_length = MFLOW_FIR_MAX_TAPS / factor;
+
+		// Subfilter p holds the taps p, p + factor, p + 2 * factor... in reversed order
+		for(unsigned phase = 0; phase < factor; phase++)
+		{
+			for(unsigned j = 0; j < m_phase_length; j++)
+			{
+				const unsigned tap = phase + j * factor;
+				m_subfilters[phase * m_phase_length + (m_phase_length - 1 - j)] = tap < count ? taps[tap] * (float) factor : 0.0f;
+			}
+		}
+
+		m_history.reset(m_phase_length);
+	}
+
+	void push(float input)
+	{
+		m_history.push(input);
+	}
+
+	float output(unsigned phase) const
+	{
+		return vector_dot(m_subfilters + phase * m_phase_length, m_history.window(), m_phase_length);
+	}
+
+private:
+	FirHistory<float> m_history;
+	float             m_subfilters[MFLOW_FIR_MAX_TAPS];
+	unsigned          m_factor;
+	unsigned          m_phase_length;
+};
+
+/**
+ * @brief   Cascaded integrator-comb stages with fixed-point state.
+ * @details The samples are converted to 48.16 fixed-point and the state
+ *          runs in modular 64-bit arithmetic, so the integrators may wrap
+ *          around without affecting the result. The gain of the stages is
+ *          removed when converting back to floating-point.
+ */
+class CicStage {
+public:
+
+	static constexpr unsigned max_order = 4U;
+
+	CicStage(void) : m_order(0), m_factor(1), m_phase(0), m_scale(1.0f)
+	{
+		reset();
+	}
+
+	void configure(unsigned order, unsigned factor, bool interpolating)
+	{
+		m_order  = order < max_order ? order : max_order;
+		m_factor = factor;
+		m_phase  = 0;
+
+		// The interpolator gain is one factor lower because of the zero stuffing
+		double gain = 1.0;
+		for(unsigned i = interpolating ? 1U : 0U; i < m_order; i++) gain *= factor;
+		m_scale = (float) (1.0 / (gain * 65536.0));
+
+		reset();
+	}
+
+	/**
+	 * @brief  Decimation: integrates one input sample, combs every factor samples.
+	 * @retval True when an output sample was produced.
+	 */
+	bool decimate(float input, float& output)
+	{
+		uint64_t value = quantize(input);
+		for(unsigned i = 0; i < m_order; i++) value = m_integrators[i] += value;
+
+		if(++m_phase < m_factor) return false;
+		m_phase = 0;
+
+		for(unsigned i = 0; i < m_order; i++)
+		{
+			const uint64_t delayed = m_combs[i];
+			m_combs[i] = value;
+			value     -= delayed;
+		}
+
+		output = (float) (int64_t) value * m_scale;
+		return true;
+	}
+
+	/**
+	 * @brief Interpolation: combs one input sample at the low rate.
+	 */
+	void push(float input)
+	{
+		uint64_t value = quantize(input);
+		for(unsigned i = 0; i < m_order; i++)
+		{
+			const uint64_t delayed = m_combs[i];
+			m_combs[i] = value;
+			value     -= delayed;
+		}
+
+		m_input = value;
+	}
+
+	/**
+	 * @brief Interpolation: integrates the zero-stuffed stream for one high rate output.
+	 */
+	float output(unsigned phase)
+	{
+		uint64_t value = phase == 0 ? m_input : 0U;
+		for(unsigned i = 0; i < m_order; i++) value = m_integrators[i] += value;
+
+		return (float) (int64_t) value * m_scale;
+	}
+
+private:
+
+	static uint64_t quantize(float value)
+	{
+		return (uint64_t) (int64_t) std::lrint((double) value * 65536.0);
+	}
+
+	void reset(void)
+	{
+		m_input = 0;
+		for(unsigned i = 0; i < max_order; i++) m_integrators[i] = m_combs[i] = 0;
+	}
+
+	uint64_t m_integrators[max_order];
+	uint64_t m_combs[max_order];
+	uint64_t m_input;
+	unsigned m_order;
+	unsigned m_factor;
+	unsigned m_phase;
+	float    m_scale;
+};
+
+/**
+ * @brief   Rate change by two with linear interpolation.
+ * @details Interpolation inserts the midpoint of consecutive samples,
+ *          decimation applies the matching triangular weights. Both have
+ *          the response cos(pi f)^2, f in cycles per high rate sample.
+ */
+class LinearStage {
+public:
+
+	LinearStage(void)
+	{
+		reset();
+	}
+
+	void reset(void)
+	{
+		m_last  = 0.0f;
+		m_even  = 0.0f;
+		m_phase = 0;
+	}
+
+	/**
+	 * @brief Interpolation: the sample preceding the input at the high rate.
+	 */
+	float midpoint(float input)
+	{
+		const float value = 0.5f * (m_last + input);
+		m_last = input;
+		return value;
+	}
+
+	/**
+	 * @brief  Decimation: one output sample for every two input samples.
+	 * @retval True when an output sample was produced.
+	 */
+	bool decimate(float input, float& output)
+	{
+		if(m_phase == 0)
+		{
+			m_even  = input;
+			m_phase = 1;
+			return false;
+		}
+
+		output  = 0.25f * m_last + 0.5f * m_even + 0.25f * input;
+		m_last  = input;
+		m_phase = 0;
+		return true;
+	}
+
+private:
+	float    m_last;
+	float    m_even;
+	unsigned m_phase;
+};
+
+/**
+ * @brief   Base class of the sample-rate converter components.
+ * @details Small factors use a single polyphase FIR stage. Large factors
+ *          use a CIC stage for the bulk of the rate change, and a FIR stage
+ *          at the low rate side changing the rate by two, which compensates
+ *          the CIC passband droop and provides the final anti-aliasing. With
+ *          odd factors, a linear stage at the high rate side changes the rate
+ *          by two in the opposite direction, so the CIC stage can take the
+ *          whole factor. Up to 0.3 of the low rate, the gain is within 0.1%
+ *          and everything folding onto this band is attenuated by more than
+ *          50 dB. The converters compute in single precision regardless of
+ *          the sample type.
+ */
+template <class Sample>
+class ResamplerBase : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in     = 0U;
+	static constexpr unsigned factor = 1U;
+	static constexpr unsigned out    = 0U;
+
+	// Filter design parameters
+	static constexpr unsigned polyphase_limit  = 8U;
+	static constexpr unsigned taps_per_phase   = 14U;
+	static constexpr unsigned compensator_taps = 65U;
+	static constexpr unsigned cic_order        = 4U;
+
+	ResamplerBase() : m_factor(0), m_cic_factor(1), m_fir_factor(1), m_linear_factor(1)
+	{
+		inputs.addPort<Frame<Sample>>(in, 2);
+		inputs.addPort<unsigned>(factor, 1);
+		outputs.addPort<Frame<Sample>>(out);
+	}
+
+	virtual void initialize(void) override
+	{
+		auto value = inputs[factor].receive<unsigned>();
+		set_factor(value ? value.value() : 1U);
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[factor].has_message())
+		{
+			auto value = inputs[factor].receive<unsigned>();
+			if(value) set_factor(value.value());
+		}
+
+		// Reading the next input frame
+		auto frame = inputs[in].receive<Frame<Sample>>();
+		if(!frame) return;
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+		{
+			if(!convert(sample_traits<Sample>::to_float(frame.value()[i]))) return;
+		}
+	}
+
+protected:
+
+	/**
+	 * @brief Designs the stages for the new rate change factor.
+	 */
+	virtual void configure(float* taps, unsigned count) = 0;
+
+	/**
+	 * @brief  Converts one input sample, emitting the output frames that are completed.
+	 * @retval False when the component is terminating, true otherwise.
+	 */
+	virtual bool convert(float input) = 0;
+
+	bool emit(float value)
+	{
+		if(m_output.append(sample_traits<Sample>::from_float(value)))
+		{
+			if(outputs[out].send<Frame<Sample>>(m_output.frame()) != MessageStatus::Okay) return false;
+			m_output.next();
+		}
+
+		return true;
+	}
+
+	FrameAssembler<Sample> m_output;
+	CicStage               m_cic;
+	LinearStage            m_linear;
+	unsigned               m_factor;
+	unsigned               m_cic_factor;
+	unsigned               m_fir_factor;
+	unsigned               m_linear_factor;
+
+private:
+
+	void set_factor(unsigned value)
+	{
+		value = value == 0 ? 1U : value > MFLOW_RESAMPLE_MAX_FACTOR ? MFLOW_RESAMPLE_MAX_FACTOR : value;
+		if(value == m_factor) return;
+
+		m_factor = value;
+		float taps[MFLOW_FIR_MAX_TAPS];
+
+		if(value <= polyphase_limit)
+		{
+			// Polyphase lowpass, cutoff at the Nyquist frequency of the low rate
+			const unsigned count = taps_per_phase * value + 1;
+
+			m_cic_factor    = 1;
+			m_fir_factor    = value;
+			m_linear_factor = 1;
+			design_fir(taps, count, 0.5f / value);
+			configure(taps, count);
+		}
+		else
+		{
+			// CIC stage with a compensating FIR stage at the low rate side, odd factors add a linear stage
+			m_fir_factor    = 2;
+			m_linear_factor = value % 2 == 0 ? 1U : 2U;
+			m_cic_factor    = value * m_linear_factor / m_fir_factor;
+			design_fir(taps, compensator_taps, 0.25f, cic_order, m_cic_factor, m_linear_factor > 1);
+			configure(taps, compensator_taps);
+		}
+	}
+};
+
+/**
+ * @brief Decimator with integrated anti-aliasing, one output sample for every factor input samples.
+ */
+template <class Sample>
+class BasicDecimator : public ResamplerBase<Sample> {
+protected:
+
+	virtual void configure(float* taps, unsigned count) override
+	{
+		this->m_cic.configure(ResamplerBase<Sample>::cic_order, this->m_cic_factor, false);
+		this->m_linear.reset();
+		m_fir.configure(taps, count, this->m_fir_factor);
+	}
+
+	virtual bool convert(float input) override
+	{
+		// The linear stage doubles the rate ahead of the CIC stage
+		if(this->m_linear_factor > 1 && !decimate(this->m_linear.midpoint(input))) return false;
+
+		return decimate(input);
+	}
+
+private:
+
+	bool decimate(float input)
+	{
+		// The CIC stage runs first at the high rate
+		if(this->m_cic_factor > 1 && !this->m_cic.decimate(input, input)) return true;
+
+		float output;
+		if(!m_fir.push(input, output)) return true;
+
+		return this->emit(output);
+	}
+
+
+private:
+	FirDecimatorStage m_fir;
+};
+
+/**
+ * @brief Interpolator with integrated anti-imaging, factor output samples for every input sample.
+ */
+template <class Sample>
+class BasicInterpolator : public ResamplerBase<Sample> {
+protected:
+
+	virtual void configure(float* taps, unsigned count) override
+	{
+		this->m_cic.configure(ResamplerBase<Sample>::cic_order, this->m_cic_factor, true);
+		this->m_linear.reset();
+		m_fir.configure(taps, count, this->m_fir_factor);
+	}
+
+	virtual bool convert(float input) override
+	{
+		// The FIR stage runs first at the low rate
+		m_fir.push(input);
+
+		for(unsigned phase = 0; phase < this->m_fir_factor; phase++)
+		{
+			const float value = m_fir.output(phase);
+
+			if(this->m_cic_factor == 1)
+			{
+				if(!this->emit(value)) return false;
+				continue;
+			}
+
+			this->m_cic.push(value);
+			for(unsigned cic_phase = 0; cic_phase < this->m_cic_factor; cic_phase++)
+			{
+				if(!interpolate(this->m_cic.output(cic_phase))) return false;
+			}
+		}
+
+		return true;
+	}
+
+private:
+
+	bool interpolate(float value)
+	{
+		// The linear stage halves the rate after the CIC stage
+		if(this->m_linear_factor > 1 && !this->m_linear.decimate(value, value)) return true;
+
+		return this->emit(value);
+	}
+
+	FirInterpolatorStage m_fir;
+};
+
+#endif // MFLOW_COMPONENTS_RESAMPLE_H_INCLUDED
@@ -0,0 +1,101 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_ROUTER_H_INCLUDED
+#define MFLOW_COMPONENTS_ROUTER_H_INCLUDED
+
+// Standard includes
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+
+
+// Number of keys in the jump table of the routers
+#ifndef MFLOW_ROUTER_KEYS
+#define MFLOW_ROUTER_KEYS (256)
+#endif
+
+/**
+ * @brief Jump table of a router, sent on the routes option port.
+ */
+struct RouteTable {
+	uint8_t output[MFLOW_ROUTER_KEYS]; /**< Output index of every key.                 */
+	uint8_t fallback;                  /**< Output index of keys outside of the table. */
+};
+
+/**
+ * @brief   Component forwarding each message to one of its outputs by content.
+ * @details The key function registered with the factory extracts a key from
+ *          the message, a predicate is a key function returning zero or one.
+ *          The key selects the output from a precomputed jump table, so the
+ *          routing cost does not depend on the number of outputs. Messages
+ *          routed to #discard, or to an output that is not connected, are
+ *          dropped and counted. By default key k is routed to output k modulo
+ *          the number of outputs. The message is received once and sent once,
+ *          no other copies are made.
+ */
+template <class Message, unsigned Outputs>
+class Router : public Component {
+public:
+
+	static_assert(Outputs >= 1 && Outputs < 255, "The number of outputs must be between 1 and 254.");
+
+	typedef uint32_t (*KeyFunction)(const Message& message);
+
+	// Port index definitions, the outputs are numbered from zero
+	static constexpr unsigned in     = 0U;
+	static constexpr unsigned routes = 1U;
+
+	// Jump table entry dropping the message
+	static constexpr uint8_t discard = 0xFFU;
+
+	explicit Router(KeyFunction key) : m_key(key), m_dropped(0)
+	{
+		inputs.addPort<Message>(in, 1);
+		inputs.addPort<RouteTable>(routes, 1);
+		for(unsigned o = 0; o < Outputs; o++) outputs.addPort<Message>(o);
+
+		// Routing the keys modulo the number of outputs
+		for(unsigned k = 0; k < MFLOW_ROUTER_KEYS; k++) m_table.output[k] = (uint8_t) (k % Outputs);
+		m_table.fallback = discard;
+	}
+
+	virtual void initialize(void) override { return; }
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[routes].has_message())
+		{
+			auto value = inputs[routes].template receive<RouteTable>();
+			if(value) m_table = value.value();
+		}
+
+		// Waiting for the next message
+		auto message = inputs[in].template receive<Message>();
+		if(!message) return;
+
+		// Looking up the output of the key
+		const uint32_t key    = m_key(message.value());
+		const uint8_t  output = key < MFLOW_ROUTER_KEYS ? m_table.output[key] : m_table.fallback;
+
+		if(output >= Outputs || !outputs[output].is_connected())
+		{
+			m_dropped++;
+			return;
+		}
+
+		outputs[output].template send<Message>(message.value());
+	}
+
+	/**
+	 * @brief  Queries the number of dropped messages.
+	 */
+	unsigned dropped(void) const { return m_dropped; }
+
+private:
+	KeyFunction m_key;
+	RouteTable  m_table;
+	unsigned    m_dropped;
+};
+
+#endif // MFLOW_COMPONENTS_ROUTER_H_INCLUDED
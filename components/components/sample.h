@@ -0,0 +1,162 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_SAMPLE_H_INCLUDED
+#define MFLOW_COMPONENTS_SAMPLE_H_INCLUDED
+
+// Standard includes
+#include <cstdint>
+
+
+/**
+ * @brief   Signed Q1.15 fixed-point sample.
+ * @details Represents values in the [-1, 1) range with 15 fractional bits.
+ *          The raw value is wrapped in a structure, so fixed-point streams
+ *          have a distinct message type from plain integer streams.
+ */
+struct q15 {
+	int16_t raw; /**< The raw two's complement representation. */
+};
+
+/**
+ * @brief   Signed Q1.31 fixed-point sample.
+ * @details Represents values in the [-1, 1) range with 31 fractional bits.
+ */
+struct q31 {
+	int32_t raw; /**< The raw two's complement representation. */
+};
+
+/**
+ * @brief   Arithmetic and conversion primitives for a sample type.
+ * @details Signal components are written against this interface, so the
+ *          same implementation can be instantiated for floating-point and
+ *          fixed-point samples. Fixed-point operations saturate to the
+ *          representable range instead of wrapping around. The accumulator
+ *          type is wide enough to sum many samples without overflowing.
+ */
+template <class Sample>
+struct sample_traits;
+
+/**
+ * @brief Sample traits for double precision floating-point samples.
+ */
+template <>
+struct sample_traits<double> {
+
+	typedef double accumulator;
+
+	static inline double      zero(void)                            { return 0.0; }
+	static inline double      from_float(float value)               { return value; }
+	static inline float       to_float(double sample)               { return (float) sample; }
+	static inline double      add(double a, double b)               { return a + b; }
+	static inline double      sub(double a, double b)               { return a - b; }
+	static inline double      mul(double a, double b)               { return a * b; }
+	static inline double      scale(double a, float gain)           { return a * gain; }
+	static inline accumulator widen(double sample)                  { return sample; }
+	static inline double      narrow(accumulator value)             { return value; }
+	static inline double      average(accumulator sum, unsigned n)  { return sum / n; }
+};
+
+/**
+ * @brief Sample traits for single precision floating-point samples.
+ */
+template <>
+struct sample_traits<float> {
+
+	typedef float accumulator;
+
+	static inline float       zero(void)                            { return 0.0f; }
+	static inline float       from_float(float value)               { return value; }
+	static inline float       to_float(float sample)                { return sample; }
+	static inline float       add(float a, float b)                 { return a + b; }
+	static inline float       sub(float a, float b)                 { return a - b; }
+	static inline float       mul(float a, float b)                 { return a * b; }
+	static inline float       scale(float a, float gain)            { return a * gain; }
+	static inline accumulator widen(float sample)                   { return sample; }
+	static inline float       narrow(accumulator value)             { return value; }
+	static inline float       average(accumulator sum, unsigned n)  { return sum / (float) n; }
+};
+
+/**
+ * @brief Sample traits for Q1.15 fixed-point samples.
+ */
+template <>
+struct sample_traits<q15> {
+
+	typedef int32_t accumulator;
+
+	static inline q15 zero(void) { return q15{0}; }
+
+	static inline q15 from_float(float value)
+	{
+		// Saturating values outside of the [-1, 1) range
+		if(value >=  1.0f) return q15{INT16_MAX};
+		if(value <  -1.0f) return q15{INT16_MIN};
+
+		return narrow((accumulator) (value * 32768.0f + (value >= 0.0f ? 0.5f : -0.5f)));
+	}
+
+	static inline float to_float(q15 sample) { return (float) sample.raw * (1.0f / 32768.0f); }
+
+	static inline q15 add(q15 a, q15 b) { return narrow((accumulator) a.raw + b.raw); }
+	static inline q15 sub(q15 a, q15 b) { return narrow((accumulator) a.raw - b.raw); }
+
+	static inline q15 mul(q15 a, q15 b)
+	{
+		// Rounding the product, -1 * -1 is the only case that saturates
+		return narrow(((accumulator) a.raw * b.raw + (1L << 14)) >> 15);
+	}
+
+	static inline q15 scale(q15 a, float gain) { return from_float(to_float(a) * gain); }
+
+	static inline accumulator widen(q15 sample) { return sample.raw; }
+
+	static inline q15 narrow(accumulator value)
+	{
+		return q15{(int16_t) (value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value)};
+	}
+
+	static inline q15 average(accumulator sum, unsigned n) { return narrow(sum / (accumulator) n); }
+};
+
+/**
+ * @brief Sample traits for Q1.31 fixed-point samples.
+ */
+template <>
+struct sample_traits<q31> {
+
+	typedef int64_t accumulator;
+
+	static inline q31 zero(void) { return q31{0}; }
+
+	static inline q31 from_float(float value)
+	{
+		// Saturating values outside of the [-1, 1) range
+		if(value >=  1.0f) return q31{INT32_MAX};
+		if(value <  -1.0f) return q31{INT32_MIN};
+
+		return narrow((accumulator) (value * 2147483648.0f + (value >= 0.0f ? 0.5f : -0.5f)));
+	}
+
+	static inline float to_float(q31 sample) { return (float) sample.raw * (1.0f / 2147483648.0f); }
+
+	static inline q31 add(q31 a, q31 b) { return narrow((accumulator) a.raw + b.raw); }
+	static inline q31 sub(q31 a, q31 b) { return narrow((accumulator) a.raw - b.raw); }
+
+	static inline q31 mul(q31 a, q31 b)
+	{
+		// Rounding the product, -1 * -1 is the only case that saturates
+		return narrow(((accumulator) a.raw * b.raw + (1LL << 30)) >> 31);
+	}
+
+	static inline q31 scale(q31 a, float gain) { return from_float(to_float(a) * gain); }
+
+	static inline accumulator widen(q31 sample) { return sample.raw; }
+
+	static inline q31 narrow(accumulator value)
+	{
+		return q31{(int32_t) (value > INT32_MAX ? INT32_MAX : value < INT32_MIN ? INT32_MIN : value)};
+	}
+
+	static inline q31 average(accumulator sum, unsigned n) { return narrow(sum / (accumulator) n); }
+};
+
+#endif // MFLOW_COMPONENTS_SAMPLE_H_INCLUDED
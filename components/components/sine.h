@@ -1,39 +1,155 @@
 #pragma once
 
 #include <cmath>
+#include <cstdint>
 #include "component.h"
+#include "frame.h"
+#include "os.h"
+#include "sample.h"
 
-class SineWave : public Component {
+
+/**
+ * @brief   Shared single-precision sine wavetable for phase accumulator oscillators.
+ * @details The table holds one full sine period with one guard entry, so the
+ *          linear interpolation never has to wrap the index. The phase is a
+ *          32-bit fixed-point fraction of the full period, the upper bits
+ *          select the table entry and the lower bits the interpolation weight.
+ */
+class SineTable {
+public:
+
+	static constexpr unsigned index_bits = 8U;                          /**< Number of phase bits used as table index. */
+	static constexpr unsigned size       = 1U << index_bits;            /**< Number of entries in one period.          */
+	static constexpr unsigned frac_bits  = 32U - index_bits;            /**< Number of phase bits used for weighting.  */
+	static constexpr uint32_t frac_mask  = (1UL << frac_bits) - 1UL;    /**< Mask selecting the interpolation weight.  */
+
+	/**
+	 * @brief  Queries the table, building it on the first call.
+	 * @retval Pointer to the first of the size + 1 table entries.
+	 */
+	static const float* data(void)
+	{
+		static const SineTable table;
+		return table.m_values;
+	}
+
+	/**
+	 * @brief  Evaluates the sine of the phase with linear interpolation.
+	 * @param  values [in] The table returned by #data().
+	 * @param  phase  [in] The phase as a fraction of the full period.
+	 * @retval The interpolated sine value.
+	 */
+	static inline float lookup(const float* values, uint32_t phase)
+	{
+		const uint32_t index  = phase >> frac_bits;
+		const float    weight = (float) (phase & frac_mask) * (1.0f / (float) (1UL << frac_bits));
+
+		return values[index] + (values[index + 1] - values[index]) * weight;
+	}
+
+private:
+
+	SineTable(void)
+	{
+		// Sampling one full period, the guard entry equals the first one
+		for(unsigned i = 0; i <= size; i++)
+		{
+			m_values[i] = (float) std::sin(6.283185307179586 * (double) i / (double) size);
+		}
+	}
+
+	float m_values[size + 1]; /**< Sine samples of one period plus a guard entry. */
+};
+
+/**
+ * @brief   Sine wave generator producing samples of the specified type.
+ * @details Fixed-point instantiations saturate at full scale, so their
+ *          amplitude is effectively limited to one.
+ */
+template <class Sample>
+class BasicSineWave : public Component {
 public:
 
 	static constexpr unsigned amplitude = 0U;
 	static constexpr unsigned period    = 1U;
 	static constexpr unsigned phase     = 2U;
 	static constexpr unsigned out       = 0U;
+	static constexpr unsigned frame_out = 1U;
 
-	SineWave() : m_period(0), m_tick(0), m_ampl(1)
+	// Nominal time between two consecutive samples
+	static constexpr unsigned sample_interval_ms = 10U;
+
+	BasicSineWave() : m_ampl(1), m_increment(0), m_phase(0), m_offset(0), m_phase_ticks(0), m_sequence(0)
 	{
 		inputs.addPort<unsigned>(amplitude, 1);
 		inputs.addPort<unsigned>(period, 1);
 		inputs.addPort<unsigned>(phase,  1);
-		outputs.addPort<double>(out);
+		outputs.addPort<Sample>(out);
+		outputs.addPort<Frame<Sample>>(frame_out);
 	}
 
 	virtual void initialize(void) override {
-		m_period = inputs[period].receive<unsigned>();
-		m_ampl   = inputs[amplitude].receive<unsigned>();
-		//m_tick = inputs[phase].receive<unsigned>();
+		set_period(inputs[period].receive<unsigned>());
+		m_ampl = inputs[amplitude].receive<unsigned>();
 	}
 
 	virtual void process(void) override {
-		double output = m_ampl * sin(2 * 3.14159265f * (double) m_tick++ / (double) m_period);
-		outputs[out].send<double>(output);
 
-		vTaskDelay(10 / portTICK_RATE_MS);
+		// Applying configuration changes
+		if(inputs[amplitude].has_message()) m_ampl = inputs[amplitude].receive<unsigned>();
+		if(inputs[period].has_message())    set_period(inputs[period].receive<unsigned>());
+		if(inputs[phase].has_message())     set_phase(inputs[phase].receive<unsigned>());
+
+		// Generating a whole frame with the phase accumulator
+		Frame<Sample> frame;
+		const float*  table = SineTable::data();
+		const float   ampl  = (float) m_ampl;
+
+		frame.sequence = m_sequence++;
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+		{
+			frame[i] = sample_traits<Sample>::from_float(ampl * SineTable::lookup(table, m_phase + m_offset));
+			m_phase += m_increment;
+		}
+
+		// Sending the frame and the individual samples to the connected outputs
+		if(outputs[frame_out].is_connected())
+		{
+			if(outputs[frame_out].send<Frame<Sample>>(frame) != MessageStatus::Okay) return;
+		}
+
+		if(outputs[out].is_connected())
+		{
+			for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+			{
+				if(outputs[out].send<Sample>(frame[i]) != MessageStatus::Okay) return;
+			}
+		}
+
+		os_delay(Frame<Sample>::length * sample_interval_ms);
 	}
 
 private:
-	unsigned m_period;
-	unsigned m_tick;
-	unsigned   m_ampl;
+
+	void set_period(unsigned samples) {
+
+		// Phase step per sample, the accumulator wraps at the end of every period
+		m_increment = samples ? (uint32_t) (((1ULL << 32) + samples / 2) / samples) : 0U;
+		set_phase(m_phase_ticks);
+	}
+
+	void set_phase(unsigned ticks) {
+		m_phase_ticks = ticks;
+		m_offset      = m_phase_ticks * m_increment;
+	}
+
+	unsigned m_ampl;
+	uint32_t m_increment;
+	uint32_t m_phase;
+	uint32_t m_offset;
+	unsigned m_phase_ticks;
+	uint32_t m_sequence;
 };
+
+typedef BasicSineWave<double> SineWave;
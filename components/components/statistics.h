@@ -0,0 +1,338 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_STATISTICS_H_INCLUDED
+#define MFLOW_COMPONENTS_STATISTICS_H_INCLUDED
+
+// Standard includes
+#include <cmath>
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "sample.h"
+
+
+/**
+ * @brief   Statistics of a stream, emitted by the Statistics component.
+ * @details The windowed fields describe the last count samples, the
+ *          exponentially weighted fields describe the whole stream with
+ *          exponentially decaying weights.
+ */
+struct StreamStatistics {
+	uint32_t sequence;     /**< Sequence number of the record.                 */
+	uint32_t count;        /**< The number of samples in the window.           */
+	float    min;          /**< Minimum of the window.                         */
+	float    max;          /**< Maximum of the window.                         */
+	float    peak_to_peak; /**< Difference of the maximum and the minimum.     */
+	float    mean;         /**< Mean of the window.                            */
+	float    variance;     /**< Population variance of the window.             */
+	float    rms;          /**< Root mean square of the window.                */
+	float    ew_mean;      /**< Exponentially weighted mean.                   */
+	float    ew_variance;  /**< Exponentially weighted variance.               */
+	float    ew_rms;       /**< Exponentially weighted root mean square.       */
+};
+
+/**
+ * @brief   Monotonic deque tracking the extremum of a sliding window.
+ * @details Stores the candidates for the extremum in a ring of window
+ *          length, every sample is pushed and popped at most once, so the
+ *          update is O(1) amortized. The comparison selects between the
+ *          minimum (less) and the maximum (greater).
+ */
+template <bool Maximum>
+class SlidingExtremum {
+public:
+
+	SlidingExtremum(void) : m_values(nullptr), m_indices(nullptr), m_capacity(0), m_head(0), m_size(0) { }
+
+	~SlidingExtremum()
+	{
+		delete[] m_values;
+		delete[] m_indices;
+	}
+
+	void reset(unsigned capacity)
+	{
+		if(capacity != m_capacity)
+		{
+			delete[] m_values;
+			delete[] m_indices;
+
+			m_values   = new float[capacity];
+			m_indices  = new uint32_t[capacity];
+			m_capacity = capacity;
+		}
+
+		m_head = 0;
+		m_size = 0;
+	}
+
+	/**
+	 * @brief Pushes the sample with the specified index, expiring samples older than the window.
+	 */
+	void push(uint32_t index, float value)
+	{
+		// Expiring the candidate that left the window
+		if(m_size > 0 && index - m_indices[m_head] >= m_capacity)
+		{
+			m_head = next(m_head);
+			m_size--;
+		}
+
+		// Removing the candidates dominated by the new sample
+		while(m_size > 0)
+		{
+			const unsigned tail = (m_head + m_size - 1) % m_capacity;
+			if(Maximum ? m_values[tail] > value : m_values[tail] < value) break;
+			m_size--;
+		}
+
+		const unsigned tail = (m_head + m_size) % m_capacity;
+		m_values[tail]  = value;
+		m_indices[tail] = index;
+		m_size++;
+	}
+
+	float value(void) const
+	{
+		return m_values[m_head];
+	}
+
+private:
+
+	unsigned next(unsigned position) const
+	{
+		return position + 1 == m_capacity ? 0 : position + 1;
+	}
+
+	float*    m_values;
+	uint32_t* m_indices;
+	unsigned  m_capacity;
+	unsigned  m_head;
+	unsigned  m_size;
+};
+
+/**
+ * @brief   Component computing windowed and exponentially weighted statistics.
+ * @details Every sample is processed in O(1): the sliding minimum and
+ *          maximum use monotonic deques, the sliding mean and variance use
+ *          the Welford update for the sample entering and the one leaving
+ *          the window. The accumulated rounding errors are removed by
+ *          recomputing the sums once per window length. A record is emitted
+ *          after every decimation samples (the window length by default).
+ */
+template <class Sample>
+class BasicStatistics : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in         = 0U;
+	static constexpr unsigned frame_in   = 1U;
+	static constexpr unsigned window     = 2U;
+	static constexpr unsigned alpha      = 3U;
+	static constexpr unsigned decimation = 4U;
+	static constexpr unsigned out        = 0U;
+
+	BasicStatistics()
+		: m_history(nullptr),
+		  m_window(0),
+		  m_count(0),
+		  m_index(0),
+		  m_position(0),
+		  m_mean(0.0f),
+		  m_m2(0.0f),
+		  m_alpha(0.01f),
+		  m_ew_mean(0.0f),
+		  m_ew_variance(0.0f),
+		  m_ew_started(false),
+		  m_decimation(0),
+		  m_pending(0),
+		  m_sequence(0)
+	{
+		inputs.addPort<Sample>(in, 1);
+		inputs.addPort<Frame<Sample>>(frame_in, 1);
+		inputs.addPort<unsigned>(window, 1);
+		inputs.addPort<float>(alpha, 1);
+		inputs.addPort<unsigned>(decimation, 1);
+		outputs.addPort<StreamStatistics>(out);
+	}
+
+	virtual ~BasicStatistics()
+	{
+		delete[] m_history;
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the window width
+		auto value = inputs[window].receive<unsigned>();
+		set_window(value ? value.value() : 1U);
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[window].has_message())
+		{
+			auto value = inputs[window].receive<unsigned>();
+			if(value) set_window(value.value());
+		}
+
+		if(inputs[alpha].has_message())
+		{
+			auto value = inputs[alpha].receive<float>();
+			if(value) m_alpha = value.value();
+		}
+
+		if(inputs[decimation].has_message())
+		{
+			auto value = inputs[decimation].receive<unsigned>();
+			if(value) m_decimation = value.value();
+		}
+
+		// Waiting for samples or frames
+		auto index = await({in, frame_in});
+		if(!index) return;
+
+		if(index.value() == in)
+		{
+			auto value = inputs[in].receive<Sample>();
+			if(value) update(sample_traits<Sample>::to_float(value.value()));
+		}
+		else
+		{
+			auto frame = inputs[frame_in].receive<Frame<Sample>>();
+			if(!frame) return;
+
+			for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+			{
+				if(!update(sample_traits<Sample>::to_float(frame.value()[i]))) return;
+			}
+		}
+	}
+
+private:
+
+	void set_window(unsigned value)
+	{
+		value = value ? value : 1U;
+
+		if(value != m_window)
+		{
+			delete[] m_history;
+			m_history = new float[value];
+			m_window  = value;
+		}
+
+		m_minimum.reset(m_window);
+		m_maximum.reset(m_window);
+
+		m_count    = 0;
+		m_position = 0;
+		m_mean     = 0.0f;
+		m_m2       = 0.0f;
+		m_pending  = 0;
+	}
+
+	bool update(float x)
+	{
+		const unsigned position = m_position;
+
+		// Sliding extrema
+		m_minimum.push(m_index, x);
+		m_maximum.push(m_index, x);
+
+		// Sliding Welford update, replacing the oldest sample when the window is full
+		if(m_count < m_window)
+		{
+			m_count++;
+			const float delta = x - m_mean;
+			m_mean += delta / m_count;
+			m_m2   += delta * (x - m_mean);
+		}
+		else
+		{
+			const float oldest   = m_history[position];
+			const float previous = m_mean;
+			m_mean += (x - oldest) / m_count;
+			m_m2   += (x - oldest) * (x - m_mean + oldest - previous);
+		}
+
+		m_history[position] = x;
+		m_index++;
+		if(++m_position == m_window) m_position = 0;
+
+		// Removing the accumulated rounding errors once per window
+		if(position == m_window - 1 && m_count == m_window) recompute();
+
+		// Exponentially weighted mean and variance
+		if(!m_ew_started)
+		{
+			m_ew_started = true;
+			m_ew_mean    = x;
+		}
+		else
+		{
+			const float delta = x - m_ew_mean;
+			m_ew_mean    += m_alpha * delta;
+			m_ew_variance = (1.0f - m_alpha) * (m_ew_variance + m_alpha * delta * delta);
+		}
+
+		// Emitting the statistics at the decimated rate
+		if(++m_pending < (m_decimation ? m_decimation : m_window)) return true;
+		m_pending = 0;
+
+		return emit() == MessageStatus::Okay;
+	}
+
+	void recompute(void)
+	{
+		float sum = 0.0f;
+		for(unsigned i = 0; i < m_window; i++) sum += m_history[i];
+		m_mean = sum / m_window;
+
+		float m2 = 0.0f;
+		for(unsigned i = 0; i < m_window; i++) m2 += (m_history[i] - m_mean) * (m_history[i] - m_mean);
+		m_m2 = m2;
+	}
+
+	MessageStatus emit(void)
+	{
+		StreamStatistics record;
+
+		const float variance = m_m2 > 0.0f ? m_m2 / m_count : 0.0f;
+
+		record.sequence     = m_sequence++;
+		record.count        = m_count;
+		record.min          = m_minimum.value();
+		record.max          = m_maximum.value();
+		record.peak_to_peak = record.max - record.min;
+		record.mean         = m_mean;
+		record.variance     = variance;
+		record.rms          = std::sqrt(variance + m_mean * m_mean);
+		record.ew_mean      = m_ew_mean;
+		record.ew_variance  = m_ew_variance;
+		record.ew_rms       = std::sqrt(m_ew_variance + m_ew_mean * m_ew_mean);
+
+		return outputs[out].send<StreamStatistics>(record);
+	}
+
+	SlidingExtremum<false> m_minimum;
+	SlidingExtremum<true>  m_maximum;
+	float*                 m_history;
+	unsigned               m_window;
+	unsigned               m_count;
+	uint32_t               m_index;
+	unsigned               m_position;
+	float                  m_mean;
+	float                  m_m2;
+	float                  m_alpha;
+	float                  m_ew_mean;
+	float                  m_ew_variance;
+	bool                   m_ew_started;
+	unsigned               m_decimation;
+	unsigned               m_pending;
+	uint32_t               m_sequence;
+};
+
+#endif // MFLOW_COMPONENTS_STATISTICS_H_INCLUDED
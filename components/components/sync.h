@@ -0,0 +1,315 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_SYNC_H_INCLUDED
+#define MFLOW_COMPONENTS_SYNC_H_INCLUDED
+
+// Standard includes
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "os.h"
+#include "sample.h"
+
+
+// Number of samples buffered per input of the synchronizer
+#ifndef MFLOW_SYNC_DEPTH
+#define MFLOW_SYNC_DEPTH (16)
+#endif
+
+/**
+ * @brief Sample carrying the time (or sequence number) it belongs to.
+ */
+template <class Sample>
+struct Stamped {
+	uint32_t timestamp; /**< Timestamp or sequence number of the sample. */
+	Sample   value;     /**< The sample.                                 */
+};
+
+/**
+ * @brief Samples of several streams aligned to the same timestamp.
+ */
+template <class Sample, unsigned Inputs>
+struct Aligned {
+	uint32_t timestamp;      /**< The common timestamp of the samples.   */
+	Sample   values[Inputs]; /**< The samples in the order of the inputs. */
+};
+
+/**
+ * @brief Policies resolving the value of a stream at a reference timestamp.
+ */
+enum class SyncPolicy : uint8_t {
+	Exact,       /**< A sample within the tolerance of the timestamp is required. */
+	Hold,        /**< The latest sample not newer than the timestamp is used.     */
+	Interpolate  /**< Linear interpolation between the neighbouring samples.      */
+};
+
+/**
+ * @brief   Component stamping samples with a sequence number or the tick count.
+ * @details Streams of the same sample rate stamped with sequence numbers are
+ *          aligned sample by sample, streams of different rates should be
+ *          stamped with the tick count.
+ */
+template <class Sample>
+class BasicTimestamper : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in    = 0U;
+	static constexpr unsigned ticks = 1U;
+	static constexpr unsigned out   = 0U;
+
+	BasicTimestamper() : m_ticks(false), m_sequence(0)
+	{
+		inputs.addPort<Sample>(in, 1);
+		inputs.addPort<bool>(ticks, 1);
+		outputs.addPort<Stamped<Sample>>(out);
+	}
+
+	virtual void initialize(void) override { return; }
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[ticks].has_message())
+		{
+			auto value = inputs[ticks].receive<bool>();
+			if(value) m_ticks = value.value();
+		}
+
+		auto value = inputs[in].receive<Sample>();
+		if(!value) return;
+
+		Stamped<Sample> stamped;
+		stamped.timestamp = m_ticks ? (uint32_t) os_tick_count() : m_sequence++;
+		stamped.value     = value.value();
+
+		outputs[out].send<Stamped<Sample>>(stamped);
+	}
+
+private:
+	bool     m_ticks;
+	uint32_t m_sequence;
+};
+
+/**
+ * @brief   Component aligning several timestamped streams.
+ * @details Input 0 is the reference stream: for every reference sample the
+ *          value of each other stream at the reference timestamp is resolved
+ *          with the selected policy, and the values are emitted together.
+ *          Every input buffers at most MFLOW_SYNC_DEPTH samples. When a
+ *          buffer is full while another stream still has to be waited for,
+ *          the waiting stream is considered stalled: the hold and interpolate
+ *          policies reuse its last sample, the exact policy drops the
+ *          reference sample. The latency at the merge point is therefore
+ *          bounded instead of growing with the rate mismatch. Timestamps may
+ *          wrap around.
+ */
+template <class Sample, unsigned Inputs>
+class BasicSynchronizer : public Component {
+public:
+
+	static_assert(Inputs >= 2, "At least two inputs are required.");
+
+	// Port index definitions, the stream inputs are numbered from zero
+	static constexpr unsigned policy    = Inputs;
+	static constexpr unsigned tolerance = Inputs + 1U;
+	static constexpr unsigned out       = 0U;
+
+	BasicSynchronizer() : m_policy(SyncPolicy::Hold), m_tolerance(0), m_dropped(0)
+	{
+		for(unsigned i = 0; i < Inputs; i++)
+		{
+			inputs.addPort<Stamped<Sample>>(i, MFLOW_SYNC_DEPTH);
+			m_ports[i] = i;
+		}
+
+		inputs.addPort<SyncPolicy>(policy, 1);
+		inputs.addPort<uint32_t>(tolerance, 1);
+		outputs.addPort<Aligned<Sample, Inputs>>(out);
+	}
+
+	virtual void initialize(void) override { return; }
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[policy].has_message())
+		{
+			auto value = inputs[policy].receive<SyncPolicy>();
+			if(value) m_policy = value.value();
+		}
+
+		if(inputs[tolerance].has_message())
+		{
+			auto value = inputs[tolerance].receive<uint32_t>();
+			if(value) m_tolerance = value.value();
+		}
+
+		// Buffering the next sample of any stream
+		auto index = await(m_ports, Inputs);
+		if(!index) return;
+
+		auto value = inputs[index.value()].template receive<Stamped<Sample>>();
+		if(!value) return;
+
+		m_streams[index.value()].push(value.value(), m_dropped);
+
+		// Emitting every reference sample that can be resolved
+		while(!m_streams[0].empty())
+		{
+			Aligned<Sample, Inputs> aligned;
+			const Stamped<Sample>&  reference = m_streams[0].front();
+
+			aligned.timestamp = reference.timestamp;
+			aligned.values[0] = reference.value;
+
+			const Resolution resolution = resolve(aligned);
+			if(resolution == Resolution::Wait) break;
+
+			m_streams[0].pop();
+
+			if(resolution == Resolution::Miss)
+			{
+				m_dropped++;
+				continue;
+			}
+
+			if(outputs[out].send<Aligned<Sample, Inputs>>(aligned) != MessageStatus::Okay) return;
+		}
+	}
+
+	/**
+	 * @brief  Queries the number of samples dropped by overflow or failed matching.
+	 */
+	unsigned dropped(void) const { return m_dropped; }
+
+private:
+
+	enum class Resolution { Ready, Wait, Miss };
+
+	/**
+	 * @brief Bounded buffer of a stream with the last consumed sample.
+	 */
+	struct Stream {
+
+		Stream(void) : head(0), size(0), has_last(false) { }
+
+		bool empty(void) const { return size == 0; }
+		bool full(void)  const { return size == MFLOW_SYNC_DEPTH; }
+
+		const Stamped<Sample>& front(void) const { return buffer[head]; }
+
+		void push(const Stamped<Sample>& sample, unsigned& dropped)
+		{
+			if(full())
+			{
+				pop();
+				dropped++;
+			}
+
+			buffer[(head + size++) % MFLOW_SYNC_DEPTH] = sample;
+		}
+
+		void pop(void)
+		{
+			head = (head + 1) % MFLOW_SYNC_DEPTH;
+			size--;
+		}
+
+		// Consumes the samples not newer than the timestamp, keeping the latest one
+		void advance(uint32_t timestamp)
+		{
+			while(!empty() && (int32_t) (front().timestamp - timestamp) <= 0)
+			{
+				last     = front();
+				has_last = true;
+				pop();
+			}
+		}
+
+		Stamped<Sample> buffer[MFLOW_SYNC_DEPTH];
+		unsigned        head;
+		unsigned        size;
+		Stamped<Sample> last;
+		bool            has_last;
+	};
+
+	Resolution resolve(Aligned<Sample, Inputs>& aligned)
+	{
+		const uint32_t target = aligned.timestamp;
+
+		// Buffers at capacity mean the streams still waited for are stalled
+		bool forced = false;
+		for(unsigned i = 0; i < Inputs; i++) forced = forced || m_streams[i].full();
+
+		for(unsigned i = 1; i < Inputs; i++)
+		{
+			Stream& stream = m_streams[i];
+
+			if(m_policy == SyncPolicy::Exact)
+			{
+				// Dropping the samples older than the tolerance window
+				while(!stream.empty() && (int32_t) (stream.front().timestamp - target) < -(int32_t) m_tolerance)
+				{
+					stream.pop();
+					m_dropped++;
+				}
+
+				if(stream.empty()) return forced ? Resolution::Miss : Resolution::Wait;
+				if((int32_t) (stream.front().timestamp - target) > (int32_t) m_tolerance) return Resolution::Miss;
+
+				aligned.values[i] = stream.front().value;
+				continue;
+			}
+
+			stream.advance(target);
+
+			if(stream.has_last && stream.last.timestamp == target)
+			{
+				aligned.values[i] = stream.last.value;
+			}
+			else if(!stream.empty())
+			{
+				// A newer sample exists, the value at the target is known
+				if(!stream.has_last) return Resolution::Miss;
+
+				aligned.values[i] = m_policy == SyncPolicy::Hold ? stream.last.value : interpolate(stream.last, stream.front(), target);
+			}
+			else if(forced && stream.has_last)
+			{
+				aligned.values[i] = stream.last.value;
+			}
+			else
+			{
+				return forced ? Resolution::Miss : Resolution::Wait;
+			}
+		}
+
+		// The matched samples are consumed, they would count as dropped at the next reference
+		if(m_policy == SyncPolicy::Exact)
+		{
+			for(unsigned i = 1; i < Inputs; i++) m_streams[i].pop();
+		}
+
+		return Resolution::Ready;
+	}
+
+	static Sample interpolate(const Stamped<Sample>& a, const Stamped<Sample>& b, uint32_t target)
+	{
+		typedef typename sample_traits<Sample>::accumulator accumulator;
+
+		const float       weight = (float) (target - a.timestamp) / (float) (b.timestamp - a.timestamp);
+		const accumulator wa     = sample_traits<Sample>::widen(a.value);
+		const accumulator wb     = sample_traits<Sample>::widen(b.value);
+
+		return sample_traits<Sample>::narrow((accumulator) (wa + (wb - wa) * weight));
+	}
+
+	unsigned   m_ports[Inputs];
+	Stream     m_streams[Inputs];
+	SyncPolicy m_policy;
+	uint32_t   m_tolerance;
+	unsigned   m_dropped;
+};
+
+#endif // MFLOW_COMPONENTS_SYNC_H_INCLUDED
@@ -0,0 +1,185 @@
+// Standard includes
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// Project includes
+#include "biquad.h"
+#include "frame.h"
+#include "os.h"
+#include "sample.h"
+#include "test.h"
+
+
+// Number of frames filtered in every case
+static constexpr std::size_t frames = 4;
+
+// Largest error of the outputs, the samples are compared in single precision and the fixed-point filter rounds its input and output
+static constexpr double max_error_float = 1e-6;
+static constexpr double max_error_fixed = 1e-4;
+
+/**
+ * @brief Sink collecting a given number of samples converted to double.
+ */
+template <class Sample>
+class Collector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	explicit Collector(std::size_t count) : m_count(count), m_done(false)
+	{
+		inputs.addPort<Frame<Sample>>(in, 4);
+		m_samples.reserve(count + Frame<Sample>::length);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].template receive<Frame<Sample>>();
+		if(!frame || m_done) return;
+
+		const Frame<Sample> value = frame.value();
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++) m_samples.push_back(sample_traits<Sample>::to_float(value.samples[i]));
+
+		if(m_samples.size() >= m_count) m_done = true;
+	}
+
+	bool                       done(void) const    { return m_done; }
+	const std::vector<double>& samples(void) const { return m_samples; }
+
+private:
+	std::size_t         m_count;
+	std::atomic<bool>   m_done;
+	std::vector<double> m_samples;
+};
+
+// A lowpass followed by a section with feedback of both signs
+static BiquadCoefficients make_coefficients(void)
+{
+	BiquadCoefficients coefficients;
+	coefficients.sections   = 2;
+	coefficients.section[0] = { 0.2f,  0.4f, 0.2f, -0.5f, 0.25f };
+	coefficients.section[1] = { 0.5f, -0.3f, 0.1f,  0.3f, 0.1f  };
+
+	return coefficients;
+}
+
+// Filters the input samples with the given number of interleaved channels
+template <class Sample>
+static std::vector<double> filter(const std::vector<double>& input, unsigned channels)
+{
+	BasicBiquadCascade<Sample> cascade;
+	Collector<Sample>          collector(input.size());
+	connect(cascade, BasicBiquadCascade<Sample>::out, collector, Collector<Sample>::in);
+
+	send_message(cascade.inputs[BasicBiquadCascade<Sample>::coefficients], make_coefficients());
+	send_message(cascade.inputs[BasicBiquadCascade<Sample>::channels], channels);
+
+	collector.start_process();
+	cascade.start_process();
+
+	for(std::size_t first = 0; first < input.size(); first += Frame<Sample>::length)
+	{
+		Frame<Sample> frame;
+		frame.sequence = (uint32_t) (first / Frame<Sample>::length);
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++) frame.samples[i] = sample_traits<Sample>::from_float((float) input[first + i]);
+
+		send_message(cascade.inputs[BasicBiquadCascade<Sample>::in], frame);
+	}
+
+	const os_tick_t start = os_tick_count();
+	while(!collector.done() && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	cascade.stop_process();
+	collector.stop_process();
+
+	while(cascade.is_running() || collector.is_running()) os_delay(1);
+
+	return collector.samples();
+}
+
+// Impulse response of the cascade computed with the direct form I difference equations
+static std::vector<double> impulse_response(std::size_t length)
+{
+	const BiquadCoefficients coefficients = make_coefficients();
+
+	std::vector<double> response(length, 0.0);
+	response[0] = 1.0;
+
+	for(unsigned s = 0; s < coefficients.sections; s++)
+	{
+		const BiquadSection& c = coefficients.section[s];
+		std::vector<double>  x = response;
+
+		for(std::size_t n = 0; n < length; n++)
+		{
+			double y = c.b0 * x[n];
+			if(n >= 1) y += c.b1 * x[n - 1] - c.a1 * response[n - 1];
+			if(n >= 2) y += c.b2 * x[n - 2] - c.a2 * response[n - 2];
+
+			response[n] = y;
+		}
+	}
+
+	return response;
+}
+
+// An impulse yields the impulse response of the cascade
+template <class Sample>
+static void test_impulse(double max_error)
+{
+	const std::size_t   length = frames * Frame<Sample>::length;
+	std::vector<double> input(length, 0.0);
+	input[0] = 0.5;
+
+	const std::vector<double> output    = filter<Sample>(input, 1);
+	const std::vector<double> reference = impulse_response(length);
+
+	MFLOW_CHECK(output.size() >= length);
+
+	double worst = 0.0;
+	for(std::size_t n = 0; n < length && n < output.size(); n++) worst = std::fmax(worst, std::fabs(output[n] - 0.5 * reference[n]));
+
+	MFLOW_CHECK(worst < max_error);
+}
+
+// Interleaved channels are filtered independently, the channel position carries over to the next frame
+template <class Sample>
+static void test_channels(double max_error)
+{
+	const unsigned      channels = 3;
+	const std::size_t   length   = frames * Frame<Sample>::length;
+	std::vector<double> input(length, 0.0);
+
+	for(unsigned c = 0; c < channels; c++) input[c] = 0.2 * (c + 1);
+
+	const std::vector<double> output    = filter<Sample>(input, channels);
+	const std::vector<double> reference = impulse_response(length / channels + 1);
+
+	MFLOW_CHECK(output.size() >= length);
+
+	double worst = 0.0;
+	for(std::size_t i = 0; i < length && i < output.size(); i++)
+	{
+		const double expected = 0.2 * (i % channels + 1) * reference[i / channels];
+		worst = std::fmax(worst, std::fabs(output[i] - expected));
+	}
+
+	MFLOW_CHECK(worst < max_error);
+}
+
+int main()
+{
+	test_impulse<double>(max_error_float);
+	test_impulse<float>(max_error_float);
+	test_impulse<q15>(max_error_fixed);
+
+	test_channels<double>(max_error_float);
+	test_channels<float>(max_error_float);
+	test_channels<q15>(max_error_fixed);
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,134 @@
+// Standard includes
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// Project includes
+#include "envelope.h"
+#include "frame.h"
+#include "os.h"
+#include "test.h"
+
+
+// Block length of the detector, blocks span the frame boundaries
+static constexpr unsigned block_length = 48;
+
+// Number of frames sent and the number of complete blocks in them
+static constexpr unsigned frames = 8;
+static constexpr unsigned blocks = frames * MFLOW_FRAME_LENGTH / block_length;
+
+// Amplitude of the test signal and the sample it stops at
+static constexpr double   amplitude = 0.8;
+static constexpr unsigned stop      = 120;
+
+// Time constants of the envelope in samples
+static constexpr float attack_time  = 10.0f;
+static constexpr float release_time = 30.0f;
+
+// Largest error of the outputs, the envelope is computed in single precision
+static constexpr double max_error = 1e-4;
+
+/**
+ * @brief Sink storing the received samples.
+ */
+class SampleCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	SampleCollector(void) : m_count(0)
+	{
+		inputs.addPort<double>(in, 4);
+		m_samples.reserve(blocks);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto sample = inputs[in].receive<double>();
+		if(!sample || m_samples.size() == m_samples.capacity()) return;
+
+		m_samples.push_back(sample.value());
+		m_count++;
+	}
+
+	unsigned                   count(void) const   { return m_count; }
+	const std::vector<double>& samples(void) const { return m_samples; }
+
+private:
+	std::vector<double>   m_samples;
+	std::atomic<unsigned> m_count;
+};
+
+// A square wave of the test amplitude up to the stop sample, then silence
+static double signal(unsigned n)
+{
+	return n < stop ? (n % 2 ? -amplitude : amplitude) : 0.0;
+}
+
+// The block RMS is the RMS of the square wave part of the block, the envelope rises and decays exponentially
+static void test_blocks(void)
+{
+	Envelope        envelope;
+	SampleCollector rms;
+	SampleCollector level;
+	connect(envelope, Envelope::rms, rms, SampleCollector::in);
+	connect(envelope, Envelope::envelope, level, SampleCollector::in);
+
+	send_message(envelope.inputs[Envelope::attack], attack_time);
+	send_message(envelope.inputs[Envelope::release], release_time);
+	send_message(envelope.inputs[Envelope::block], block_length);
+
+	rms.start_process();
+	level.start_process();
+	envelope.start_process();
+
+	for(unsigned f = 0; f < frames; f++)
+	{
+		Frame<double> frame;
+		frame.sequence = f;
+
+		for(std::size_t i = 0; i < Frame<double>::length; i++) frame[i] = signal(f * Frame<double>::length + i);
+
+		send_message(envelope.inputs[Envelope::in], frame);
+	}
+
+	const os_tick_t start = os_tick_count();
+	while((rms.count() < blocks || level.count() < blocks) && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+	os_delay(20);
+
+	envelope.stop_process();
+	rms.stop_process();
+	level.stop_process();
+
+	while(envelope.is_running() || rms.is_running() || level.is_running()) os_delay(1);
+
+	MFLOW_CHECK(rms.count() == blocks);
+	MFLOW_CHECK(level.count() == blocks);
+
+	for(unsigned b = 0; b < blocks && b < rms.samples().size() && b < level.samples().size(); b++)
+	{
+		const unsigned first = b * block_length;
+		const unsigned last  = first + block_length - 1;
+
+		// Fraction of the block carrying the square wave
+		const unsigned active   = last < stop ? block_length : first < stop ? stop - first : 0;
+		const double   expected = amplitude * std::sqrt((double) active / block_length);
+
+		// The envelope after the last sample of the block
+		const double peak     = amplitude * (1.0 - std::exp(-(double) stop / attack_time));
+		const double envelope = last < stop ? amplitude * (1.0 - std::exp(-(double) (last + 1) / attack_time))
+		                                    : peak * std::exp(-(double) (last + 1 - stop) / release_time);
+
+		MFLOW_CHECK(std::fabs(rms.samples()[b] - expected) < max_error);
+		MFLOW_CHECK(std::fabs(level.samples()[b] - envelope) < max_error);
+	}
+}
+
+int main()
+{
+	test_blocks();
+
+	return MFLOW_TEST_RESULT();
+}
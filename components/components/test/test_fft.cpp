@@ -0,0 +1,163 @@
+// Standard includes
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// Project includes
+#include "fft.h"
+#include "frame.h"
+#include "os.h"
+#include "test.h"
+
+
+typedef BasicFftAnalyzer<float> FftAnalyzer;
+
+// Transform size of the magnitude checks
+static constexpr unsigned size = 64;
+
+// Bin of the test sine and its amplitude
+static constexpr unsigned tone      = 5;
+static constexpr double   amplitude = 0.5;
+
+// Largest error of the bins relative to the peak of a rectangular window
+static constexpr double max_error = 1e-4;
+
+static const double pi = 3.141592653589793;
+
+/**
+ * @brief Sink storing the received spectra.
+ */
+class SpectrumCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	SpectrumCollector(void) : m_count(0)
+	{
+		inputs.addPort<Spectrum>(in, 16);
+		m_spectra.reserve(64);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto spectrum = inputs[in].receive<Spectrum>();
+		if(!spectrum || m_spectra.size() == m_spectra.capacity()) return;
+
+		m_spectra.push_back(spectrum.value());
+		m_count++;
+	}
+
+	unsigned                     count(void) const   { return m_count; }
+	const std::vector<Spectrum>& spectra(void) const { return m_spectra; }
+
+private:
+	std::vector<Spectrum> m_spectra;
+	std::atomic<unsigned> m_count;
+};
+
+// Sends a sine of whole bins of the test size, continuing from a sample index
+static void send_tone(FftAnalyzer& analyzer, unsigned frames, unsigned first)
+{
+	for(unsigned f = 0; f < frames; f++)
+	{
+		Frame<float> frame;
+		frame.sequence = first / Frame<float>::length + f;
+
+		for(std::size_t i = 0; i < Frame<float>::length; i++)
+		{
+			const double n = first + f * Frame<float>::length + i;
+			frame.samples[i] = (float) (amplitude * std::sin(2.0 * pi * tone * n / size));
+		}
+
+		send_message(analyzer.inputs[FftAnalyzer::in], frame);
+	}
+}
+
+static void wait_for(const SpectrumCollector& collector, unsigned count)
+{
+	const os_tick_t start = os_tick_count();
+	while(collector.count() < count && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+}
+
+static void stop(FftAnalyzer& analyzer, SpectrumCollector& collector)
+{
+	analyzer.stop_process();
+	collector.stop_process();
+
+	while(analyzer.is_running() || collector.is_running()) os_delay(1);
+}
+
+// A bin-centred sine peaks in its bin, with half the size times the amplitude times the window mean
+static void test_magnitude(unsigned window, double mean, double neighbour)
+{
+	FftAnalyzer       analyzer;
+	SpectrumCollector collector;
+	connect(analyzer, FftAnalyzer::out, collector, SpectrumCollector::in);
+
+	send_message(analyzer.inputs[FftAnalyzer::size], size);
+	send_message(analyzer.inputs[FftAnalyzer::window], window);
+
+	collector.start_process();
+	analyzer.start_process();
+
+	send_tone(analyzer, size / Frame<float>::length, 0);
+	wait_for(collector, 1);
+
+	stop(analyzer, collector);
+
+	MFLOW_CHECK(collector.count() == 1);
+	if(collector.count() == 0) return;
+
+	const Spectrum& spectrum = collector.spectra()[0];
+	const double    peak     = amplitude * size / 2;
+
+	MFLOW_CHECK(spectrum.bins == size / 2 + 1);
+	MFLOW_CHECK(spectrum.format == FftFormatMagnitude);
+
+	for(unsigned k = 0; k < spectrum.bins; k++)
+	{
+		const double expected = k == tone ? peak * mean : k + 1 == tone || k == tone + 1 ? peak * neighbour : 0.0;
+		MFLOW_CHECK(std::fabs(spectrum.values[k] - expected) < max_error * peak);
+	}
+}
+
+// Changing the size scales the hop, a quarter hop stays a quarter of the new size
+static void test_resize(void)
+{
+	FftAnalyzer       analyzer;
+	SpectrumCollector collector;
+	connect(analyzer, FftAnalyzer::out, collector, SpectrumCollector::in);
+
+	send_message(analyzer.inputs[FftAnalyzer::size], size);
+	send_message(analyzer.inputs[FftAnalyzer::hop], size / 4);
+
+	collector.start_process();
+	analyzer.start_process();
+
+	// The hop is applied before the first frame, the new size after it
+	const os_tick_t start = os_tick_count();
+	while(analyzer.inputs[FftAnalyzer::hop].message_count() > 0 && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	send_message(analyzer.inputs[FftAnalyzer::size], 2 * size);
+	send_tone(analyzer, 1 + 8, 0);
+
+	// Blocks of the new size end every 32 samples from sample 128 of the 256 after the resize
+	wait_for(collector, 5);
+	os_delay(20);
+
+	stop(analyzer, collector);
+
+	MFLOW_CHECK(collector.count() == 5);
+	for(const Spectrum& spectrum : collector.spectra()) MFLOW_CHECK(spectrum.bins == size + 1);
+}
+
+int main()
+{
+	test_magnitude(FftWindowRectangular, 1.0, 0.0);
+	test_magnitude(FftWindowHann, 0.5, 0.25);
+	test_resize();
+
+	return MFLOW_TEST_RESULT();
+}
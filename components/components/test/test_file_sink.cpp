@@ -0,0 +1,215 @@
+// Standard includes
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Linux includes
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Project includes
+#include "host/file_sink.h"
+#include "os.h"
+#include "test.h"
+
+
+// The test targets use small buffers, so a run spans many writes
+static_assert(MFLOW_FILE_SINK_BUFFER_SIZE % sizeof(Frame<double>::samples) == 0, "A buffer must hold whole frames.");
+
+// Bytes of the samples of a frame
+static constexpr std::size_t frame_bytes = sizeof(Frame<double>::samples);
+
+// Number of frames recorded, the last buffer is only partially filled
+static constexpr uint32_t frames = 64 * MFLOW_FILE_SINK_BUFFER_SIZE / frame_bytes + 1;
+
+static Frame<double> make_frame(uint32_t sequence)
+{
+	Frame<double> frame;
+	frame.sequence = sequence;
+	for(std::size_t i = 0; i < Frame<double>::length; i++) frame.samples[i] = sequence * 1000.0 + i;
+
+	return frame;
+}
+
+static FileSinkConfig make_config(const char* path)
+{
+	FileSinkConfig config;
+	std::memset(&config, 0, sizeof(config));
+	std::snprintf(config.path, sizeof(config.path), "%s", path);
+
+	return config;
+}
+
+// Creates an empty temporary file, returns false on failure
+static bool create_file(char* path)
+{
+	const int fd = mkstemp(path);
+	if(fd < 0) return false;
+
+	close(fd);
+	return true;
+}
+
+static std::vector<uint8_t> read_file(const char* path)
+{
+	std::vector<uint8_t> contents;
+
+	FILE* file = std::fopen(path, "rb");
+	if(file == nullptr) return contents;
+
+	uint8_t block[4096];
+	std::size_t count;
+	while((count = std::fread(block, 1, sizeof(block), file)) > 0) contents.insert(contents.end(), block, block + count);
+
+	std::fclose(file);
+	return contents;
+}
+
+static void wait_empty(const InputPort& port)
+{
+	const os_tick_t start = os_tick_count();
+	while(port.message_count() > 0 && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+}
+
+// Stops the sink once it took every queued frame, stopping writes the partial buffer
+static void stop(FileSink& sink)
+{
+	// The flush is taken only after the last frame was copied into a buffer
+	wait_empty(sink.inputs[FileSink::frame_in]);
+	send_message(sink.inputs[FileSink::flush], true);
+	wait_empty(sink.inputs[FileSink::flush]);
+
+	sink.stop_process();
+	while(sink.is_running()) os_delay(1);
+}
+
+// Every frame is either in the file, in order and complete, or counted as dropped
+static void test_record(void)
+{
+	char path[] = "/tmp/mflow_sink_XXXXXX";
+	MFLOW_CHECK(create_file(path));
+
+	FileSink sink;
+	send_message(sink.inputs[FileSink::config], make_config(path));
+	sink.start_process();
+
+	for(uint32_t i = 0; i < frames; i++) send_message(sink.inputs[FileSink::frame_in], make_frame(i));
+
+	// Stopping waits for the writes in flight
+	stop(sink);
+
+	const std::vector<uint8_t> contents = read_file(path);
+	unlink(path);
+
+	MFLOW_CHECK(sink.errors() == 0);
+	MFLOW_CHECK(contents.size() == sink.written());
+	MFLOW_CHECK(sink.written() + sink.dropped() * sizeof(double) == (uint64_t) frames * frame_bytes);
+	MFLOW_CHECK(contents.size() % frame_bytes == 0);
+
+	// The recorded frames are complete and in order
+	unsigned wrong    = 0;
+	double   previous = -1.0;
+
+	for(std::size_t offset = 0; offset + frame_bytes <= contents.size(); offset += frame_bytes)
+	{
+		double samples[Frame<double>::length];
+		std::memcpy(samples, contents.data() + offset, frame_bytes);
+
+		if(samples[0] <= previous) wrong++;
+		for(std::size_t i = 0; i < Frame<double>::length; i++) if(samples[i] != samples[0] + i) wrong++;
+
+		previous = samples[0];
+	}
+
+	MFLOW_CHECK(wrong == 0);
+}
+
+// A flush writes the partially filled buffer while the sink keeps running
+static void test_flush(void)
+{
+	char path[] = "/tmp/mflow_sink_XXXXXX";
+	MFLOW_CHECK(create_file(path));
+
+	FileSink sink;
+	send_message(sink.inputs[FileSink::config], make_config(path));
+	sink.start_process();
+
+	send_message(sink.inputs[FileSink::frame_in], make_frame(0));
+	wait_empty(sink.inputs[FileSink::frame_in]);
+	send_message(sink.inputs[FileSink::flush], true);
+
+	const os_tick_t start = os_tick_count();
+	struct stat     status;
+	while((stat(path, &status) != 0 || status.st_size < (off_t) frame_bytes) && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	MFLOW_CHECK(status.st_size == (off_t) frame_bytes);
+
+	stop(sink);
+	unlink(path);
+
+	MFLOW_CHECK(sink.written() == frame_bytes);
+	MFLOW_CHECK(sink.dropped() == 0);
+}
+
+// A write cut short by the file size limit is continued with the rest of the buffer
+static void test_short_write(void)
+{
+	char path[] = "/tmp/mflow_sink_XXXXXX";
+	MFLOW_CHECK(create_file(path));
+
+	// Limiting the file inside the first buffer, the continuation fails
+	const rlim_t limit = MFLOW_FILE_SINK_BUFFER_SIZE - 24;
+
+	struct rlimit previous;
+	getrlimit(RLIMIT_FSIZE, &previous);
+
+	struct rlimit reduced = previous;
+	reduced.rlim_cur      = limit;
+
+	std::signal(SIGXFSZ, SIG_IGN);
+	MFLOW_CHECK(setrlimit(RLIMIT_FSIZE, &reduced) == 0);
+
+	FileSink sink;
+	send_message(sink.inputs[FileSink::config], make_config(path));
+	sink.start_process();
+
+	// Two full buffers, the first is written short, the second fails
+	const uint32_t count = 2 * MFLOW_FILE_SINK_BUFFER_SIZE / frame_bytes;
+	for(uint32_t i = 0; i < count; i++) send_message(sink.inputs[FileSink::frame_in], make_frame(i));
+
+	stop(sink);
+	setrlimit(RLIMIT_FSIZE, &previous);
+
+	const std::vector<uint8_t> contents = read_file(path);
+	unlink(path);
+
+	MFLOW_CHECK(sink.written() == limit);
+	MFLOW_CHECK(contents.size() == limit);
+	MFLOW_CHECK(sink.errors() == 2);
+	MFLOW_CHECK(sink.dropped() == 0);
+
+	// The short write kept the samples it wrote
+	unsigned wrong = 0;
+	for(std::size_t offset = 0; offset + sizeof(double) <= contents.size(); offset += sizeof(double))
+	{
+		const std::size_t index = offset / sizeof(double);
+
+		double sample;
+		std::memcpy(&sample, contents.data() + offset, sizeof(sample));
+		if(sample != (index / Frame<double>::length) * 1000.0 + index % Frame<double>::length) wrong++;
+	}
+	MFLOW_CHECK(wrong == 0);
+}
+
+int main()
+{
+	test_record();
+	test_flush();
+	test_short_write();
+
+	return MFLOW_TEST_RESULT();
+}
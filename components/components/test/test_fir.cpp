@@ -0,0 +1,211 @@
+// Standard includes
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <initializer_list>
+#include <random>
+#include <vector>
+
+// Project includes
+#include "fir.h"
+#include "frame.h"
+#include "os.h"
+#include "sample.h"
+#include "test.h"
+
+
+// Number of input samples filtered in every case
+static constexpr std::size_t input_samples = 8 * MFLOW_FRAME_LENGTH;
+
+// Largest error of the outputs, the fixed-point filters round their taps, samples and products
+static constexpr double max_error_float = 1e-6;
+static constexpr double max_error_fixed = 2e-3;
+
+/**
+ * @brief Sink collecting a given number of samples converted to float.
+ */
+template <class Sample>
+class Collector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	explicit Collector(std::size_t count) : m_count(count), m_done(false)
+	{
+		inputs.addPort<Frame<Sample>>(in, 4);
+		m_samples.reserve(count + Frame<Sample>::length);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].template receive<Frame<Sample>>();
+		if(!frame || m_done) return;
+
+		const Frame<Sample> value = frame.value();
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++) m_samples.push_back(sample_traits<Sample>::to_float(value.samples[i]));
+
+		if(m_samples.size() >= m_count) m_done = true;
+	}
+
+	bool                      done(void) const    { return m_done; }
+	const std::vector<float>& samples(void) const { return m_samples; }
+
+private:
+	std::size_t        m_count;
+	std::atomic<bool>  m_done;
+	std::vector<float> m_samples;
+};
+
+// Random samples within a range, the same sequence for every case
+static std::vector<float> make_input(float range)
+{
+	std::mt19937                          generator(1234);
+	std::uniform_real_distribution<float> distribution(-range, range);
+
+	std::vector<float> input(input_samples);
+	for(float& sample : input) sample = distribution(generator);
+
+	return input;
+}
+
+static FirTaps make_taps(std::initializer_list<float> values)
+{
+	FirTaps taps;
+	taps.count = 0;
+	for(float value : values) taps.taps[taps.count++] = value;
+
+	return taps;
+}
+
+// Runs a rate changing filter on the input, returns the collected output samples
+template <class Filter, class Sample>
+static std::vector<float> filter(unsigned factor, const FirTaps& taps, const std::vector<float>& input, std::size_t outputs)
+{
+	Filter            fir;
+	Collector<Sample> collector(outputs);
+	connect(fir, Filter::out, collector, Collector<Sample>::in);
+
+	send_message(fir.inputs[Filter::factor], factor);
+	send_message(fir.inputs[Filter::taps], taps);
+
+	collector.start_process();
+	fir.start_process();
+
+	for(std::size_t first = 0; first < input.size(); first += Frame<Sample>::length)
+	{
+		Frame<Sample> frame;
+		frame.sequence = (uint32_t) (first / Frame<Sample>::length);
+
+		for(std::size_t i = 0; i < Frame<Sample>::length; i++) frame.samples[i] = sample_traits<Sample>::from_float(input[first + i]);
+
+		send_message(fir.inputs[Filter::in], frame);
+	}
+
+	const os_tick_t start = os_tick_count();
+	while(!collector.done() && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	fir.stop_process();
+	collector.stop_process();
+
+	while(fir.is_running() || collector.is_running()) os_delay(1);
+
+	return collector.samples();
+}
+
+// Largest difference of the outputs from the reference, infinite if samples are missing
+static double max_difference(const std::vector<float>& output, const std::vector<double>& reference)
+{
+	if(output.size() < reference.size()) return INFINITY;
+
+	double worst = 0.0;
+	for(std::size_t i = 0; i < reference.size(); i++) worst = std::fmax(worst, std::fabs(output[i] - reference[i]));
+
+	return worst;
+}
+
+// The kept outputs are the full-rate convolution at every factor-th input sample
+static std::vector<double> decimate(unsigned factor, const FirTaps& taps, const std::vector<float>& input)
+{
+	std::vector<double> output(input.size() / factor);
+
+	for(std::size_t k = 0; k < output.size(); k++)
+	{
+		const std::size_t n = k * factor + factor - 1;
+
+		double sum = 0.0;
+		for(unsigned j = 0; j < taps.count && j <= n; j++) sum += taps.taps[j] * input[n - j];
+
+		output[k] = sum;
+	}
+
+	return output;
+}
+
+// The outputs are the convolution of the zero-stuffed input, scaled by the factor
+static std::vector<double> interpolate(unsigned factor, const FirTaps& taps, const std::vector<float>& input)
+{
+	std::vector<double> output(input.size() * factor);
+
+	for(std::size_t m = 0; m < output.size(); m++)
+	{
+		double sum = 0.0;
+		for(unsigned k = 0; k < taps.count && k <= m; k++)
+		{
+			if((m - k) % factor == 0) sum += taps.taps[k] * input[(m - k) / factor];
+		}
+
+		output[m] = factor * sum;
+	}
+
+	return output;
+}
+
+template <class Sample>
+static void test_decimator(double max_error)
+{
+	typedef BasicFirDecimator<Sample> Decimator;
+
+	const std::vector<float> input = make_input(0.25f);
+	const FirTaps            taps  = make_taps({ 0.1f, 0.2f, 0.3f, 0.2f, 0.1f });
+
+	const std::vector<float> output = filter<Decimator, Sample>(2, taps, input, input.size() / 2);
+	MFLOW_CHECK(max_difference(output, decimate(2, taps, input)) < max_error);
+
+	// Without taps every factor-th sample is passed through
+	const FirTaps            none    = make_taps({ });
+	const std::vector<float> through = filter<Decimator, Sample>(4, none, input, input.size() / 4);
+	MFLOW_CHECK(max_difference(through, decimate(4, make_taps({ 1.0f }), input)) < max_error);
+}
+
+template <class Sample>
+static void test_interpolator(double max_error)
+{
+	typedef BasicFirInterpolator<Sample> Interpolator;
+
+	// The centre tap exceeds the reciprocal of the factor, scaled taps would saturate fixed-point samples
+	const std::vector<float> input = make_input(0.1f);
+	const FirTaps            taps  = make_taps({ 0.1f, 0.3f, 0.6f, 0.3f, 0.1f, -0.05f, 0.05f });
+
+	const std::vector<float> output = filter<Interpolator, Sample>(3, taps, input, input.size() * 3);
+	MFLOW_CHECK(max_difference(output, interpolate(3, taps, input)) < max_error);
+
+	// Without taps every input sample is repeated, a unit tap per subfilter
+	const FirTaps            none     = make_taps({ });
+	const std::vector<float> repeated = filter<Interpolator, Sample>(3, none, input, input.size() * 3);
+	MFLOW_CHECK(max_difference(repeated, interpolate(3, make_taps({ 1.0f / 3, 1.0f / 3, 1.0f / 3 }), input)) < max_error);
+}
+
+int main()
+{
+	test_decimator<double>(max_error_float);
+	test_decimator<float>(max_error_float);
+	test_decimator<q15>(max_error_fixed);
+
+	test_interpolator<double>(max_error_float);
+	test_interpolator<float>(max_error_float);
+	test_interpolator<q15>(max_error_fixed);
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,128 @@
+// Standard includes
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// Project includes
+#include "frame.h"
+#include "goertzel.h"
+#include "os.h"
+#include "test.h"
+
+
+// Number of samples in a detection block and the number of blocks sent
+static constexpr unsigned block_length = 256;
+static constexpr unsigned blocks       = 2;
+
+// Tolerance of the tone amplitudes relative to the amplitude, the tone between bins leaks into the
+// other filters, and the largest reading of an absent tone
+static constexpr double max_error   = 0.05;
+static constexpr double max_leakage = 0.02;
+
+static const double pi = 3.141592653589793;
+
+/**
+ * @brief Sink storing the received magnitudes.
+ */
+class MagnitudeCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	MagnitudeCollector(void) : m_count(0)
+	{
+		inputs.addPort<ToneMagnitudes>(in, 4);
+		m_records.reserve(blocks);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto record = inputs[in].receive<ToneMagnitudes>();
+		if(!record || m_records.size() == m_records.capacity()) return;
+
+		m_records.push_back(record.value());
+		m_count++;
+	}
+
+	unsigned                           count(void) const   { return m_count; }
+	const std::vector<ToneMagnitudes>& records(void) const { return m_records; }
+
+private:
+	std::vector<ToneMagnitudes> m_records;
+	std::atomic<unsigned>       m_count;
+};
+
+// Sines of the listed tones read their amplitudes, other tones read low
+static void test_tones(void)
+{
+	// A tone on a bin of the block and one between bins
+	const double frequency[] = { 16.0 / block_length, 0.1 };
+	const double amplitude[] = { 0.4, 0.25 };
+
+	// The present tones, a tone two bins from the first one and a distant tone
+	ToneList list;
+	list.count        = 4;
+	list.frequency[0] = (float) frequency[0];
+	list.frequency[1] = (float) frequency[1];
+	list.frequency[2] = 18.0f / block_length;
+	list.frequency[3] = 0.3f;
+
+	const double expected[] = { amplitude[0], amplitude[1], 0.0, 0.0 };
+
+	GoertzelBank       bank;
+	MagnitudeCollector collector;
+	connect(bank, GoertzelBank::out, collector, MagnitudeCollector::in);
+
+	send_message(bank.inputs[GoertzelBank::tones], list);
+	send_message(bank.inputs[GoertzelBank::block], block_length);
+
+	collector.start_process();
+	bank.start_process();
+
+	for(unsigned f = 0; f < blocks * block_length / Frame<double>::length; f++)
+	{
+		Frame<double> frame;
+		frame.sequence = f;
+
+		for(std::size_t i = 0; i < Frame<double>::length; i++)
+		{
+			const double n = f * Frame<double>::length + i;
+			frame[i] = amplitude[0] * std::sin(2.0 * pi * frequency[0] * n + 0.3) + amplitude[1] * std::cos(2.0 * pi * frequency[1] * n);
+		}
+
+		send_message(bank.inputs[GoertzelBank::in], frame);
+	}
+
+	const os_tick_t start = os_tick_count();
+	while(collector.count() < blocks && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	bank.stop_process();
+	collector.stop_process();
+
+	while(bank.is_running() || collector.is_running()) os_delay(1);
+
+	MFLOW_CHECK(collector.count() == blocks);
+
+	for(unsigned b = 0; b < collector.records().size(); b++)
+	{
+		const ToneMagnitudes& record = collector.records()[b];
+
+		MFLOW_CHECK(record.sequence == b);
+		MFLOW_CHECK(record.count == list.count);
+
+		for(unsigned t = 0; t < list.count; t++)
+		{
+			if(expected[t] > 0.0) MFLOW_CHECK(std::fabs(record.magnitude[t] - expected[t]) < max_error * expected[t]);
+			else MFLOW_CHECK(record.magnitude[t] < max_leakage);
+		}
+	}
+}
+
+int main()
+{
+	test_tones();
+
+	return MFLOW_TEST_RESULT();
+}
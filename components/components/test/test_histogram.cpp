@@ -0,0 +1,144 @@
+// Standard includes
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// Project includes
+#include "frame.h"
+#include "histogram.h"
+#include "os.h"
+#include "test.h"
+
+
+// Number of frames sent in every case
+static constexpr unsigned frames = 4;
+
+// Bin index of the underflow counter in the expected values, the overflow counter follows the last bin
+static constexpr int underflow = -1;
+
+/**
+ * @brief Sink storing the received histograms.
+ */
+class HistogramCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	HistogramCollector(void) : m_count(0)
+	{
+		inputs.addPort<Histogram>(in, 4);
+		m_histograms.reserve(frames * MFLOW_FRAME_LENGTH);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto histogram = inputs[in].receive<Histogram>();
+		if(!histogram || m_histograms.size() == m_histograms.capacity()) return;
+
+		m_histograms.push_back(histogram.value());
+		m_count++;
+	}
+
+	unsigned                      count(void) const      { return m_count; }
+	const std::vector<Histogram>& histograms(void) const { return m_histograms; }
+
+private:
+	std::vector<Histogram> m_histograms;
+	std::atomic<unsigned>  m_count;
+};
+
+/**
+ * @brief A test sample and the bin it is counted in.
+ */
+struct Binned {
+	double value;
+	int    bin;
+};
+
+// Sends the samples repeated over the frames, every period must hold the counts of its samples
+static void check(const HistogramConfig& config, const std::vector<Binned>& samples)
+{
+	HistogramAccumulator histogram;
+	HistogramCollector   collector;
+	connect(histogram, HistogramAccumulator::out, collector, HistogramCollector::in);
+
+	send_message(histogram.inputs[HistogramAccumulator::config], config);
+
+	collector.start_process();
+	histogram.start_process();
+
+	for(unsigned f = 0; f < frames; f++)
+	{
+		Frame<double> frame;
+		frame.sequence = f;
+
+		for(std::size_t i = 0; i < Frame<double>::length; i++) frame[i] = samples[(f * Frame<double>::length + i) % samples.size()].value;
+
+		send_message(histogram.inputs[HistogramAccumulator::frame_in], frame);
+	}
+
+	// Periods end within the frames, the samples after the last period are not emitted
+	const unsigned  periods = frames * Frame<double>::length / config.period;
+	const os_tick_t start   = os_tick_count();
+	while(collector.count() < periods && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+	os_delay(20);
+
+	histogram.stop_process();
+	collector.stop_process();
+
+	while(histogram.is_running() || collector.is_running()) os_delay(1);
+
+	MFLOW_CHECK(collector.count() == periods);
+
+	for(unsigned p = 0; p < collector.histograms().size(); p++)
+	{
+		const Histogram& record = collector.histograms()[p];
+
+		std::vector<uint32_t> expected(config.bins + 2, 0);
+		for(unsigned n = p * config.period; n < (p + 1) * config.period; n++) expected[samples[n % samples.size()].bin + 1]++;
+
+		MFLOW_CHECK(record.sequence == p);
+		MFLOW_CHECK(record.count == config.period);
+		MFLOW_CHECK(record.bins == config.bins);
+		MFLOW_CHECK(record.underflow == expected[0]);
+		MFLOW_CHECK(record.overflow == expected[config.bins + 1]);
+
+		unsigned wrong = 0;
+		for(unsigned b = 0; b < config.bins; b++) if(record.counts[b] != expected[b + 1]) wrong++;
+		MFLOW_CHECK(wrong == 0);
+	}
+}
+
+// Linear bins of unit width, lower edges belong to their bin and the maximum overflows
+static void test_linear(void)
+{
+	const HistogramConfig config = { HistogramScale::Linear, 0.0f, 8.0f, 8U, 20U };
+
+	check(config, {
+		{ 0.0, 0 }, { 0.5, 0 }, { 1.0, 1 }, { 1.5, 1 }, { 2.0, 2 }, { 2.9, 2 }, { 3.0, 3 }, { 4.0, 4 },
+		{ 5.5, 5 }, { 6.0, 6 }, { 7.0, 7 }, { 7.9, 7 }, { 8.0, 8 }, { 9.0, 8 },
+		{ -0.1, underflow }, { -5.0, underflow }, { NAN, underflow }
+	});
+}
+
+// Octave bins, samples that are not positive underflow
+static void test_logarithmic(void)
+{
+	const HistogramConfig config = { HistogramScale::Logarithmic, 1.0f, 256.0f, 8U, 32U };
+
+	check(config, {
+		{ 1.0, 0 }, { 1.5, 0 }, { 2.0, 1 }, { 3.0, 1 }, { 4.0, 2 }, { 8.0, 3 }, { 16.0, 4 }, { 100.0, 6 },
+		{ 200.0, 7 }, { 255.0, 7 }, { 256.0, 8 }, { 1000.0, 8 },
+		{ 0.5, underflow }, { 0.0, underflow }, { -1.0, underflow }, { NAN, underflow }
+	});
+}
+
+int main()
+{
+	test_linear();
+	test_logarithmic();
+
+	return MFLOW_TEST_RESULT();
+}
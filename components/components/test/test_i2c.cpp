@@ -0,0 +1,390 @@
+// Standard includes
+#include <atomic>
+#include <cstdint>
+
+// Project includes
+#include "i2c/i2c.h"
+#include "i2c/i2c_poller.h"
+#include "os.h"
+#include "test.h"
+
+
+// Bus address of the simulated register device
+static constexpr uint8_t device_address = 0x48;
+
+// Bus address without a device
+static constexpr uint8_t absent_address = 0x49;
+
+// Number of asynchronous chains issued, several times the pool size
+static constexpr unsigned async_chains = 4 * MFLOW_I2C_POOL_SIZE;
+
+/**
+ * @brief Simulated device with 16 registers, the first written byte selects the register.
+ */
+class RegisterDevice : public I2C_MockDevice {
+public:
+
+	RegisterDevice(void) : m_pointer(0), m_selecting(false), m_delay_ms(0), m_transactions(0)
+	{
+		for(unsigned i = 0; i < 16; i++) m_registers[i] = (uint8_t) (0x10 + i);
+	}
+
+	virtual bool start(bool read) override
+	{
+		if(m_delay_ms > 0) os_delay(m_delay_ms);
+		m_selecting = !read;
+		return true;
+	}
+
+	virtual bool write(uint8_t byte) override
+	{
+		if(m_selecting) m_pointer = byte & 0x0F;
+		else            m_registers[m_pointer++ & 0x0F] = byte;
+
+		m_selecting = false;
+		return true;
+	}
+
+	virtual uint8_t read(void) override
+	{
+		return m_registers[m_pointer++ & 0x0F];
+	}
+
+	virtual void stop(void) override
+	{
+		m_transactions++;
+	}
+
+	void     set_delay(uint32_t milliseconds) { m_delay_ms = milliseconds; }
+	unsigned transactions(void) const         { return m_transactions; }
+
+private:
+	uint8_t               m_registers[16];
+	uint8_t               m_pointer;
+	bool                  m_selecting;
+	std::atomic<uint32_t> m_delay_ms;
+	std::atomic<unsigned> m_transactions;
+};
+
+/**
+ * @brief Sink collecting the completions of asynchronous chains.
+ */
+class CompletionCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	CompletionCollector(void) : m_count(0), m_disorder(0), m_failed(0), m_wrong(0)
+	{
+		inputs.addPort<I2C_Completion>(in, 4);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto completion = inputs[in].receive<I2C_Completion>();
+		if(!completion) return;
+
+		const I2C_Completion& value = completion.value();
+
+		// The chains are executed in order, odd tags address the absent device
+		if(value.tag != m_count) m_disorder++;
+
+		if(value.tag % 2 == 0)
+		{
+			if(!value.status) m_failed++;
+			if(value.length != 2 || value.data[0] != (uint8_t) (0x10 + value.tag % 16) || value.data[1] != (uint8_t) (0x10 + (value.tag + 1) % 16)) m_wrong++;
+		}
+		else if(value.status) m_wrong++;
+
+		m_count++;
+	}
+
+	unsigned count(void) const    { return m_count; }
+	unsigned disorder(void) const { return m_disorder; }
+	unsigned failed(void) const   { return m_failed; }
+	unsigned wrong(void) const    { return m_wrong; }
+
+private:
+	std::atomic<unsigned> m_count;
+	std::atomic<unsigned> m_disorder;
+	std::atomic<unsigned> m_failed;
+	std::atomic<unsigned> m_wrong;
+};
+
+/**
+ * @brief Sink keeping the last value and the number of values of every poller channel.
+ */
+class ChannelSink : public Component {
+public:
+
+	static constexpr unsigned channels = 4U;
+
+	ChannelSink(void)
+	{
+		for(unsigned c = 0; c < channels; c++)
+		{
+			inputs.addPort<float>(c, 8);
+			m_ports[c]  = c;
+			m_counts[c] = 0;
+			m_values[c] = 0.0f;
+		}
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto index = await(m_ports, channels);
+		if(!index) return;
+
+		auto value = inputs[index.value()].receive<float>();
+		if(!value) return;
+
+		m_values[index.value()] = value.value();
+		m_counts[index.value()]++;
+	}
+
+	unsigned count(unsigned channel) const { return m_counts[channel]; }
+	float    value(unsigned channel) const { return m_values[channel]; }
+
+private:
+	unsigned              m_ports[channels];
+	std::atomic<unsigned> m_counts[channels];
+	std::atomic<float>    m_values[channels];
+};
+
+// Queues reading two registers starting at the specified one
+static void queue_register_read(I2C_CommandChain* chain, uint8_t address, uint8_t reg)
+{
+	chain->queue_start();
+	chain->queue_write_byte((uint8_t) (address << 1) | I2C_MASTER_WRITE);
+	chain->queue_write_byte(reg);
+	chain->queue_start();
+	chain->queue_write_byte((uint8_t) (address << 1) | I2C_MASTER_READ);
+	chain->queue_read(2);
+	chain->queue_stop();
+}
+
+static void configure(I2C_Master& master)
+{
+	send_message(master.inputs[I2C_Master::port], 0U);
+	send_message(master.inputs[I2C_Master::sda_pin], 21U);
+	send_message(master.inputs[I2C_Master::scl_pin], 22U);
+	send_message(master.inputs[I2C_Master::speed_hz], 400000U);
+}
+
+// A synchronous chain returns the read bytes to its issuer, and chains return to the pool
+static void test_synchronous(I2C_Master& master, RegisterDevice& device)
+{
+	I2C_CommandPool& pool = I2C_CommandPool::shared();
+
+	I2C_CommandChain* chain = pool.acquire();
+	MFLOW_CHECK(chain != nullptr);
+	MFLOW_CHECK(pool.available() == MFLOW_I2C_POOL_SIZE - 1);
+
+	// Writing two registers, then reading them back in the same chain
+	const uint8_t data[] = { 0x05, 0xA5, 0x5A };
+	chain->queue_start();
+	chain->queue_write_byte((uint8_t) (device_address << 1) | I2C_MASTER_WRITE);
+	chain->queue_write(data, sizeof(data));
+	chain->queue_stop();
+	queue_register_read(chain, device_address, 0x05);
+
+	send_message(master.inputs[I2C_Master::command], chain);
+	MFLOW_CHECK(chain->wait_for_execute());
+	MFLOW_CHECK(chain->read_length() == 2);
+	MFLOW_CHECK(chain->read_data()[0] == 0xA5 && chain->read_data()[1] == 0x5A);
+	chain->release();
+
+	// Restoring the registers for the asynchronous test
+	chain = pool.acquire();
+	const uint8_t restore[] = { 0x05, 0x15, 0x16 };
+	chain->queue_start();
+	chain->queue_write_byte((uint8_t) (device_address << 1) | I2C_MASTER_WRITE);
+	chain->queue_write(restore, sizeof(restore));
+	chain->queue_stop();
+	send_message(master.inputs[I2C_Master::command], chain);
+	MFLOW_CHECK(chain->wait_for_execute());
+	chain->release();
+
+	// Addressing the absent device fails
+	chain = pool.acquire();
+	queue_register_read(chain, absent_address, 0x00);
+	send_message(master.inputs[I2C_Master::command], chain);
+	MFLOW_CHECK(!chain->wait_for_execute());
+	chain->release();
+
+	// Overflowing the read buffer rejects the chain without executing it
+	const unsigned before = device.transactions();
+	chain = pool.acquire();
+	chain->queue_start();
+	chain->queue_write_byte((uint8_t) (device_address << 1) | I2C_MASTER_READ);
+	chain->queue_read(MFLOW_I2C_MAX_READ);
+	chain->queue_read(1);
+	chain->queue_stop();
+	send_message(master.inputs[I2C_Master::command], chain);
+	MFLOW_CHECK(!chain->wait_for_execute());
+	MFLOW_CHECK(device.transactions() == before);
+	chain->release();
+
+	MFLOW_CHECK(pool.available() == MFLOW_I2C_POOL_SIZE);
+}
+
+// Asynchronous chains are pipelined beyond the pool size and complete in order
+static void test_asynchronous(I2C_Master& master, CompletionCollector& collector)
+{
+	I2C_CommandPool& pool = I2C_CommandPool::shared();
+
+	for(unsigned tag = 0; tag < async_chains; tag++)
+	{
+		// Blocks while every chain is in flight
+		I2C_CommandChain* chain = pool.acquire();
+
+		queue_register_read(chain, tag % 2 == 0 ? device_address : absent_address, (uint8_t) (tag % 16));
+		chain->set_asynchronous(tag);
+		send_message(master.inputs[I2C_Master::command], chain);
+	}
+
+	while(collector.count() < async_chains) os_delay(1);
+
+	MFLOW_CHECK(collector.count() == async_chains);
+	MFLOW_CHECK(collector.disorder() == 0);
+	MFLOW_CHECK(collector.failed() == 0);
+	MFLOW_CHECK(collector.wrong() == 0);
+
+	// The master releases the chains before sending their completions
+	MFLOW_CHECK(pool.available() == MFLOW_I2C_POOL_SIZE);
+}
+
+// A reused chain does not report the execution of its previous use
+static void test_stale_execution(I2C_Master& master, RegisterDevice& device)
+{
+	I2C_CommandPool&  pool    = I2C_CommandPool::shared();
+	I2C_CommandChain* chains[MFLOW_I2C_POOL_SIZE];
+
+	// Executing a synchronous chain whose issuer gives up without waiting
+	I2C_CommandChain* abandoned = pool.acquire();
+	const unsigned    before    = device.transactions();
+
+	queue_register_read(abandoned, device_address, 0x00);
+	send_message(master.inputs[I2C_Master::command], abandoned);
+	while(device.transactions() == before) os_delay(1);
+	os_delay(10);
+	abandoned->release();
+
+	// The released chain is handed out last
+	for(unsigned i = 0; i < MFLOW_I2C_POOL_SIZE; i++) chains[i] = pool.acquire();
+	MFLOW_CHECK(chains[MFLOW_I2C_POOL_SIZE - 1] == abandoned);
+
+	// The wait returns only once the slow device completed the new transaction
+	device.set_delay(20);
+	queue_register_read(abandoned, device_address, 0x00);
+	send_message(master.inputs[I2C_Master::command], abandoned);
+	MFLOW_CHECK(abandoned->wait_for_execute());
+	MFLOW_CHECK(device.transactions() == before + 2);
+	device.set_delay(0);
+
+	for(unsigned i = 0; i < MFLOW_I2C_POOL_SIZE; i++) chains[i]->release();
+}
+
+// The poller reads every burst in one chain and decodes the channels from their offsets
+static void test_poller(I2C_Master& master)
+{
+	typedef I2C_Poller<ChannelSink::channels> Poller;
+
+	// Register values with the sign bits set, the bursts start at registers 2 and 10
+	I2C_CommandChain* chain = I2C_CommandPool::shared().acquire();
+	const uint8_t first[]  = { 0x02, 0xFF, 0xFE, 0x34, 0x92 };
+	const uint8_t second[] = { 0x0A, 0x80, 0x00, 0x01 };
+	chain->queue_start();
+	chain->queue_write_byte((uint8_t) (device_address << 1) | I2C_MASTER_WRITE);
+	chain->queue_write(first, sizeof(first));
+	chain->queue_start();
+	chain->queue_write_byte((uint8_t) (device_address << 1) | I2C_MASTER_WRITE);
+	chain->queue_write(second, sizeof(second));
+	chain->queue_stop();
+	send_message(master.inputs[I2C_Master::command], chain);
+	MFLOW_CHECK(chain->wait_for_execute());
+	chain->release();
+
+	I2C_PollPlan<ChannelSink::channels> plan;
+	plan.bursts     = 2;
+	plan.burst[0]   = { device_address, 0x02, 4 };
+	plan.burst[1]   = { device_address, 0x0A, 3 };
+	plan.channel[0] = { 0, 0, I2C_PollFormat::S16_BE,  1.0f,  0.0f };
+	plan.channel[1] = { 0, 2, I2C_PollFormat::S16_LE,  0.5f, -1.0f };
+	plan.channel[2] = { 1, 0, I2C_PollFormat::S24_BE,  1.0f,  0.0f };
+	plan.channel[3] = { 1, 2, I2C_PollFormat::U8,     -2.0f,  3.0f };
+
+	Poller      poller;
+	ChannelSink sink;
+
+	connect(poller, Poller::command, master, I2C_Master::command);
+	for(unsigned c = 0; c < ChannelSink::channels; c++) connect(poller, Poller::first_channel + c, sink, c);
+
+	send_message(poller.inputs[Poller::plan], plan);
+	send_message(poller.inputs[Poller::interval], 5U);
+
+	sink.start_process();
+	poller.start_process();
+
+	const os_tick_t start = os_tick_count();
+	while(sink.count(ChannelSink::channels - 1) < 2 && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	MFLOW_CHECK(poller.failures() == 0);
+	MFLOW_CHECK(sink.count(0) >= 2);
+	MFLOW_CHECK(sink.value(0) == -2.0f);
+	MFLOW_CHECK(sink.value(1) == (float) (int16_t) 0x9234 * 0.5f - 1.0f);
+	MFLOW_CHECK(sink.value(2) == -8388607.0f);
+	MFLOW_CHECK(sink.value(3) == 1.0f);
+
+	// A burst addressing the absent device fails the whole period, no channel is sent
+	plan.burst[1].address = absent_address;
+	send_message(poller.inputs[Poller::plan], plan);
+
+	while(poller.failures() < 1 && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	unsigned counts[ChannelSink::channels];
+	for(unsigned c = 0; c < ChannelSink::channels; c++) counts[c] = sink.count(c);
+
+	while(poller.failures() < 4 && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	MFLOW_CHECK(poller.failures() >= 4);
+	for(unsigned c = 0; c < ChannelSink::channels; c++) MFLOW_CHECK(sink.count(c) == counts[c]);
+
+	poller.stop_process();
+	sink.stop_process();
+
+	while(poller.is_running() || sink.is_running()) os_delay(1);
+}
+
+int main()
+{
+	RegisterDevice      device;
+	I2C_Master          master;
+	CompletionCollector collector;
+
+	i2c_mock_attach(0, device_address, &device);
+
+	connect(master, I2C_Master::result, collector, CompletionCollector::in);
+	configure(master);
+
+	collector.start_process();
+	master.start_process();
+
+	test_synchronous(master, device);
+	test_asynchronous(master, collector);
+	test_stale_execution(master, device);
+	test_poller(master);
+
+	master.stop_process();
+	collector.stop_process();
+
+	while(master.is_running() || collector.is_running()) os_delay(1);
+
+	i2c_mock_attach(0, device_address, nullptr);
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,165 @@
+// Standard includes
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Project includes
+#include "kernels.h"
+#include "sample.h"
+#include "test.h"
+
+
+// Block lengths around the vector widths, with tails of every length
+static const std::size_t lengths[] = { 0, 1, 3, 4, 7, 8, 9, 15, 16, 17, 31, 33, 100 };
+
+// Gain of the scale and multiply-accumulate kernels
+static constexpr float gain = -0.75f;
+
+// Largest relative error of the floating-point kernels, the inner products are summed in another order
+static constexpr double max_error     = 1e-6;
+static constexpr double max_error_dot = 1e-5;
+
+template <class Sample>
+static std::vector<Sample> make_block(std::size_t length, unsigned seed)
+{
+	std::mt19937                          generator(seed);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+	std::vector<Sample> block(length);
+	for(Sample& sample : block) sample = (Sample) distribution(generator);
+
+	return block;
+}
+
+// Full-scale fixed-point samples, so that the saturating kernels saturate
+template <>
+std::vector<q15> make_block<q15>(std::size_t length, unsigned seed)
+{
+	std::mt19937                       generator(seed);
+	std::uniform_int_distribution<int> distribution(INT16_MIN, INT16_MAX);
+
+	std::vector<q15> block(length);
+	for(q15& sample : block) sample.raw = (int16_t) distribution(generator);
+
+	return block;
+}
+
+static bool near(double value, double expected, double error)
+{
+	return std::fabs(value - expected) <= error * std::fmax(1.0, std::fabs(expected));
+}
+
+static int16_t saturate(int64_t value)
+{
+	return (int16_t) (value > INT16_MAX ? INT16_MAX : value < INT16_MIN ? INT16_MIN : value);
+}
+
+// The kernels of floating-point samples match the elementwise operations in double precision
+template <class Sample>
+static void test_float(std::size_t length)
+{
+	const std::vector<Sample> a = make_block<Sample>(length, 1);
+	const std::vector<Sample> b = make_block<Sample>(length, 2);
+
+	std::vector<Sample> sum(length), difference(length), product(length), scaled(length), accumulated = b;
+
+	vector_add(a.data(), b.data(), sum.data(), length);
+	vector_sub(a.data(), b.data(), difference.data(), length);
+	vector_mul(a.data(), b.data(), product.data(), length);
+	vector_scale(a.data(), gain, scaled.data(), length);
+	vector_mac(a.data(), gain, accumulated.data(), length);
+
+	const Sample dot = vector_dot(a.data(), b.data(), length);
+
+	unsigned wrong = 0;
+	double   inner = 0.0;
+
+	for(std::size_t i = 0; i < length; i++)
+	{
+		const double x = a[i];
+		const double y = b[i];
+
+		if(!near(sum[i],         x + y,        max_error)) wrong++;
+		if(!near(difference[i],  x - y,        max_error)) wrong++;
+		if(!near(product[i],     x * y,        max_error)) wrong++;
+		if(!near(scaled[i],      x * gain,     max_error)) wrong++;
+		if(!near(accumulated[i], y + x * gain, max_error)) wrong++;
+
+		inner += x * y;
+	}
+
+	MFLOW_CHECK(wrong == 0);
+	MFLOW_CHECK(near(dot, inner, max_error_dot));
+}
+
+// The kernels of Q15 samples match the saturating integer operations, the scaling rounds within one step
+static void test_fixed(std::size_t length)
+{
+	const std::vector<q15> a = make_block<q15>(length, 1);
+	const std::vector<q15> b = make_block<q15>(length, 2);
+
+	std::vector<q15> sum(length), difference(length), product(length), scaled(length), accumulated = b;
+
+	vector_add(a.data(), b.data(), sum.data(), length);
+	vector_sub(a.data(), b.data(), difference.data(), length);
+	vector_mul(a.data(), b.data(), product.data(), length);
+	vector_scale(a.data(), gain, scaled.data(), length);
+	vector_mac(a.data(), gain, accumulated.data(), length);
+
+	const q15 dot = vector_dot(a.data(), b.data(), length);
+
+	unsigned wrong = 0;
+	int64_t  inner = 0;
+
+	for(std::size_t i = 0; i < length; i++)
+	{
+		const int64_t x = a[i].raw;
+		const int64_t y = b[i].raw;
+
+		const int16_t scale = saturate(std::llround(x * gain));
+
+		if(sum[i].raw        != saturate(x + y))                      wrong++;
+		if(difference[i].raw != saturate(x - y))                      wrong++;
+		if(product[i].raw    != saturate((x * y + (1 << 14)) >> 15)) wrong++;
+
+		if(std::abs(scaled[i].raw      - scale)               > 1) wrong++;
+		if(std::abs(accumulated[i].raw - saturate(y + scale)) > 1) wrong++;
+
+		inner += x * y;
+	}
+
+	MFLOW_CHECK(wrong == 0);
+	MFLOW_CHECK(dot.raw == saturate((inner + (1 << 14)) >> 15));
+}
+
+// The output may alias an input
+static void test_alias(void)
+{
+	const std::size_t        length = 33;
+	const std::vector<float> a      = make_block<float>(length, 1);
+	const std::vector<float> b      = make_block<float>(length, 2);
+
+	std::vector<float> out = a;
+	vector_add(out.data(), b.data(), out.data(), length);
+	vector_scale(out.data(), gain, out.data(), length);
+
+	unsigned wrong = 0;
+	for(std::size_t i = 0; i < length; i++) if(!near(out[i], ((double) a[i] + b[i]) * gain, max_error)) wrong++;
+
+	MFLOW_CHECK(wrong == 0);
+}
+
+int main()
+{
+	for(std::size_t length : lengths)
+	{
+		test_float<double>(length);
+		test_float<float>(length);
+		test_fixed(length);
+	}
+
+	test_alias();
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,199 @@
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <random>
+#include <vector>
+
+// Project includes
+#include "frame.h"
+#include "median.h"
+#include "os.h"
+#include "sample.h"
+#include "test.h"
+
+
+// Number of samples pushed in every case
+static constexpr std::size_t stream_length = 16 * MFLOW_FRAME_LENGTH;
+
+/**
+ * @brief Sink collecting the received frames.
+ */
+class FrameCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	FrameCollector(void) : m_count(0)
+	{
+		inputs.addPort<Frame<double>>(in, 4);
+		m_samples.reserve(stream_length);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].receive<Frame<double>>();
+		if(!frame || m_samples.size() == m_samples.capacity()) return;
+
+		for(std::size_t i = 0; i < Frame<double>::length; i++) m_samples.push_back(frame.value()[i]);
+		m_count++;
+	}
+
+	unsigned                   count(void) const   { return m_count; }
+	const std::vector<double>& samples(void) const { return m_samples; }
+
+private:
+	std::vector<double>   m_samples;
+	std::atomic<unsigned> m_count;
+};
+
+// Random integers from a small range, so that the windows hold many equal samples
+static std::vector<int> make_stream(int range)
+{
+	std::mt19937                       generator(2468);
+	std::uniform_int_distribution<int> distribution(-range, range);
+
+	std::vector<int> stream(stream_length);
+	for(int& sample : stream) sample = distribution(generator);
+
+	return stream;
+}
+
+// Middle samples of the window from first to n, the same sample twice for odd lengths
+static void middle(const std::vector<int>& stream, std::size_t first, std::size_t n, int& lower, int& upper)
+{
+	std::vector<int> window(stream.begin() + first, stream.begin() + n + 1);
+	const std::size_t half = window.size() / 2;
+
+	std::nth_element(window.begin(), window.begin() + half, window.end());
+	upper = window[half];
+
+	if(window.size() % 2 == 1) lower = upper;
+	else lower = *std::max_element(window.begin(), window.begin() + half);
+}
+
+// The median of every window matches the middle samples selected from a copy of the window
+static void test_windows(unsigned window, int range)
+{
+	const std::vector<int> stream = make_stream(range);
+
+	SlidingMedian<double> median;
+	SlidingMedian<q15>    fixed;
+	median.reset(window);
+	fixed.reset(window);
+
+	unsigned wrong = 0;
+	for(std::size_t n = 0; n < stream.size(); n++)
+	{
+		q15 sample;
+		sample.raw = (int16_t) stream[n];
+
+		median.push(stream[n]);
+		fixed.push(sample);
+
+		int lower, upper;
+		middle(stream, n + 1 >= window ? n + 1 - window : 0, n, lower, upper);
+
+		if(median.median() != (lower + upper) / 2.0) wrong++;
+		if(fixed.median().raw != (lower + upper) / 2) wrong++;
+	}
+
+	MFLOW_CHECK(wrong == 0);
+}
+
+// Resizing discards the window, the median restarts from the next sample
+static void test_resize(void)
+{
+	const std::vector<int>      stream  = make_stream(3);
+	const std::vector<unsigned> windows = { 9, 4, 1, 16, 9 };
+
+	SlidingMedian<double> median;
+
+	unsigned    wrong = 0;
+	std::size_t start = 0;
+
+	for(std::size_t part = 0; part < windows.size(); part++)
+	{
+		median.reset(windows[part]);
+
+		const std::size_t end = start + stream.size() / windows.size();
+		for(std::size_t n = start; n < end; n++)
+		{
+			median.push(stream[n]);
+
+			int lower, upper;
+			middle(stream, std::max(start, n + 1 >= windows[part] ? n + 1 - windows[part] : 0), n, lower, upper);
+
+			if(median.median() != (lower + upper) / 2.0) wrong++;
+		}
+
+		start = end;
+	}
+
+	MFLOW_CHECK(wrong == 0);
+}
+
+// The filter emits the median of every sample of its input frames, the window spans frames
+static void test_filter(void)
+{
+	const unsigned         window = 45;
+	const std::vector<int> stream = make_stream(10);
+
+	MedianFilter   filter;
+	FrameCollector collector;
+	connect(filter, MedianFilter::frame_out, collector, FrameCollector::in);
+
+	send_message(filter.inputs[MedianFilter::width], window);
+
+	collector.start_process();
+	filter.start_process();
+
+	for(std::size_t first = 0; first < stream.size(); first += Frame<double>::length)
+	{
+		Frame<double> frame;
+		frame.sequence = (uint32_t) (first / Frame<double>::length);
+
+		for(std::size_t i = 0; i < Frame<double>::length; i++) frame[i] = stream[first + i];
+
+		send_message(filter.inputs[MedianFilter::frame_in], frame);
+	}
+
+	const unsigned  frames = stream.size() / Frame<double>::length;
+	const os_tick_t start  = os_tick_count();
+	while(collector.count() < frames && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	filter.stop_process();
+	collector.stop_process();
+
+	while(filter.is_running() || collector.is_running()) os_delay(1);
+
+	MFLOW_CHECK(collector.samples().size() == stream.size());
+	if(collector.samples().size() != stream.size()) return;
+
+	unsigned wrong = 0;
+	for(std::size_t n = 0; n < stream.size(); n++)
+	{
+		int lower, upper;
+		middle(stream, n + 1 >= window ? n + 1 - window : 0, n, lower, upper);
+
+		if(collector.samples()[n] != (lower + upper) / 2.0) wrong++;
+	}
+
+	MFLOW_CHECK(wrong == 0);
+}
+
+int main()
+{
+	// Odd and even windows over few distinct values and over many
+	for(unsigned window : { 1U, 2U, 5U, 8U, 33U, 100U })
+	{
+		test_windows(window, 2);
+		test_windows(window, 1000);
+	}
+
+	test_resize();
+	test_filter();
+
+	return MFLOW_TEST_RESULT();
+}
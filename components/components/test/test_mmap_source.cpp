@@ -0,0 +1,234 @@
+// Standard includes
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+// Linux includes
+#include <unistd.h>
+
+// Project includes
+#include "host/mmap_source.h"
+#include "os.h"
+#include "test.h"
+
+
+// Number of samples in each file
+static constexpr uint32_t samples = 256;
+
+// Number of samples in each view
+static constexpr uint32_t view_length = 16;
+
+// Number of views of each file
+static constexpr uint32_t views = samples / view_length;
+
+// Number of samples in each view of the frame test, frames span several views
+static constexpr uint32_t frame_view_length = 12;
+
+// Number of frames of each file
+static constexpr uint32_t frames = samples / Frame<double>::length;
+
+// Offset of the sample values of the second file
+static constexpr double second_offset = 10000.0;
+
+/**
+ * @brief   Sink holding the received views until released, then checking their samples.
+ * @details The views of both files stay queued until the source has mapped
+ *          the second file, so the first ones are read after one reconfiguration.
+ */
+class ViewChecker : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	ViewChecker(void) : released(false), m_count(0), m_wrong(0)
+	{
+		inputs.addPort<FrameView<double>>(in, 2 * views);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		if(!released) { os_delay(1); return; }
+
+		auto view = inputs[in].receive<FrameView<double>>();
+		if(!view) return;
+
+		const FrameView<double>& value = view.value();
+
+		// The sequence numbers continue across files, the first views belong to the first file
+		const uint32_t file  = value.sequence / views;
+		const uint32_t first = (value.sequence % views) * view_length;
+
+		if(value.length != view_length) m_wrong++;
+
+		for(uint32_t i = 0; i < value.length; i++)
+		{
+			if(value.samples[i] != file * second_offset + first + i) m_wrong++;
+		}
+
+		m_count++;
+	}
+
+	uint32_t count(void) const { return m_count; }
+	uint32_t wrong(void) const { return m_wrong; }
+
+	std::atomic<bool> released; /**< Set by the main thread to start reading the views. */
+
+private:
+	std::atomic<uint32_t> m_count;
+	std::atomic<uint32_t> m_wrong;
+};
+
+/**
+ * @brief Sink checking that the received frames continue the samples of the file.
+ */
+class FrameChecker : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	FrameChecker(void) : m_count(0), m_wrong(0)
+	{
+		inputs.addPort<Frame<double>>(in, frames);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].receive<Frame<double>>();
+		if(!frame) return;
+
+		const Frame<double>& value = frame.value();
+
+		if(value.sequence != m_count) m_wrong++;
+
+		for(uint32_t i = 0; i < Frame<double>::length; i++)
+		{
+			if(value.samples[i] != value.sequence * Frame<double>::length + i) m_wrong++;
+		}
+
+		m_count++;
+	}
+
+	uint32_t count(void) const { return m_count; }
+	uint32_t wrong(void) const { return m_wrong; }
+
+private:
+	std::atomic<uint32_t> m_count;
+	std::atomic<uint32_t> m_wrong;
+};
+
+// Writes a temporary file of samples starting at a value, returns false on failure
+static bool write_file(char* path, double start)
+{
+	const int fd = mkstemp(path);
+	if(fd < 0) return false;
+
+	double values[samples];
+	for(uint32_t i = 0; i < samples; i++) values[i] = start + i;
+
+	const bool written = write(fd, values, sizeof(values)) == (ssize_t) sizeof(values);
+	close(fd);
+
+	return written;
+}
+
+static MmapSourceConfig make_config(const char* path, uint32_t length = view_length)
+{
+	MmapSourceConfig config;
+	std::memset(&config, 0, sizeof(config));
+	std::snprintf(config.path, sizeof(config.path), "%s", path);
+	config.view_length = length;
+
+	return config;
+}
+
+static void wait_for(const InputPort& port, std::size_t count)
+{
+	const os_tick_t start = os_tick_count();
+	while(port.message_count() < count && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+}
+
+// Views of a file stay readable after the source mapped the next file
+static void test_reconfigure(void)
+{
+	char first[]  = "/tmp/mflow_mmap_XXXXXX";
+	char second[] = "/tmp/mflow_mmap_XXXXXX";
+	MFLOW_CHECK(write_file(first, 0.0));
+	MFLOW_CHECK(write_file(second, second_offset));
+
+	MmapSource  source;
+	ViewChecker checker;
+	connect(source, MmapSource::view, checker, ViewChecker::in);
+
+	send_message(source.inputs[MmapSource::config], make_config(first));
+
+	checker.start_process();
+	source.start_process();
+
+	// Mapping the second file while every view of the first one is still queued
+	wait_for(checker.inputs[ViewChecker::in], views);
+	MFLOW_CHECK(checker.inputs[ViewChecker::in].message_count() == views);
+
+	send_message(source.inputs[MmapSource::config], make_config(second));
+
+	wait_for(checker.inputs[ViewChecker::in], 2 * views);
+	MFLOW_CHECK(checker.inputs[ViewChecker::in].message_count() == 2 * views);
+
+	// The files are removed, the mappings keep their contents
+	unlink(first);
+	unlink(second);
+
+	checker.released = true;
+
+	const os_tick_t start = os_tick_count();
+	while(checker.count() < 2 * views && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	MFLOW_CHECK(checker.count() == 2 * views);
+	MFLOW_CHECK(checker.wrong() == 0);
+
+	source.stop_process();
+	checker.stop_process();
+
+	while(source.is_running() || checker.is_running()) os_delay(1);
+}
+
+// Frames are assembled across views shorter than a frame
+static void test_frames(void)
+{
+	char path[] = "/tmp/mflow_mmap_XXXXXX";
+	MFLOW_CHECK(write_file(path, 0.0));
+
+	MmapSource   source;
+	FrameChecker checker;
+	connect(source, MmapSource::frame_out, checker, FrameChecker::in);
+
+	send_message(source.inputs[MmapSource::config], make_config(path, frame_view_length));
+
+	checker.start_process();
+	source.start_process();
+
+	const os_tick_t start = os_tick_count();
+	while(checker.count() < frames && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	MFLOW_CHECK(checker.count() == frames);
+	MFLOW_CHECK(checker.wrong() == 0);
+
+	source.stop_process();
+	checker.stop_process();
+
+	while(source.is_running() || checker.is_running()) os_delay(1);
+	unlink(path);
+}
+
+int main()
+{
+	test_reconfigure();
+	test_frames();
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,146 @@
+// Standard includes
+#include <atomic>
+#include <vector>
+
+// Project includes
+#include "frame.h"
+#include "os.h"
+#include "rect_wave.h"
+#include "test.h"
+
+
+// Level of the high samples
+static constexpr double level = 50.0;
+
+// Interval of the paced generator in milliseconds per sample, and the tolerated lateness of the frames
+static constexpr unsigned interval_ms = 1;
+static constexpr unsigned max_late_ms = 40;
+
+/**
+ * @brief Sink storing the received frames and the time of their arrival.
+ */
+class WaveCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	WaveCollector(void) : m_count(0)
+	{
+		inputs.addPort<Frame<double>>(in, 4);
+		m_frames.reserve(16);
+		m_times.reserve(16);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].receive<Frame<double>>();
+		if(!frame || m_frames.size() == m_frames.capacity()) return;
+
+		m_frames.push_back(frame.value());
+		m_times.push_back(os_tick_count());
+		m_count++;
+	}
+
+	unsigned                          count(void) const  { return m_count; }
+	const std::vector<Frame<double>>& frames(void) const { return m_frames; }
+	const std::vector<os_tick_t>&     times(void) const  { return m_times; }
+
+private:
+	std::vector<Frame<double>> m_frames;
+	std::vector<os_tick_t>     m_times;
+	std::atomic<unsigned>      m_count;
+};
+
+// Runs the generator until the collector received the given number of frames, clocked when the interval is zero
+static void run(WaveCollector& collector, unsigned period, unsigned duty, unsigned interval, unsigned frames)
+{
+	RectifiedWave wave;
+	connect(wave, RectifiedWave::frame_out, collector, WaveCollector::in);
+
+	send_message(wave.inputs[RectifiedWave::period], period);
+	send_message(wave.inputs[RectifiedWave::duty], duty);
+	send_message(wave.inputs[RectifiedWave::interval], interval);
+
+	collector.start_process();
+	wave.start_process();
+
+	if(interval == 0)
+	{
+		for(unsigned f = 0; f < frames; f++) send_message(wave.inputs[RectifiedWave::clk], true);
+	}
+
+	const os_tick_t start = os_tick_count();
+	while(collector.count() < frames && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	wave.stop_process();
+	collector.stop_process();
+
+	while(wave.is_running() || collector.is_running()) os_delay(1);
+}
+
+// The first ceil(period * duty / 100) samples of every period are high, the periods continue across frames
+static void test_duty(unsigned period, unsigned duty, unsigned high)
+{
+	const unsigned frames = 3;
+
+	WaveCollector collector;
+	run(collector, period, duty, 0, frames);
+
+	MFLOW_CHECK(collector.count() == frames);
+
+	unsigned wrong = 0;
+	for(unsigned f = 0; f < collector.frames().size(); f++)
+	{
+		const Frame<double>& frame = collector.frames()[f];
+		if(frame.sequence != f) wrong++;
+
+		for(std::size_t i = 0; i < Frame<double>::length; i++)
+		{
+			const std::size_t n        = f * Frame<double>::length + i;
+			const double      expected = period != 0 && n % period < high ? level : 0.0;
+
+			if(frame[i] != expected) wrong++;
+		}
+	}
+
+	MFLOW_CHECK(wrong == 0);
+}
+
+// The paced generator sends a frame every frame length times the interval
+static void test_pacing(void)
+{
+	const unsigned frames   = 6;
+	const unsigned frame_ms = Frame<double>::length * interval_ms;
+
+	WaveCollector collector;
+	run(collector, 8, 50, interval_ms, frames);
+
+	MFLOW_CHECK(collector.count() == frames);
+	if(collector.count() != frames) return;
+
+	// Measured from the first frame, which is sent without waiting
+	for(unsigned f = 1; f < frames; f++)
+	{
+		const uint32_t elapsed = os_ticks_to_ms(collector.times()[f] - collector.times()[0]);
+
+		MFLOW_CHECK(elapsed + 1 >= f * frame_ms);
+		MFLOW_CHECK(elapsed <= f * frame_ms + max_late_ms);
+	}
+}
+
+int main()
+{
+	test_duty(7, 50, 4);
+	test_duty(10, 33, 4);
+	test_duty(10, 30, 3);
+	test_duty(45, 10, 5);
+	test_duty(5, 0, 0);
+	test_duty(6, 150, 6);
+	test_duty(0, 50, 0);
+
+	test_pacing();
+
+	return MFLOW_TEST_RESULT();
+}
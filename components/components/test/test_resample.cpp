@@ -0,0 +1,209 @@
+// Standard includes
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// Project includes
+#include "frame.h"
+#include "os.h"
+#include "resample.h"
+#include "test.h"
+
+
+// Number of low rate samples discarded while the filters settle
+static constexpr std::size_t settle_samples = 200;
+
+// Number of low rate samples analyzed, the test frequencies are whole bins
+static constexpr std::size_t analyzed_samples = 2000;
+
+// Limits of the protected band: gain error and alias or image level
+static constexpr double max_gain_error = 0.001;
+static constexpr double max_alias_db   = -50.0;
+
+// Highest tested alias or image, in cycles per low rate sample, the nearest ones are the worst
+static constexpr double max_tone = 8.0;
+
+static const double pi = 3.141592653589793;
+
+/**
+ * @brief Source sending a unit amplitude sine in frames.
+ */
+class ToneSource : public Component {
+public:
+
+	static constexpr unsigned out = 0U;
+
+	ToneSource(double frequency, std::size_t frames) : m_frequency(frequency), m_frames(frames), m_sent(0)
+	{
+		outputs.addPort<Frame<float>>(out);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		if(m_sent == m_frames)
+		{
+			os_delay(1);
+			return;
+		}
+
+		Frame<float> frame;
+		frame.sequence = (uint32_t) m_sent;
+
+		for(std::size_t i = 0; i < Frame<float>::length; i++)
+		{
+			const double n = (double) (m_sent * Frame<float>::length + i);
+			frame.samples[i] = (float) std::sin(2.0 * pi * m_frequency * n);
+		}
+
+		if(outputs[out].send<Frame<float>>(frame) == MessageStatus::Okay) m_sent++;
+	}
+
+private:
+	double      m_frequency;
+	std::size_t m_frames;
+	std::size_t m_sent;
+};
+
+/**
+ * @brief Sink collecting a given number of samples.
+ */
+class Collector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	explicit Collector(std::size_t count) : m_count(count), m_done(false)
+	{
+		inputs.addPort<Frame<float>>(in, 4);
+		m_samples.reserve(count + Frame<float>::length);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].receive<Frame<float>>();
+		if(!frame || m_done) return;
+
+		const Frame<float> value = frame.value();
+		for(std::size_t i = 0; i < Frame<float>::length; i++) m_samples.push_back(value.samples[i]);
+
+		if(m_samples.size() >= m_count) m_done = true;
+	}
+
+	bool                      done(void) const    { return m_done; }
+	const std::vector<float>& samples(void) const { return m_samples; }
+
+private:
+	std::size_t        m_count;
+	std::atomic<bool>  m_done;
+	std::vector<float> m_samples;
+};
+
+// Runs a converter on a sine, returns the converted samples
+template <class Converter>
+static std::vector<float> convert(unsigned factor, double frequency, std::size_t input_samples, std::size_t output_samples)
+{
+	ToneSource source(frequency, (input_samples + Frame<float>::length - 1) / Frame<float>::length);
+	Converter  converter;
+	Collector  collector(output_samples);
+
+	connect(source, ToneSource::out, converter, Converter::in);
+	connect(converter, Converter::out, collector, Collector::in);
+	send_message(converter.inputs[Converter::factor], factor);
+
+	collector.start_process();
+	converter.start_process();
+	source.start_process();
+
+	while(!collector.done()) os_delay(1);
+
+	source.stop_process();
+	converter.stop_process();
+	collector.stop_process();
+
+	while(source.is_running() || converter.is_running() || collector.is_running()) os_delay(1);
+
+	return collector.samples();
+}
+
+// Amplitude of a whole-bin frequency in the analyzed samples
+static double amplitude(const std::vector<float>& samples, std::size_t first, std::size_t length, double frequency)
+{
+	double real = 0.0;
+	double imag = 0.0;
+
+	for(std::size_t n = 0; n < length; n++)
+	{
+		real += samples[first + n] * std::cos(2.0 * pi * frequency * n);
+		imag -= samples[first + n] * std::sin(2.0 * pi * frequency * n);
+	}
+
+	return 2.0 * std::sqrt(real * real + imag * imag) / length;
+}
+
+static double decibel(double value)
+{
+	return 20.0 * std::log10(value > 1e-12 ? value : 1e-12);
+}
+
+// Tones at 0.3 of the low rate pass, tones aliasing onto 0.3 are rejected
+static void test_decimator(unsigned factor)
+{
+	const std::size_t outputs = settle_samples + analyzed_samples;
+	const std::size_t inputs  = (outputs + 2 * Frame<float>::length) * factor;
+
+	// Passband gain at 0.3 of the output rate
+	auto   samples = convert<BasicDecimator<float>>(factor, 0.3 / factor, inputs, outputs);
+	double gain    = amplitude(samples, settle_samples, analyzed_samples, 0.3);
+	MFLOW_CHECK(std::fabs(gain - 1.0) < max_gain_error);
+
+	// Tones at 0.7, 1.3, 1.7... of the output rate all alias onto 0.3
+	double worst = 0.0;
+	for(double tone = 0.7; tone < 0.5 * factor && tone < max_tone; tone += tone - std::floor(tone) < 0.5 ? 0.4 : 0.6)
+	{
+		samples = convert<BasicDecimator<float>>(factor, tone / factor, inputs, outputs);
+
+		const double level = amplitude(samples, settle_samples, analyzed_samples, 0.3);
+		if(level > worst) worst = level;
+	}
+
+	MFLOW_CHECK(decibel(worst) < max_alias_db);
+	std::printf("Decimator    R=%3u  passband gain %.5f  worst alias %6.1f dB\n", factor, gain, decibel(worst));
+}
+
+// Tones at 0.3 of the low rate pass, their images at 0.7, 1.3, 1.7... are rejected
+static void test_interpolator(unsigned factor)
+{
+	const std::size_t inputs  = settle_samples + analyzed_samples + 2 * Frame<float>::length;
+	const std::size_t outputs = (settle_samples + analyzed_samples) * factor;
+	const std::size_t first   = settle_samples * factor;
+	const std::size_t length  = analyzed_samples * factor;
+
+	auto   samples = convert<BasicInterpolator<float>>(factor, 0.3, inputs, outputs);
+	double gain    = amplitude(samples, first, length, 0.3 / factor);
+	MFLOW_CHECK(std::fabs(gain - 1.0) < max_gain_error);
+
+	double worst = 0.0;
+	for(double image = 0.7; image < 0.5 * factor && image < max_tone; image += image - std::floor(image) < 0.5 ? 0.4 : 0.6)
+	{
+		const double level = amplitude(samples, first, length, image / factor);
+		if(level > worst) worst = level;
+	}
+
+	MFLOW_CHECK(decibel(worst) < max_alias_db);
+	std::printf("Interpolator R=%3u  passband gain %.5f  worst image %6.1f dB\n", factor, gain, decibel(worst));
+}
+
+int main()
+{
+	const unsigned factors[] = { 2, 3, 4, 5, 7, 8, 9, 10, 11, 16, 25, 32, 33, 64, 127, 251, 256 };
+
+	for(unsigned factor : factors) test_decimator(factor);
+	for(unsigned factor : factors) test_interpolator(factor);
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,150 @@
+// Standard includes
+#include <atomic>
+#include <vector>
+
+// Project includes
+#include "os.h"
+#include "router.h"
+#include "test.h"
+
+
+// Router of three outputs, the last one is left unconnected
+typedef Router<unsigned, 3> KeyRouter;
+
+/**
+ * @brief Sink storing the received keys.
+ */
+class KeyCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	KeyCollector(void) : m_count(0)
+	{
+		inputs.addPort<unsigned>(in, 4);
+		m_keys.reserve(512);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto key = inputs[in].receive<unsigned>();
+		if(!key || m_keys.size() == m_keys.capacity()) return;
+
+		m_keys.push_back(key.value());
+		m_count++;
+	}
+
+	unsigned                     count(void) const { return m_count; }
+	const std::vector<unsigned>& keys(void) const  { return m_keys; }
+
+private:
+	std::vector<unsigned> m_keys;
+	std::atomic<unsigned> m_count;
+};
+
+/**
+ * @brief Keys received on the connected outputs and the number of dropped messages.
+ */
+struct Routed {
+	std::vector<unsigned> first;
+	std::vector<unsigned> second;
+	unsigned              dropped;
+};
+
+static uint32_t identity(const unsigned& message)
+{
+	return message;
+}
+
+// Routes the keys followed by a last key to the first output, which marks the end of the run
+static Routed run(const RouteTable* table, const std::vector<unsigned>& keys, unsigned last)
+{
+	KeyRouter    router(identity);
+	KeyCollector first;
+	KeyCollector second;
+	connect(router, 0, first, KeyCollector::in);
+	connect(router, 1, second, KeyCollector::in);
+
+	if(table) send_message(router.inputs[KeyRouter::routes], *table);
+
+	first.start_process();
+	second.start_process();
+	router.start_process();
+
+	for(unsigned key : keys) send_message(router.inputs[KeyRouter::in], key);
+	send_message(router.inputs[KeyRouter::in], last);
+
+	const os_tick_t start = os_tick_count();
+	while((first.count() == 0 || first.keys()[first.count() - 1] != last) && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	router.stop_process();
+	first.stop_process();
+	second.stop_process();
+
+	while(router.is_running() || first.is_running() || second.is_running()) os_delay(1);
+
+	Routed routed = { first.keys(), second.keys(), router.dropped() };
+	if(!routed.first.empty()) routed.first.pop_back();
+
+	return routed;
+}
+
+// By default key k goes to output k modulo the outputs, keys outside the table are discarded
+static void test_default(void)
+{
+	std::vector<unsigned> keys;
+	for(unsigned k = 0; k < MFLOW_ROUTER_KEYS + 44; k++) keys.push_back(k);
+
+	const Routed routed = run(nullptr, keys, 0);
+
+	std::vector<unsigned> first, second;
+	unsigned              dropped = 0;
+
+	for(unsigned k : keys)
+	{
+		if(k >= MFLOW_ROUTER_KEYS || k % 3 == 2) dropped++;
+		else if(k % 3 == 0) first.push_back(k);
+		else second.push_back(k);
+	}
+
+	MFLOW_CHECK(routed.first == first);
+	MFLOW_CHECK(routed.second == second);
+	MFLOW_CHECK(routed.dropped == dropped);
+}
+
+// A route table replaces the default one, its fallback receives the keys outside the table
+static void test_table(void)
+{
+	RouteTable table;
+	for(unsigned k = 0; k < MFLOW_ROUTER_KEYS; k++) table.output[k] = k < 10 ? 1 : k < 20 ? 0 : k < 30 ? KeyRouter::discard : 2;
+	table.fallback = 0;
+
+	std::vector<unsigned> keys;
+	for(unsigned k = 0; k < 40; k++) keys.push_back(k);
+	keys.push_back(MFLOW_ROUTER_KEYS);
+	keys.push_back(1000);
+
+	const Routed routed = run(&table, keys, 10);
+
+	std::vector<unsigned> first, second;
+	for(unsigned k = 10; k < 20; k++) first.push_back(k);
+	for(unsigned k = 0; k < 10; k++) second.push_back(k);
+	first.push_back(MFLOW_ROUTER_KEYS);
+	first.push_back(1000);
+
+	MFLOW_CHECK(routed.first == first);
+	MFLOW_CHECK(routed.second == second);
+
+	// Discarded keys and keys of the unconnected output
+	MFLOW_CHECK(routed.dropped == 20);
+}
+
+int main()
+{
+	test_default();
+	test_table();
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,166 @@
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <random>
+#include <vector>
+
+// Project includes
+#include "frame.h"
+#include "os.h"
+#include "statistics.h"
+#include "test.h"
+
+
+typedef BasicStatistics<float> Statistics;
+
+// Number of frames of the test stream
+static constexpr std::size_t frames = 24;
+
+// Smoothing factor of the exponentially weighted statistics
+static constexpr float alpha = 0.05f;
+
+// Largest error of the mean and variance, the component accumulates in single precision
+static constexpr double max_error = 1e-4;
+
+/**
+ * @brief Sink storing the received records.
+ */
+class RecordCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	RecordCollector(void) : m_count(0)
+	{
+		inputs.addPort<StreamStatistics>(in, 16);
+		m_records.reserve(frames * Frame<float>::length);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto record = inputs[in].receive<StreamStatistics>();
+		if(!record || m_records.size() == m_records.capacity()) return;
+
+		m_records.push_back(record.value());
+		m_count++;
+	}
+
+	unsigned                             count(void) const   { return m_count; }
+	const std::vector<StreamStatistics>& records(void) const { return m_records; }
+
+private:
+	std::vector<StreamStatistics> m_records;
+	std::atomic<unsigned>         m_count;
+};
+
+// Random samples around an offset, rounded to eighths so that equal samples compete for the extrema
+static std::vector<float> make_stream(void)
+{
+	std::mt19937                          generator(4321);
+	std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+
+	std::vector<float> stream(frames * Frame<float>::length);
+	for(float& sample : stream) sample = 3.0f + std::round(8.0f * distribution(generator)) / 8.0f;
+
+	return stream;
+}
+
+// Runs the stream through the component in frames, returns the records
+static std::vector<StreamStatistics> run(const std::vector<float>& stream, unsigned window, unsigned decimation)
+{
+	Statistics      statistics;
+	RecordCollector collector;
+	connect(statistics, Statistics::out, collector, RecordCollector::in);
+
+	send_message(statistics.inputs[Statistics::window], window);
+	send_message(statistics.inputs[Statistics::alpha], alpha);
+	send_message(statistics.inputs[Statistics::decimation], decimation);
+
+	collector.start_process();
+	statistics.start_process();
+
+	for(std::size_t first = 0; first < stream.size(); first += Frame<float>::length)
+	{
+		Frame<float> frame;
+		frame.sequence = (uint32_t) (first / Frame<float>::length);
+		std::copy(stream.begin() + first, stream.begin() + first + Frame<float>::length, frame.samples);
+
+		send_message(statistics.inputs[Statistics::frame_in], frame);
+	}
+
+	const unsigned  expected = stream.size() / decimation;
+	const os_tick_t start    = os_tick_count();
+	while(collector.count() < expected && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+
+	statistics.stop_process();
+	collector.stop_process();
+
+	while(statistics.is_running() || collector.is_running()) os_delay(1);
+
+	return collector.records();
+}
+
+// Every record matches the statistics recomputed over the samples of its window
+static void test_window(unsigned window, unsigned decimation)
+{
+	const std::vector<float>            stream  = make_stream();
+	const std::vector<StreamStatistics> records = run(stream, window, decimation);
+
+	MFLOW_CHECK(records.size() == stream.size() / decimation);
+
+	double ew_mean     = stream[0];
+	double ew_variance = 0.0;
+	std::size_t next   = 0;
+
+	for(std::size_t n = 0; n < stream.size() && next < records.size(); n++)
+	{
+		if(n > 0)
+		{
+			const double delta = stream[n] - ew_mean;
+			ew_mean    += alpha * delta;
+			ew_variance = (1.0 - alpha) * (ew_variance + alpha * delta * delta);
+		}
+
+		if((n + 1) % decimation != 0) continue;
+
+		const std::size_t first = n + 1 >= window ? n + 1 - window : 0;
+		const std::size_t count = n + 1 - first;
+
+		double sum = 0.0;
+		for(std::size_t i = first; i <= n; i++) sum += stream[i];
+		const double mean = sum / count;
+
+		double m2 = 0.0;
+		for(std::size_t i = first; i <= n; i++) m2 += (stream[i] - mean) * (stream[i] - mean);
+
+		const StreamStatistics& record = records[next];
+
+		MFLOW_CHECK(record.sequence == next);
+		MFLOW_CHECK(record.count == count);
+		MFLOW_CHECK(record.min == *std::min_element(stream.begin() + first, stream.begin() + n + 1));
+		MFLOW_CHECK(record.max == *std::max_element(stream.begin() + first, stream.begin() + n + 1));
+		MFLOW_CHECK(std::fabs(record.mean - mean) < max_error);
+		MFLOW_CHECK(std::fabs(record.variance - m2 / count) < max_error);
+		MFLOW_CHECK(std::fabs(record.ew_mean - ew_mean) < max_error);
+		MFLOW_CHECK(std::fabs(record.ew_variance - ew_variance) < max_error);
+
+		next++;
+	}
+}
+
+int main()
+{
+	// A single sample, a window within a frame and windows spanning frames
+	test_window(1, 1);
+	test_window(5, 1);
+	test_window(45, 1);
+	test_window(100, 1);
+
+	// Decimated records between the window ends
+	test_window(45, 7);
+
+	return MFLOW_TEST_RESULT();
+}
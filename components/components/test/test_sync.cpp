@@ -0,0 +1,160 @@
+// Standard includes
+#include <atomic>
+#include <cstdint>
+
+// Project includes
+#include "os.h"
+#include "sync.h"
+#include "test.h"
+
+
+typedef BasicSynchronizer<double, 2> Synchronizer;
+
+// Most aligned samples expected in a case
+static constexpr unsigned max_aligned = 8;
+
+/**
+ * @brief Sink storing the aligned samples it receives.
+ */
+class AlignedCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	AlignedCollector(void) : m_count(0)
+	{
+		inputs.addPort<Aligned<double, 2>>(in, max_aligned);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto aligned = inputs[in].receive<Aligned<double, 2>>();
+		if(!aligned || m_count == max_aligned) return;
+
+		m_aligned[m_count] = aligned.value();
+		m_count++;
+	}
+
+	unsigned                  count(void) const             { return m_count; }
+	const Aligned<double, 2>& aligned(unsigned index) const { return m_aligned[index]; }
+
+private:
+	Aligned<double, 2>    m_aligned[max_aligned];
+	std::atomic<unsigned> m_count;
+};
+
+/**
+ * @brief Timestamps of both streams and the expected result of a case.
+ */
+struct SyncCase {
+	unsigned           references;   /**< Number of reference timestamps.            */
+	uint32_t           reference[4]; /**< Timestamps of the reference stream.        */
+	unsigned           samples;      /**< Number of timestamps of the second stream. */
+	uint32_t           sample[4];    /**< Timestamps of the second stream.           */
+	unsigned           expected;     /**< Number of aligned samples expected.        */
+	Aligned<double, 2> aligned[4];   /**< Expected aligned samples.                  */
+	unsigned           dropped;      /**< Expected number of dropped samples.        */
+};
+
+// The reference values equal their timestamps, the second stream carries ten times the timestamp
+static void run(SyncPolicy policy, const SyncCase& test)
+{
+	Synchronizer     sync;
+	AlignedCollector collector;
+	connect(sync, Synchronizer::out, collector, AlignedCollector::in);
+
+	send_message(sync.inputs[Synchronizer::policy], policy);
+
+	for(unsigned i = 0; i < test.references; i++)
+	{
+		send_message(sync.inputs[0], Stamped<double>{ test.reference[i], (double) test.reference[i] });
+	}
+
+	for(unsigned i = 0; i < test.samples; i++)
+	{
+		send_message(sync.inputs[1], Stamped<double>{ test.sample[i], 10.0 * test.sample[i] });
+	}
+
+	collector.start_process();
+	sync.start_process();
+
+	// Waiting for the expected samples and for anything unexpected after them
+	const os_tick_t start = os_tick_count();
+	while(collector.count() < test.expected && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+	while(sync.inputs[0].message_count() > 0 || sync.inputs[1].message_count() > 0) os_delay(1);
+	os_delay(20);
+
+	MFLOW_CHECK(collector.count() == test.expected);
+	MFLOW_CHECK(sync.dropped() == test.dropped);
+
+	for(unsigned i = 0; i < test.expected && i < collector.count(); i++)
+	{
+		MFLOW_CHECK(collector.aligned(i).timestamp == test.aligned[i].timestamp);
+		MFLOW_CHECK(collector.aligned(i).values[0] == test.aligned[i].values[0]);
+		MFLOW_CHECK(collector.aligned(i).values[1] == test.aligned[i].values[1]);
+	}
+
+	sync.stop_process();
+	collector.stop_process();
+
+	while(sync.is_running() || collector.is_running()) os_delay(1);
+}
+
+// Every reference sample has a matching sample, nothing is dropped
+static void test_matching(void)
+{
+	const SyncCase test = {
+		3, { 0, 1, 2 }, 3, { 0, 1, 2 },
+		3, { { 0, { 0.0, 0.0 } }, { 1, { 1.0, 10.0 } }, { 2, { 2.0, 20.0 } } }, 0
+	};
+
+	run(SyncPolicy::Exact, test);
+	run(SyncPolicy::Hold, test);
+	run(SyncPolicy::Interpolate, test);
+}
+
+// A sample older than every reference is dropped by the exact policy only
+static void test_late(void)
+{
+	SyncCase test = {
+		2, { 10, 11 }, 3, { 5, 10, 11 },
+		2, { { 10, { 10.0, 100.0 } }, { 11, { 11.0, 110.0 } } }, 1
+	};
+
+	run(SyncPolicy::Exact, test);
+
+	test.dropped = 0;
+	run(SyncPolicy::Hold, test);
+	run(SyncPolicy::Interpolate, test);
+}
+
+// A missing sample drops the reference under the exact policy, it is held or interpolated otherwise
+static void test_missing(void)
+{
+	SyncCase test = {
+		3, { 0, 1, 2 }, 2, { 0, 2 },
+		2, { { 0, { 0.0, 0.0 } }, { 2, { 2.0, 20.0 } } }, 1
+	};
+
+	run(SyncPolicy::Exact, test);
+
+	test.expected   = 3;
+	test.dropped    = 0;
+	test.aligned[1] = { 1, { 1.0, 0.0 } };
+	test.aligned[2] = { 2, { 2.0, 20.0 } };
+	run(SyncPolicy::Hold, test);
+
+	test.aligned[1] = { 1, { 1.0, 10.0 } };
+	run(SyncPolicy::Interpolate, test);
+}
+
+int main()
+{
+	test_matching();
+	test_late();
+	test_missing();
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,213 @@
+// Standard includes
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <vector>
+
+// Project includes
+#include "frame.h"
+#include "os.h"
+#include "test.h"
+#include "trigger.h"
+
+
+// Number of frames of the test signal
+static constexpr std::size_t signal_frames = 8;
+
+/**
+ * @brief Sink storing the received events.
+ */
+class EventCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	EventCollector(void) : m_count(0)
+	{
+		inputs.addPort<TriggerEvent>(in, 16);
+		m_events.reserve(64);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto event = inputs[in].receive<TriggerEvent>();
+		if(!event || m_events.size() == m_events.capacity()) return;
+
+		m_events.push_back(event.value());
+		m_count++;
+	}
+
+	unsigned                         count(void) const  { return m_count; }
+	const std::vector<TriggerEvent>& events(void) const { return m_events; }
+
+private:
+	std::vector<TriggerEvent> m_events;
+	std::atomic<unsigned>     m_count;
+};
+
+/**
+ * @brief Sink storing the received capture frames.
+ */
+class CaptureCollector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	CaptureCollector(void) : m_count(0)
+	{
+		inputs.addPort<Frame<double>>(in, 16);
+		m_frames.reserve(signal_frames);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].receive<Frame<double>>();
+		if(!frame || m_frames.size() == m_frames.capacity()) return;
+
+		m_frames.push_back(frame.value());
+		m_count++;
+	}
+
+	unsigned                          count(void) const  { return m_count; }
+	const std::vector<Frame<double>>& frames(void) const { return m_frames; }
+
+private:
+	std::vector<Frame<double>> m_frames;
+	std::atomic<unsigned>      m_count;
+};
+
+/**
+ * @brief Expected event, the crossing sample and the capture started by it.
+ */
+struct Crossing {
+	uint32_t    index;
+	TriggerEdge edge;
+	uint32_t    capture;
+};
+
+// Levels of the signal between the crossings, the ripple on top is smaller than the hysteresis
+static double level(std::size_t n)
+{
+	if(n < 3)   return 0.0;
+	if(n < 9)   return 0.7;
+	if(n < 15)  return -0.7;
+	if(n < 20)  return 0.7;
+	if(n < 25)  return -0.7;
+	if(n < 100) return 0.0;
+	if(n < 130) return 0.65;
+	if(n < 140) return -0.7;
+	if(n < 160) return 0.0;
+	if(n < 170) return 0.7;
+	if(n < 180) return -0.7;
+
+	return 0.0;
+}
+
+static std::vector<double> make_signal(void)
+{
+	std::vector<double> signal(signal_frames * Frame<double>::length);
+	for(std::size_t n = 0; n < signal.size(); n++) signal[n] = level(n) + 0.2 * std::sin(0.7 * n);
+
+	return signal;
+}
+
+// Events carry the crossing and the extremum since the previous event, captures hold the pre and post samples in whole frames
+static void test_captures(void)
+{
+	const std::vector<double> signal = make_signal();
+	const uint32_t            none   = Trigger::no_capture;
+
+	// The ripple around 0.65 crosses the high threshold repeatedly without falling to the low one
+	const std::vector<Crossing> expected = {
+		{   3, TriggerRising,  0    },  // Only 3 samples of history before the crossing
+		{   9, TriggerFalling, none },  // Events during a capture do not start another one
+		{  15, TriggerRising,  none },
+		{  20, TriggerFalling, none },
+		{ 100, TriggerRising,  2    },
+		{ 130, TriggerFalling, none },
+		{ 160, TriggerRising,  4    },  // Starts after the previous capture ended at sample 153
+		{ 170, TriggerFalling, none }
+	};
+
+	// Captures of 10 pre and 40 post samples, completed to whole frames
+	const TriggerConfig config = { 0.5f, -0.5f, (uint8_t) (TriggerRising | TriggerFalling), 10U, 40U };
+	const std::size_t   starts[] = { 0, 90, 150 };
+
+	Trigger          trigger;
+	EventCollector   events;
+	CaptureCollector captures;
+	connect(trigger, Trigger::event, events, EventCollector::in);
+	connect(trigger, Trigger::capture, captures, CaptureCollector::in);
+
+	send_message(trigger.inputs[Trigger::config], config);
+
+	events.start_process();
+	captures.start_process();
+	trigger.start_process();
+
+	for(std::size_t first = 0; first < signal.size(); first += Frame<double>::length)
+	{
+		Frame<double> frame;
+		frame.sequence = (uint32_t) (first / Frame<double>::length);
+		std::copy(signal.begin() + first, signal.begin() + first + Frame<double>::length, frame.samples);
+
+		send_message(trigger.inputs[Trigger::frame_in], frame);
+	}
+
+	const os_tick_t start = os_tick_count();
+	while((events.count() < expected.size() || captures.count() < 6) && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+	os_delay(20);
+
+	trigger.stop_process();
+	events.stop_process();
+	captures.stop_process();
+
+	while(trigger.is_running() || events.is_running() || captures.is_running()) os_delay(1);
+
+	// Events
+	MFLOW_CHECK(events.count() == expected.size());
+
+	for(std::size_t e = 0; e < expected.size() && e < events.events().size(); e++)
+	{
+		const TriggerEvent& event    = events.events()[e];
+		const Crossing&     crossing = expected[e];
+
+		const std::size_t previous = e == 0 ? 0 : expected[e - 1].index;
+		const auto        begin    = signal.begin() + previous;
+		const auto        end      = signal.begin() + crossing.index + 1;
+		const double      peak     = crossing.edge == TriggerRising ? *std::min_element(begin, end) : *std::max_element(begin, end);
+
+		MFLOW_CHECK(event.sequence == e);
+		MFLOW_CHECK(event.index == crossing.index);
+		MFLOW_CHECK(event.edge == crossing.edge);
+		MFLOW_CHECK(event.value == (float) signal[crossing.index]);
+		MFLOW_CHECK(event.peak == (float) peak);
+		MFLOW_CHECK(event.capture == crossing.capture);
+	}
+
+	// Captures, two frames each
+	MFLOW_CHECK(captures.count() == 6);
+
+	unsigned wrong = 0;
+	for(std::size_t f = 0; f < captures.frames().size(); f++)
+	{
+		const Frame<double>& frame = captures.frames()[f];
+		const std::size_t    first = starts[f / 2] + (f % 2) * Frame<double>::length;
+
+		if(frame.sequence != f) wrong++;
+		for(std::size_t i = 0; i < Frame<double>::length; i++) if(frame[i] != signal[first + i]) wrong++;
+	}
+
+	MFLOW_CHECK(wrong == 0);
+}
+
+int main()
+{
+	test_captures();
+
+	return MFLOW_TEST_RESULT();
+}
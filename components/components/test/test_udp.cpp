@@ -0,0 +1,227 @@
+// Standard includes
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+// Linux includes
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Project includes
+#include "host/udp.h"
+#include "os.h"
+#include "test.h"
+
+
+// Number of frames sent over the loopback interface
+static constexpr uint32_t frames = 2000;
+
+// Milliseconds to wait for all datagrams to arrive
+static constexpr uint32_t timeout_ms = 5000;
+
+/**
+ * @brief Sink counting the received frames and checking their contents.
+ */
+class FrameChecker : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	FrameChecker(void) : m_count(0), m_wrong(0), m_disorder(0), m_next(0)
+	{
+		inputs.addPort<Frame<double>>(in, 64);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto frame = inputs[in].receive<Frame<double>>();
+		if(!frame) return;
+
+		const Frame<double>& value = frame.value();
+
+		// Frames may be dropped when the checker is full, but never reordered
+		if(value.sequence < m_next) m_disorder++;
+		m_next = value.sequence + 1;
+
+		for(std::size_t i = 0; i < Frame<double>::length; i++)
+		{
+			if(value.samples[i] != value.sequence + 0.5 * i) m_wrong++;
+		}
+
+		m_count++;
+	}
+
+	uint32_t count(void) const    { return m_count; }
+	uint32_t wrong(void) const    { return m_wrong; }
+	uint32_t disorder(void) const { return m_disorder; }
+
+private:
+	std::atomic<uint32_t> m_count;
+	std::atomic<uint32_t> m_wrong;
+	std::atomic<uint32_t> m_disorder;
+	uint32_t              m_next;
+};
+
+/**
+ * @brief Consumer that is never started, its queue fills up.
+ */
+template <class Message>
+class Holder : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	explicit Holder(unsigned capacity)
+	{
+		inputs.addPort<Message>(in, capacity);
+	}
+
+	virtual void initialize(void) override { }
+	virtual void process(void) override { }
+};
+
+// Starts a source on an ephemeral port of the loopback interface
+static void start_source(BasicUdpSource<double>& source)
+{
+	UdpConfig local = {};
+	std::snprintf(local.address, sizeof(local.address), "127.0.0.1");
+	send_message(source.inputs[BasicUdpSource<double>::config], local);
+
+	source.start_process();
+
+	const os_tick_t start = os_tick_count();
+	while(source.local_port() == 0 && os_ticks_to_ms(os_tick_count() - start) < timeout_ms) os_delay(1);
+	MFLOW_CHECK(source.local_port() != 0);
+}
+
+// Sends datagrams of the given size to the source and waits until it received them
+static void send_datagrams(BasicUdpSource<double>& source, unsigned count, std::size_t length)
+{
+	const int fd = socket(AF_INET, SOCK_DGRAM, 0);
+	MFLOW_CHECK(fd >= 0);
+
+	struct sockaddr_in address;
+	std::memset(&address, 0, sizeof(address));
+	address.sin_family      = AF_INET;
+	address.sin_port        = htons(source.local_port());
+	address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	uint8_t data[sizeof(Frame<double>)] = {};
+
+	const uint64_t target = source.received() + count;
+	for(unsigned i = 0; i < count; i++) sendto(fd, data, length, 0, reinterpret_cast<struct sockaddr*>(&address), sizeof(address));
+	close(fd);
+
+	const os_tick_t start = os_tick_count();
+	while(source.received() < target && os_ticks_to_ms(os_tick_count() - start) < timeout_ms) os_delay(1);
+	MFLOW_CHECK(source.received() == target);
+}
+
+// A datagram is counted once when no output accepted it, and not at all when one output did
+static void test_counters(void)
+{
+	// Both outputs connected, the views are accepted longer than the frames
+	BasicUdpSource<double>    source;
+	Holder<FrameView<double>> views(4);
+	Holder<Frame<double>>     frames(2);
+
+	connect(source, BasicUdpSource<double>::view, views, Holder<FrameView<double>>::in);
+	connect(source, BasicUdpSource<double>::frame_out, frames, Holder<Frame<double>>::in);
+	start_source(source);
+
+	// Short datagrams are taken as views, their size does not fit the frame output
+	send_datagrams(source, 2, 16);
+	MFLOW_CHECK(source.malformed() == 0);
+	MFLOW_CHECK(source.dropped() == 0);
+
+	// Two frames fill both queues, the other four are dropped once each
+	send_datagrams(source, 6, sizeof(Frame<double>));
+	MFLOW_CHECK(source.malformed() == 0);
+	MFLOW_CHECK(source.dropped() == 4);
+
+	source.stop_process();
+	while(source.is_running()) os_delay(1);
+
+	// Only the frame output connected, short datagrams are malformed
+	BasicUdpSource<double> frame_source;
+	Holder<Frame<double>>  frame_holder(2);
+
+	connect(frame_source, BasicUdpSource<double>::frame_out, frame_holder, Holder<Frame<double>>::in);
+	start_source(frame_source);
+
+	send_datagrams(frame_source, 3, 16);
+	MFLOW_CHECK(frame_source.malformed() == 3);
+	MFLOW_CHECK(frame_source.dropped() == 0);
+
+	frame_source.stop_process();
+	while(frame_source.is_running()) os_delay(1);
+}
+
+// Frames sent by the sink arrive at the source unchanged, and every frame is either delivered or counted as dropped
+static void test_loopback(void)
+{
+	BasicUdpSource<double> source;
+	BasicUdpSink<double>   sink;
+	FrameChecker           checker;
+
+	connect(source, BasicUdpSource<double>::frame_out, checker, FrameChecker::in);
+
+	// The source binds an ephemeral port of the loopback interface
+	UdpConfig local = {};
+	std::snprintf(local.address, sizeof(local.address), "127.0.0.1");
+	send_message(source.inputs[BasicUdpSource<double>::config], local);
+
+	checker.start_process();
+	source.start_process();
+
+	const os_tick_t start = os_tick_count();
+	while(source.local_port() == 0 && os_ticks_to_ms(os_tick_count() - start) < timeout_ms) os_delay(1);
+	MFLOW_CHECK(source.local_port() != 0);
+
+	UdpConfig remote = local;
+	remote.port      = source.local_port();
+	send_message(sink.inputs[BasicUdpSink<double>::config], remote);
+	sink.start_process();
+
+	for(uint32_t k = 0; k < frames; k++)
+	{
+		Frame<double> frame;
+		frame.sequence = k;
+		for(std::size_t i = 0; i < Frame<double>::length; i++) frame.samples[i] = k + 0.5 * i;
+
+		send_message(sink.inputs[BasicUdpSink<double>::frame_in], frame);
+	}
+
+	// Waiting until every datagram is received and handed on or dropped
+	while(checker.count() + source.dropped() < frames && os_ticks_to_ms(os_tick_count() - start) < timeout_ms) os_delay(1);
+
+	MFLOW_CHECK(sink.sent() == frames);
+	MFLOW_CHECK(sink.dropped() == 0);
+	MFLOW_CHECK(source.received() == frames);
+	MFLOW_CHECK(source.malformed() == 0);
+	MFLOW_CHECK(checker.count() + source.dropped() == frames);
+	MFLOW_CHECK(checker.count() > 0);
+	MFLOW_CHECK(checker.wrong() == 0);
+	MFLOW_CHECK(checker.disorder() == 0);
+
+	std::printf("Sent %u frames, %u delivered, %llu dropped\n", (unsigned) frames, (unsigned) checker.count(), (unsigned long long) source.dropped());
+
+	sink.stop_process();
+	source.stop_process();
+	checker.stop_process();
+
+	while(sink.is_running() || source.is_running() || checker.is_running()) os_delay(1);
+}
+
+int main()
+{
+	test_loopback();
+	test_counters();
+
+	return MFLOW_TEST_RESULT();
+}
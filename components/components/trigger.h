@@ -0,0 +1,231 @@
+#pragma once
+#ifndef MFLOW_COMPONENTS_TRIGGER_H_INCLUDED
+#define MFLOW_COMPONENTS_TRIGGER_H_INCLUDED
+
+// Standard includes
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "frame.h"
+#include "sample.h"
+
+
+// Maximum number of samples captured before the trigger
+#ifndef MFLOW_TRIGGER_MAX_PRE
+#define MFLOW_TRIGGER_MAX_PRE (256)
+#endif
+
+/**
+ * @brief Edges of the triggered signal, combined as a mask in the configuration.
+ */
+enum TriggerEdge : uint8_t {
+	TriggerRising  = 0x01U, /**< The signal rose above the high threshold.  */
+	TriggerFalling = 0x02U  /**< The signal fell below the low threshold.   */
+};
+
+/**
+ * @brief Configuration of the Trigger component.
+ */
+struct TriggerConfig {
+	float    high;  /**< Threshold of the rising edges.                          */
+	float    low;   /**< Threshold of the falling edges, at most the high one.  */
+	uint8_t  edges; /**< Mask of the edges starting a capture.                   */
+	unsigned pre;   /**< Number of captured samples before the trigger.          */
+	unsigned post;  /**< Minimum number of captured samples after the trigger.   */
+};
+
+/**
+ * @brief Event emitted by the Trigger component for every threshold crossing.
+ */
+struct TriggerEvent {
+	uint32_t    sequence; /**< Sequence number of the event.                                    */
+	uint32_t    index;    /**< Index of the crossing sample in the stream.                      */
+	TriggerEdge edge;     /**< The direction of the crossing.                                   */
+	float       value;    /**< The crossing sample.                                             */
+	float       peak;     /**< Extremum since the previous event, the minimum for rising edges. */
+	uint32_t    capture;  /**< Sequence number of the first capture frame, or no_capture.       */
+};
+
+/**
+ * @brief   Threshold trigger converting a sample stream into sparse events.
+ * @details A rising event is emitted when the signal reaches the high
+ *          threshold and a falling event when it returns to the low one, so
+ *          noise smaller than the hysteresis does not cause repeated events.
+ *          Events on the edges selected in the configuration also start a
+ *          capture: the pre samples before the crossing and at least post
+ *          samples from the crossing on are sent as frames on the capture
+ *          output, the last frame is completed with further samples. Events
+ *          during a capture do not start another one.
+ */
+template <class Sample>
+class BasicTrigger : public Component {
+public:
+
+	// Port index definitions
+	static constexpr unsigned in       = 0U;
+	static constexpr unsigned frame_in = 1U;
+	static constexpr unsigned config   = 2U;
+	static constexpr unsigned event    = 0U;
+	static constexpr unsigned capture  = 1U;
+
+	// Capture field of events without capture
+	static constexpr uint32_t no_capture = 0xFFFFFFFFU;
+
+	BasicTrigger()
+		: m_high(false),
+		  m_peak(0.0f),
+		  m_index(0),
+		  m_sequence(0),
+		  m_remaining(0),
+		  m_capturing(false)
+	{
+		inputs.addPort<Sample>(in, 1);
+		inputs.addPort<Frame<Sample>>(frame_in, 1);
+		inputs.addPort<TriggerConfig>(config, 1);
+		outputs.addPort<TriggerEvent>(event);
+		outputs.addPort<Frame<Sample>>(capture);
+
+		m_config = { 0.5f, -0.5f, TriggerRising, 0U, 0U };
+	}
+
+	virtual void initialize(void) override
+	{
+		// Reading the trigger configuration
+		auto value = inputs[config].receive<TriggerConfig>();
+		if(value) set_config(value.value());
+	}
+
+	virtual void process(void) override
+	{
+		// Applying configuration changes
+		if(inputs[config].has_message())
+		{
+			auto value = inputs[config].receive<TriggerConfig>();
+			if(value) set_config(value.value());
+		}
+
+		// Waiting for samples or frames
+		auto index = await({in, frame_in});
+		if(!index) return;
+
+		if(index.value() == in)
+		{
+			auto value = inputs[in].receive<Sample>();
+			if(value) update(value.value());
+		}
+		else
+		{
+			auto frame = inputs[frame_in].receive<Frame<Sample>>();
+			if(!frame) return;
+
+			for(std::size_t i = 0; i < Frame<Sample>::length; i++)
+			{
+				if(!update(frame.value()[i])) return;
+			}
+		}
+	}
+
+private:
+
+	void set_config(const TriggerConfig& value)
+	{
+		m_config = value;
+		if(m_config.low > m_config.high) m_config.low = m_config.high;
+		if(m_config.pre > MFLOW_TRIGGER_MAX_PRE) m_config.pre = MFLOW_TRIGGER_MAX_PRE;
+	}
+
+	bool update(const Sample& sample)
+	{
+		const float    x     = sample_traits<Sample>::to_float(sample);
+		const uint32_t index = m_index++;
+		const bool     busy  = m_capturing;
+
+		// Continuing the capture in progress
+		if(busy && !capture_post(sample)) return false;
+
+		// Tracking the extremum of the current state
+		if(index == 0 || (m_high ? x > m_peak : x < m_peak)) m_peak = x;
+
+		// Detecting the crossings of the thresholds with hysteresis
+		if(m_high ? x <= m_config.low : x >= m_config.high)
+		{
+			TriggerEvent record;
+			record.sequence = m_sequence++;
+			record.index    = index;
+			record.edge     = m_high ? TriggerFalling : TriggerRising;
+			record.value    = x;
+			record.peak     = m_peak;
+			record.capture  = no_capture;
+
+			m_high = !m_high;
+			m_peak = x;
+
+			// Starting a capture with the samples before the crossing
+			if(!busy && (m_config.edges & record.edge))
+			{
+				record.capture = m_frames.frame().sequence;
+				if(!start_capture(sample)) return false;
+			}
+
+			if(outputs[event].send<TriggerEvent>(record) != MessageStatus::Okay) return false;
+		}
+
+		// Storing the sample in the pre-trigger history
+		m_history[index % MFLOW_TRIGGER_MAX_PRE] = sample;
+		return true;
+	}
+
+	bool start_capture(const Sample& sample)
+	{
+		// Available history, the crossing sample is not stored yet
+		const uint32_t index  = m_index - 1;
+		const uint32_t stored = index < MFLOW_TRIGGER_MAX_PRE ? index : MFLOW_TRIGGER_MAX_PRE;
+		const unsigned pre    = m_config.pre < stored ? m_config.pre : stored;
+
+		m_capturing = true;
+		m_remaining = m_config.post ? m_config.post : 1U;
+
+		for(unsigned i = pre; i > 0; i--)
+		{
+			if(!append_capture(m_history[(index - i) % MFLOW_TRIGGER_MAX_PRE])) return false;
+		}
+
+		return capture_post(sample);
+	}
+
+	// Captures a sample from the crossing on
+	bool capture_post(const Sample& sample)
+	{
+		if(m_remaining > 0) m_remaining--;
+		return append_capture(sample);
+	}
+
+	// Appends a sample to the capture, sending the completed frames
+	bool append_capture(const Sample& sample)
+	{
+		if(!m_frames.append(sample)) return true;
+
+		const MessageStatus status = outputs[capture].send<Frame<Sample>>(m_frames.frame());
+		m_frames.next();
+
+		// Ending the capture with the first complete frame after the post samples
+		if(m_remaining == 0) m_capturing = false;
+
+		return status == MessageStatus::Okay;
+	}
+
+	Sample                  m_history[MFLOW_TRIGGER_MAX_PRE];
+	FrameAssembler<Sample>  m_frames;
+	TriggerConfig           m_config;
+	bool                    m_high;
+	float                   m_peak;
+	uint32_t                m_index;
+	uint32_t                m_sequence;
+	unsigned                m_remaining;
+	bool                    m_capturing;
+};
+
+typedef BasicTrigger<double> Trigger;
+
+#endif // MFLOW_COMPONENTS_TRIGGER_H_INCLUDED
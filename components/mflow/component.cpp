@@ -10,16 +10,23 @@ Component::Component()
 	// Nothing to do here...
 }
 
+Component::~Component()
+{
+	// Releasing the handle of the finished task
+	os_thread_release(m_thread);
+}
+
 void Component::start_process(void)
 {
-	// Indicating the task that it should run
+	// Indicating the task that it should run, it counts as running until it exits
 	m_should_run = true;
+	m_is_running.store(true, std::memory_order_release);
 
 	// Creating the task to execute this component
-	xTaskCreate(Component::run_process, "", 5000, (void*) this, 10, &m_thread);
+	m_thread = os_thread_create(Component::run_process, (void*) this, "", 5000, 10);
 
 	// Releasing the process for execution
-	xTaskNotify(m_thread, MFLOW_NOTIFICATION_MASK_PROCESS_START, eSetBits);
+	os_thread_notify(m_thread, MFLOW_NOTIFICATION_MASK_PROCESS_START);
 }
 
 void Component::stop_process(void)
@@ -28,7 +35,7 @@ void Component::stop_process(void)
 	m_should_run = false;
 
 	// Notifying the process about the termination request
-	xTaskNotify(m_thread, MFLOW_NOTIFICATION_MASK_PROCESS_SHUTDOWN, eSetBits);
+	os_thread_notify(m_thread, MFLOW_NOTIFICATION_MASK_PROCESS_SHUTDOWN);
 }
 
 bool Component::should_run(void) const
@@ -38,10 +45,15 @@ bool Component::should_run(void) const
 
 bool Component::is_running(void) const
 {
-	return m_is_running;
+	return m_is_running.load(std::memory_order_acquire);
 }
 
 optional<unsigned> Component::await(std::initializer_list<unsigned> input_indices)
+{
+	return await(input_indices.begin(), input_indices.size());
+}
+
+optional<unsigned> Component::await(const unsigned* input_indices, std::size_t count)
 {
 	// Wait for a message to arrive on an input port or process termination
 	while(true) {
@@ -54,8 +66,10 @@ optional<unsigned> Component::await(std::initializer_list<unsigned> input_indice
 		}
 
 		// Checking if one of the input ports has a message available
-		for(auto index : input_indices)
+		for(std::size_t i = 0; i < count; i++)
 		{
+			const unsigned index = input_indices[i];
+
 			if(inputs[index].has_message())
 			{
 				// Found a message, return with the input port index
@@ -63,11 +77,75 @@ optional<unsigned> Component::await(std::initializer_list<unsigned> input_indice
 			}
 		}
 
-		// Notification value to read into
-		uint32_t notification;
-
 		// Blocking until a message arrival notification is received
-		xTaskNotifyWait(0x00000000, MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL, &notification, portMAX_DELAY);
+		os_thread_wait(0x00000000, MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL, nullptr, MFLOW_OS_WAIT_FOREVER);
+	}
+}
+
+MessageStatus Component::await(WaitSet& wait_set)
+{
+	wait_set.clear_ready();
+
+	// Wait for a member of the set to become ready or process termination
+	while(true) {
+
+		// Checking if the Component has been asked to terminate
+		if(!should_run()) return MessageStatus::Terminated;
+
+		bool ready = false;
+
+		// Checking the input ports of the set
+		for(unsigned i = 0; i < wait_set.m_port_count; i++)
+		{
+			wait_set.m_port_ready[i] = inputs[wait_set.m_ports[i]].has_message();
+			ready = ready || wait_set.m_port_ready[i];
+		}
+
+		// Checking the timer of the set, periodic timers are advanced by one period
+		uint32_t timeout_ms = MFLOW_OS_WAIT_FOREVER;
+
+		if(wait_set.m_timer_armed)
+		{
+			const int32_t remaining = (int32_t) (wait_set.m_deadline - os_tick_count());
+
+			if(remaining <= 0)
+			{
+				wait_set.m_timer_expired = true;
+				wait_set.m_timer_armed   = wait_set.m_period != 0;
+				wait_set.m_deadline     += wait_set.m_period;
+				ready = true;
+			}
+			else timeout_ms = os_ticks_to_ms((os_tick_t) remaining);
+		}
+
+		if(ready) timeout_ms = 0;
+
+#if !defined(ESP_PLATFORM)
+		// Waiting for notifications and descriptors in one call, or collecting the ready descriptors
+		if(wait_set.m_fd_count > 0)
+		{
+			os_poll_event events[MFLOW_WAIT_MAX_FDS];
+			const int     count = os_poll_wait(wait_set.m_poll, events, MFLOW_WAIT_MAX_FDS,
+			                                   MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL, timeout_ms);
+
+			for(int e = 0; e < count; e++)
+			{
+				for(unsigned i = 0; i < wait_set.m_fd_count; i++)
+				{
+					if(wait_set.m_fds[i] == events[e].fd) wait_set.m_fd_events[i] = events[e].events;
+				}
+			}
+
+			if(count > 0 || ready) return MessageStatus::Okay;
+			if(count < 0) return MessageStatus::Error;
+			continue;
+		}
+#endif
+
+		if(ready) return MessageStatus::Okay;
+
+		// Blocking until a message arrival notification is received or the timer expires
+		os_thread_wait(0x00000000, MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL, nullptr, timeout_ms);
 	}
 }
 
@@ -102,28 +180,29 @@ void Component::run_process(void* p_process)
 
 	// Blocking until the process is released for execution
 	while(!(notification & MFLOW_NOTIFICATION_MASK_PROCESS_START)) {
-		xTaskNotifyWait(MFLOW_NOTIFICATION_MASK_PROCESS_START, MFLOW_NOTIFICATION_MASK_PROCESS_START,
-					    &notification, portMAX_DELAY);
+		os_thread_wait(MFLOW_NOTIFICATION_MASK_PROCESS_START, MFLOW_NOTIFICATION_MASK_PROCESS_START,
+		               &notification, MFLOW_OS_WAIT_FOREVER);
 	}
 
-	process->m_is_running = true;
-
-	ESP_LOGI("", "Component initializing.");
+	MFLOW_LOGI("", "Component initializing.");
 
 	process->initialize();
 
-	ESP_LOGI("", "Component running.");
+	MFLOW_LOGI("", "Component running.");
 
 	while(process->m_should_run)
 	{
 		process->process();
 	}
 
-	process->m_is_running = false;
+	process->finalize();
+
+	// The component must not be accessed after this point, it may be destroyed
+	process->m_is_running.store(false, std::memory_order_release);
 
-	ESP_LOGI("", "Component shutting down.");
+	MFLOW_LOGI("", "Component shutting down.");
 
-	vTaskDelete(nullptr);
+	os_thread_exit();
 }
 
 void connect(Component& source, unsigned source_index, Component& target, unsigned target_index)
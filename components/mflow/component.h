@@ -3,15 +3,14 @@
 #define MFLOW_COMPONENT_H_INCLUDED
 
 // Standard includes
+#include <atomic>
 #include <map>
 
-// FreeRTOS includes
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-
 // Project includes
 #include "mflow_config.h"
+#include "os.h"
 #include "port.h"
+#include "wait_set.h"
 
 
 /**
@@ -49,7 +48,7 @@ public:
 	 * @details Use the destructor to release any dynamic resources
 	 *          allocated by the component.
 	 */
-	virtual ~Component() = default;
+	virtual ~Component();
 
 	/**
 	 * @brief   Initializes the component.
@@ -71,6 +70,15 @@ public:
 	 */
 	virtual void process(void) = 0;
 
+	/**
+	 * @brief   Finalizes the component.
+	 * @details This method is called exactly once from the executing
+	 *          thread after the last call to the process method, when
+	 *          the component has been signalled to stop. Use it to
+	 *          flush buffers and stop helper tasks of the component.
+	 */
+	virtual void finalize(void) { }
+
 	/**
 	 * @brief Signals the process that it can start execution.
 	 */
@@ -87,7 +95,10 @@ public:
 	bool should_run(void) const;
 
 	/**
-	 * @brief Returns whether the task is actually executing.
+	 * @brief   Returns whether the task is executing.
+	 * @details Set when the process is started, before its task is
+	 *          scheduled, and cleared by the task after finalization,
+	 *          so the component may be destroyed once it reads false.
 	 */
 	bool is_running(void) const;
 
@@ -178,10 +189,28 @@ protected:
 	 */
 	optional<unsigned> await(std::initializer_list<unsigned> input_indices);
 
+	/**
+	 * @brief  Blocks execution of the component until an input port receives a message.
+	 * @param  input_indices [in] Array of input port indices to wait for.
+	 * @param  count         [in] The number of indices in the array.
+	 * @retval Optional value containing the input index that has a message or error status.
+	 */
+	optional<unsigned> await(const unsigned* input_indices, std::size_t count);
+
+	/**
+	 * @brief   Blocks execution of the component until a member of the wait set is ready.
+	 * @details Returns when an input port of the set has a message, the timer
+	 *          of the set fires or, on Linux, a file descriptor of the set is
+	 *          ready. The set reports all members that were ready on return.
+	 * @param   wait_set [in,out] The ports, timer and file descriptors to wait for.
+	 * @retval  Okay when a member is ready, Terminated when the component should stop.
+	 */
+	MessageStatus await(WaitSet& wait_set);
+
 private:
-	TaskHandle_t  m_thread;     /**< Handle to the task executing this Component.           */
-	volatile bool m_should_run; /**< Flag to indicate whether the Component should execute. */
-	volatile bool m_is_running; /**< Flag to indicate whether the Component is executing.   */
+	os_thread_t       m_thread;     /**< Handle to the task executing this Component.           */
+	volatile bool     m_should_run; /**< Flag to indicate whether the Component should execute. */
+	std::atomic<bool> m_is_running; /**< Flag to indicate whether the Component is executing.   */
 
 	/**
 	 * @brief Executes the process in a separate thread.
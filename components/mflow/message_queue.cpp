@@ -1,28 +1,28 @@
 #include "message_queue.h"
 
 
-MessageQueue::MessageQueue(std::size_t element_size, std::size_t capacity, TaskHandle_t* p_reader_thread)
+MessageQueue::MessageQueue(std::size_t element_size, std::size_t capacity, os_thread_t* p_reader_thread)
 	: m_reader_thread(p_reader_thread),
 	  m_capacity(capacity),
 	  m_closed(false),
-	  m_queue(xQueueCreate(capacity, element_size))
+	  m_queue(os_queue_create(element_size, capacity))
 {
 	// Nothing to do here...
 }
 
 MessageQueue::~MessageQueue()
 {
-	vQueueDelete(m_queue);
+	os_queue_delete(m_queue);
 }
 
 bool MessageQueue::has_message(void) const
 {
-	return !xQueueIsQueueEmptyFromISR(m_queue);
+	return !os_queue_empty(m_queue);
 }
 
 std::size_t MessageQueue::message_count(void) const
 {
-	return uxQueueMessagesWaiting(m_queue);
+	return os_queue_count(m_queue);
 }
 
 std::size_t MessageQueue::capacity(void) const
@@ -43,15 +43,15 @@ bool MessageQueue::is_closed(void) const
 bool MessageQueue::push_message(const void* p_message, uint32_t timeout_ms)
 {
 	// Sending the message to the target queue
-	bool status = xQueueSendToBack(m_queue, p_message, timeout_ms / portTICK_RATE_MS) == pdTRUE;
+	bool status = os_queue_send(m_queue, p_message, timeout_ms);
 
 	// Notifying task waiting for this queue
-	if(status && *m_reader_thread) xTaskNotify(*m_reader_thread, MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL, eSetBits);
+	if(status && *m_reader_thread) os_thread_notify(*m_reader_thread, MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL);
 
 	return status;
 }
 
 void MessageQueue::pop_message(void* p_message)
 {
-	xQueueReceive(m_queue, p_message, portMAX_DELAY);
+	os_queue_receive(m_queue, p_message, MFLOW_OS_WAIT_FOREVER);
 }
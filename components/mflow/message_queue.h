@@ -5,17 +5,13 @@
 // Standard includes
 #include <cstdint>
 
-// FreeRTOS includes
-#include "freertos/FreeRTOS.h"
-#include "freertos/queue.h"
-#include "freertos/task.h"
-
 // Project includes
 #include "mflow_config.h"
+#include "os.h"
 
 
 /**
- * @brief   The MessageQueue class encapsulates a FreeRTOS queue.
+ * @brief   The MessageQueue class encapsulates an operating system queue.
  * @details This class is used by components to pass data between
  *          running processes. The message queue is created by an
  *          input port and referenced by output ports. The message
@@ -32,10 +28,10 @@ public:
 	 * @param capacity        [in] The maximum number of messages in the queue.
 	 * @param p_reader_thread [in] Pointer to the thread handle of the queue reader.
 	 */
-	MessageQueue(std::size_t element_size, std::size_t capacity, TaskHandle_t* p_reader_thread);
+	MessageQueue(std::size_t element_size, std::size_t capacity, os_thread_t* p_reader_thread);
 
 	/**
-	 * @brief Destroys the MessageQueue and releases allocated FreeRTOS resources.
+	 * @brief Destroys the MessageQueue and releases allocated operating system resources.
 	 */
 	~MessageQueue();
 
@@ -83,10 +79,10 @@ public:
 	void pop_message(void* p_message);
 
 private:
-	TaskHandle_t* m_reader_thread; /**< Pointer to the thread reading from the queue.       */
+	os_thread_t*  m_reader_thread; /**< Pointer to the thread reading from the queue.       */
 	std::size_t   m_capacity;      /**< The maximum number of messages the queue can store. */
 	volatile bool m_closed;        /**< Flag indicating that the reader thread stopped.     */
-	QueueHandle_t m_queue;         /**< Handle for the underlying FreeRTOS queue.           */
+	os_queue_t    m_queue;         /**< Handle for the underlying operating system queue.   */
 };
 
 #endif // MFLOW_MESSAGE_QUEUE_H_INCLUDED
@@ -2,7 +2,7 @@
 #ifndef MFLOW_MFLOW_CONFIG_H_INCLUDED
 #define MFLOW_MFLOW_CONFIG_H_INCLUDED
 
-#include "esp_log.h"
+#include "os.h"
 
 #define MFLOW_MESSAGE_PUSH_ATTEMPT_TIMEOUT_MS    (100)
 
@@ -0,0 +1,288 @@
+#pragma once
+#ifndef MFLOW_OS_H_INCLUDED
+#define MFLOW_OS_H_INCLUDED
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+
+#if defined(ESP_PLATFORM)
+
+// FreeRTOS includes
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+// ESP-IDF includes
+#include "esp_log.h"
+
+#else
+
+// Standard includes
+#include <cstdio>
+
+// Linux includes
+#include <sys/epoll.h>
+
+#endif
+
+
+// The functions below form the operating system abstraction layer of
+// mflow. Components and the runtime use only these primitives, so the
+// same graphs run as FreeRTOS tasks on the ESP32 (os_freertos.cpp) and
+// as native threads on Linux hosts (os_linux.cpp). The interface follows
+// the FreeRTOS primitives closely, so the embedded implementation is a
+// thin wrapper. Timeouts are given in milliseconds, ticks are the unit
+// of the scheduler clock: the FreeRTOS tick, or one millisecond on Linux.
+
+#if defined(ESP_PLATFORM)
+
+typedef TaskHandle_t      os_thread_t;    /**< Handle of a thread.           */
+typedef QueueHandle_t     os_queue_t;     /**< Handle of a message queue.    */
+typedef SemaphoreHandle_t os_semaphore_t; /**< Handle of a binary semaphore. */
+typedef TickType_t        os_tick_t;      /**< Scheduler clock value.        */
+
+#define MFLOW_LOGI(tag, format, ...) ESP_LOGI(tag, format, ##__VA_ARGS__)
+#define MFLOW_LOGW(tag, format, ...) ESP_LOGW(tag, format, ##__VA_ARGS__)
+#define MFLOW_LOGE(tag, format, ...) ESP_LOGE(tag, format, ##__VA_ARGS__)
+
+#else
+
+typedef struct os_thread*    os_thread_t;    /**< Handle of a thread.           */
+typedef struct os_queue*     os_queue_t;     /**< Handle of a message queue.    */
+typedef struct os_semaphore* os_semaphore_t; /**< Handle of a binary semaphore. */
+typedef uint32_t             os_tick_t;      /**< Scheduler clock value.        */
+typedef struct os_poll*      os_poll_t;      /**< Handle of a descriptor set.   */
+
+/**
+ * @brief Readiness of a file descriptor reported by #os_poll_wait().
+ */
+struct os_poll_event {
+	int      fd;     /**< The ready file descriptor.   */
+	uint32_t events; /**< The ready epoll event flags. */
+};
+
+#define MFLOW_LOGI(tag, format, ...) std::fprintf(stderr, "I %s: " format "\n", tag, ##__VA_ARGS__)
+#define MFLOW_LOGW(tag, format, ...) std::fprintf(stderr, "W %s: " format "\n", tag, ##__VA_ARGS__)
+#define MFLOW_LOGE(tag, format, ...) std::fprintf(stderr, "E %s: " format "\n", tag, ##__VA_ARGS__)
+
+#endif
+
+// Timeout value blocking without limit
+#define MFLOW_OS_WAIT_FOREVER (0xFFFFFFFFU)
+
+/**
+ * @brief Entry function of threads, receives the argument given at creation.
+ */
+typedef void (*os_thread_function_t)(void* p_argument);
+
+/**
+ * @brief  Creates and starts a new thread.
+ * @param  function   [in] The entry function of the thread.
+ * @param  p_argument [in] The argument passed to the entry function.
+ * @param  name       [in] The name of the thread, for debugging.
+ * @param  stack_size [in] The stack size in bytes, ignored on Linux.
+ * @param  priority   [in] The FreeRTOS priority, ignored on Linux.
+ * @retval Handle of the created thread, or null on failure.
+ */
+os_thread_t os_thread_create(os_thread_function_t function, void* p_argument, const char* name,
+                             std::size_t stack_size, unsigned priority);
+
+/**
+ * @brief   Terminates the calling thread.
+ * @details Must be the last call of the entry function. On Linux the
+ *          thread ends when the entry function returns, the handle
+ *          stays valid until released with #os_thread_release().
+ */
+void os_thread_exit(void);
+
+/**
+ * @brief Releases the resources of a terminated thread.
+ * @param thread [in] Handle of the thread, may be null.
+ */
+void os_thread_release(os_thread_t thread);
+
+/**
+ * @brief Sets notification bits of a thread and wakes it when waiting.
+ * @param thread [in] Handle of the thread to notify.
+ * @param bits   [in] The bits to set in the notification value.
+ */
+void os_thread_notify(os_thread_t thread, uint32_t bits);
+
+/**
+ * @brief   Waits for a notification of the calling thread.
+ * @details Semantics of xTaskNotifyWait(): the entry bits are cleared
+ *          when no notification is pending yet, the exit bits are cleared
+ *          after a notification is received.
+ * @param   clear_on_entry [in]  Bits to clear before waiting.
+ * @param   clear_on_exit  [in]  Bits to clear after a notification.
+ * @param   p_value        [out] The notification value before clearing, may be null.
+ * @param   timeout_ms     [in]  The timeout in milliseconds.
+ * @retval  True when a notification was received, false on timeout.
+ */
+bool os_thread_wait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* p_value, uint32_t timeout_ms);
+
+/**
+ * @brief Blocks the calling thread for at least the specified time.
+ * @param milliseconds [in] The time to block, zero yields the processor.
+ */
+void os_delay(uint32_t milliseconds);
+
+/**
+ * @brief   Blocks the calling thread until a periodic wake time.
+ * @details The wake time is advanced by the period, so the period does
+ *          not drift with the execution time of the thread. The period is
+ *          rounded up to whole ticks, a zero period only yields.
+ * @param   p_wake       [in,out] The previous wake time, from #os_tick_count().
+ * @param   milliseconds [in]     The period in milliseconds.
+ */
+void os_delay_until(os_tick_t* p_wake, uint32_t milliseconds);
+
+/**
+ * @brief  Queries the scheduler clock.
+ * @retval The number of ticks since the start of the scheduler.
+ */
+os_tick_t os_tick_count(void);
+
+/**
+ * @brief  Converts milliseconds to scheduler ticks, rounding up.
+ * @param  milliseconds [in] The time in milliseconds, a non-zero time is at least one tick.
+ * @retval The time in ticks.
+ */
+os_tick_t os_ms_to_ticks(uint32_t milliseconds);
+
+/**
+ * @brief  Converts scheduler ticks to milliseconds.
+ * @param  ticks [in] The time in ticks.
+ * @retval The time in milliseconds.
+ */
+uint32_t os_ticks_to_ms(os_tick_t ticks);
+
+/**
+ * @brief  Creates a bounded message queue of fixed size elements.
+ * @param  element_size [in] The size of each message in bytes.
+ * @param  capacity     [in] The maximum number of messages in the queue.
+ * @retval Handle of the created queue.
+ */
+os_queue_t os_queue_create(std::size_t element_size, std::size_t capacity);
+
+/**
+ * @brief Destroys a message queue.
+ * @param queue [in] Handle of the queue.
+ */
+void os_queue_delete(os_queue_t queue);
+
+/**
+ * @brief  Copies a message to the back of the queue, waiting for free space.
+ * @param  queue      [in] Handle of the queue.
+ * @param  p_message  [in] Pointer to the message to copy.
+ * @param  timeout_ms [in] The timeout in milliseconds.
+ * @retval True when the message was queued, false on timeout.
+ */
+bool os_queue_send(os_queue_t queue, const void* p_message, uint32_t timeout_ms);
+
+/**
+ * @brief  Copies the message at the front of the queue, waiting for a message.
+ * @param  queue      [in]  Handle of the queue.
+ * @param  p_message  [out] Pointer where the message is copied.
+ * @param  timeout_ms [in]  The timeout in milliseconds.
+ * @retval True when a message was received, false on timeout.
+ */
+bool os_queue_receive(os_queue_t queue, void* p_message, uint32_t timeout_ms);
+
+/**
+ * @brief  Queries whether the queue is empty, without locking on FreeRTOS.
+ * @param  queue [in] Handle of the queue.
+ * @retval True when the queue contains no messages, false otherwise.
+ */
+bool os_queue_empty(os_queue_t queue);
+
+/**
+ * @brief  Queries the number of messages in the queue.
+ * @param  queue [in] Handle of the queue.
+ * @retval The number of messages currently in the queue.
+ */
+std::size_t os_queue_count(os_queue_t queue);
+
+/**
+ * @brief  Creates a binary semaphore, initially taken.
+ * @retval Handle of the created semaphore.
+ */
+os_semaphore_t os_semaphore_create(void);
+
+/**
+ * @brief Destroys a binary semaphore.
+ * @param semaphore [in] Handle of the semaphore.
+ */
+void os_semaphore_delete(os_semaphore_t semaphore);
+
+/**
+ * @brief Gives the semaphore, waking a thread waiting for it.
+ * @param semaphore [in] Handle of the semaphore.
+ */
+void os_semaphore_give(os_semaphore_t semaphore);
+
+/**
+ * @brief  Takes the semaphore, waiting until it is given.
+ * @param  semaphore  [in] Handle of the semaphore.
+ * @param  timeout_ms [in] The timeout in milliseconds.
+ * @retval True when the semaphore was taken, false on timeout.
+ */
+bool os_semaphore_take(os_semaphore_t semaphore, uint32_t timeout_ms);
+
+#if !defined(ESP_PLATFORM)
+
+// The descriptor sets below extend the thread notifications with file
+// descriptors on Linux: a thread blocks in one epoll call until any of
+// its descriptors is ready or it is notified. Notifications reach the
+// sleeping thread through an eventfd, which is written only while the
+// thread waits in #os_poll_wait().
+
+/**
+ * @brief  Creates an empty descriptor set.
+ * @retval Handle of the created set, or null on failure.
+ */
+os_poll_t os_poll_create(void);
+
+/**
+ * @brief Destroys a descriptor set, the descriptors are not closed.
+ * @param poll [in] Handle of the set.
+ */
+void os_poll_delete(os_poll_t poll);
+
+/**
+ * @brief  Adds a file descriptor to the set.
+ * @param  poll   [in] Handle of the set.
+ * @param  fd     [in] The file descriptor to watch.
+ * @param  events [in] The epoll event flags to watch, like EPOLLIN.
+ * @retval True on success, false otherwise.
+ */
+bool os_poll_add(os_poll_t poll, int fd, uint32_t events);
+
+/**
+ * @brief  Removes a file descriptor from the set.
+ * @param  poll [in] Handle of the set.
+ * @param  fd   [in] The file descriptor to remove.
+ * @retval True on success, false otherwise.
+ */
+bool os_poll_remove(os_poll_t poll, int fd);
+
+/**
+ * @brief   Waits for a notification of the calling thread or ready descriptors.
+ * @details Returns when a notification is received, when any descriptor of
+ *          the set is ready, or on timeout. A received notification is
+ *          consumed like in #os_thread_wait(), the ready descriptors are
+ *          reported in the event array.
+ * @param   poll          [in]  Handle of the set.
+ * @param   p_events      [out] Array receiving the ready descriptors.
+ * @param   max_events    [in]  The capacity of the event array.
+ * @param   clear_on_exit [in]  Notification bits to clear after a notification.
+ * @param   timeout_ms    [in]  The timeout in milliseconds.
+ * @retval  The number of ready descriptors, or -1 on error.
+ */
+int os_poll_wait(os_poll_t poll, os_poll_event* p_events, int max_events, uint32_t clear_on_exit, uint32_t timeout_ms);
+
+#endif
+
+#endif // MFLOW_OS_H_INCLUDED
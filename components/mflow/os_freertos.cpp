@@ -0,0 +1,128 @@
+#include "os.h"
+
+#if defined(ESP_PLATFORM)
+
+
+// Converts milliseconds to ticks, rounding up so short delays still block
+static TickType_t to_ticks(uint32_t milliseconds)
+{
+	if(milliseconds == MFLOW_OS_WAIT_FOREVER) return portMAX_DELAY;
+	return (milliseconds + portTICK_RATE_MS - 1) / portTICK_RATE_MS;
+}
+
+os_thread_t os_thread_create(os_thread_function_t function, void* p_argument, const char* name,
+                             std::size_t stack_size, unsigned priority)
+{
+	TaskHandle_t thread = nullptr;
+
+	if(xTaskCreate(function, name, stack_size, p_argument, priority, &thread) != pdPASS) return nullptr;
+
+	return thread;
+}
+
+void os_thread_exit(void)
+{
+	vTaskDelete(nullptr);
+}
+
+void os_thread_release(os_thread_t thread)
+{
+	// Deleted tasks are cleaned up by the idle task
+	(void) thread;
+}
+
+void os_thread_notify(os_thread_t thread, uint32_t bits)
+{
+	xTaskNotify(thread, bits, eSetBits);
+}
+
+bool os_thread_wait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* p_value, uint32_t timeout_ms)
+{
+	uint32_t value = 0x00000000;
+
+	const bool status = xTaskNotifyWait(clear_on_entry, clear_on_exit, &value, to_ticks(timeout_ms)) == pdTRUE;
+	if(p_value) *p_value = value;
+
+	return status;
+}
+
+void os_delay(uint32_t milliseconds)
+{
+	vTaskDelay(to_ticks(milliseconds));
+}
+
+void os_delay_until(os_tick_t* p_wake, uint32_t milliseconds)
+{
+	const TickType_t period = to_ticks(milliseconds);
+
+	// A zero period would trip the assertion of vTaskDelayUntil(), the wake time is already due
+	if(period == 0) taskYIELD();
+	else            vTaskDelayUntil(p_wake, period);
+}
+
+os_tick_t os_tick_count(void)
+{
+	return xTaskGetTickCount();
+}
+
+os_tick_t os_ms_to_ticks(uint32_t milliseconds)
+{
+	return to_ticks(milliseconds);
+}
+
+uint32_t os_ticks_to_ms(os_tick_t ticks)
+{
+	return ticks * portTICK_RATE_MS;
+}
+
+os_queue_t os_queue_create(std::size_t element_size, std::size_t capacity)
+{
+	return xQueueCreate(capacity, element_size);
+}
+
+void os_queue_delete(os_queue_t queue)
+{
+	vQueueDelete(queue);
+}
+
+bool os_queue_send(os_queue_t queue, const void* p_message, uint32_t timeout_ms)
+{
+	return xQueueSendToBack(queue, p_message, to_ticks(timeout_ms)) == pdTRUE;
+}
+
+bool os_queue_receive(os_queue_t queue, void* p_message, uint32_t timeout_ms)
+{
+	return xQueueReceive(queue, p_message, to_ticks(timeout_ms)) == pdTRUE;
+}
+
+bool os_queue_empty(os_queue_t queue)
+{
+	return xQueueIsQueueEmptyFromISR(queue);
+}
+
+std::size_t os_queue_count(os_queue_t queue)
+{
+	return uxQueueMessagesWaiting(queue);
+}
+
+os_semaphore_t os_semaphore_create(void)
+{
+	return xSemaphoreCreateBinary();
+}
+
+void os_semaphore_delete(os_semaphore_t semaphore)
+{
+	vSemaphoreDelete(semaphore);
+}
+
+void os_semaphore_give(os_semaphore_t semaphore)
+{
+	xSemaphoreGive(semaphore);
+}
+
+bool os_semaphore_take(os_semaphore_t semaphore, uint32_t timeout_ms)
+{
+	return xSemaphoreTake(semaphore, to_ticks(timeout_ms)) == pdTRUE;
+}
+
+#endif // ESP_PLATFORM
@@ -0,0 +1,603 @@
+#include "os.h"
+
+#if !defined(ESP_PLATFORM)
+
+// Standard includes
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+// Linux includes
+#include <linux/futex.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+
+// Size of a cache line, shared counters are placed on separate lines
+static constexpr std::size_t cache_line_size = 64U;
+
+// Notification states of a thread
+static constexpr uint32_t notify_idle    = 0U;
+static constexpr uint32_t notify_pending = 1U;
+static constexpr uint32_t notify_waiting = 2U;
+static constexpr uint32_t notify_polling = 3U;
+
+// Maximum number of descriptor events read by one epoll call
+static constexpr int poll_batch = 32;
+
+typedef std::chrono::steady_clock clock_type;
+
+// Start of the scheduler clock
+static const clock_type::time_point s_epoch = clock_type::now();
+
+/**
+ * @brief   Thread state, the notification word doubles as a futex.
+ * @details The eventfd is created when the thread first waits on a
+ *          descriptor set, notifiers write it in the polling state. The
+ *          bits are changed together with the pending state under the
+ *          lock, so clearing them on entry or exit never removes the bits
+ *          of a notification that is still pending.
+ */
+struct os_thread {
+	os_thread_function_t  function; /**< The entry function of the thread.            */
+	void*                 argument; /**< The argument passed to the entry function.   */
+	char                  name[16]; /**< The name of the thread, truncated for Linux. */
+	std::atomic<uint32_t> value;    /**< The notification bits.                       */
+	std::atomic<uint32_t> state;    /**< Idle, pending, waiting or polling.           */
+	std::mutex            lock;     /**< Orders the bits with the pending state.      */
+	int                   event_fd; /**< Eventfd waking the polling thread.           */
+
+	os_thread(void) : function(nullptr), argument(nullptr), name(), value(0U), state(notify_idle), event_fd(-1) { }
+
+	~os_thread() { if(event_fd >= 0) close(event_fd); }
+};
+
+/**
+ * @brief Descriptor set of a thread, an epoll instance.
+ */
+struct os_poll {
+	int        epoll_fd; /**< The epoll instance.                        */
+	os_thread* owner;    /**< The thread whose eventfd is in the set.    */
+};
+
+/**
+ * @brief   Bounded multi-producer, multi-consumer queue of fixed size elements.
+ * @details Every cell carries a sequence number telling whether it is free
+ *          for the producer or readable for the consumer at the current
+ *          position, so producers and consumers only contend on their own
+ *          position counter. The sequence is twice the position for a free
+ *          cell and one more for a readable one, which keeps the two states
+ *          apart even when the queue has a single cell. Blocked producers
+ *          and consumers sleep on event counters, which are only signalled
+ *          while someone is waiting.
+ */
+struct os_queue {
+	typedef std::atomic<std::size_t> position_type;
+
+	std::size_t                              element_size; /**< The size of each message in bytes.        */
+	std::size_t                              capacity;     /**< The maximum number of messages.           */
+	std::unique_ptr<position_type[]>         sequence;     /**< The sequence number of every cell.        */
+	std::unique_ptr<uint8_t[]>               storage;      /**< The message storage of the cells.         */
+	alignas(cache_line_size) position_type   head;         /**< The next position to write.               */
+	alignas(cache_line_size) position_type   tail;         /**< The next position to read.                */
+	alignas(cache_line_size) position_type   count;        /**< The number of readable messages.          */
+	std::atomic<uint32_t>                    pushed;       /**< Event counter of written messages.        */
+	std::atomic<uint32_t>                    popped;       /**< Event counter of read messages.           */
+	std::atomic<uint32_t>                    readers;      /**< Number of consumers waiting for messages. */
+	std::atomic<uint32_t>                    writers;      /**< Number of producers waiting for space.    */
+};
+
+/**
+ * @brief Binary semaphore, the word doubles as a futex.
+ */
+struct os_semaphore {
+	std::atomic<uint32_t> given; /**< One when the semaphore is given. */
+};
+
+// Handle of the calling thread, created on demand for threads not started by mflow
+static thread_local os_thread*                 t_current = nullptr;
+static thread_local std::unique_ptr<os_thread> t_foreign;
+
+static uint32_t* futex_word(std::atomic<uint32_t>* p_word)
+{
+	static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Atomic words must be usable as futexes.");
+	return reinterpret_cast<uint32_t*>(p_word);
+}
+
+// Blocks while the word holds the expected value, at most for the given time
+static void futex_wait(std::atomic<uint32_t>* p_word, uint32_t expected, uint32_t timeout_ms)
+{
+	struct timespec  timeout;
+	struct timespec* p_timeout = nullptr;
+
+	if(timeout_ms != MFLOW_OS_WAIT_FOREVER)
+	{
+		timeout.tv_sec  = timeout_ms / 1000U;
+		timeout.tv_nsec = (long) (timeout_ms % 1000U) * 1000000L;
+		p_timeout       = &timeout;
+	}
+
+	syscall(SYS_futex, futex_word(p_word), FUTEX_WAIT_PRIVATE, expected, p_timeout, nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t>* p_word, int count)
+{
+	syscall(SYS_futex, futex_word(p_word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+}
+
+/**
+ * @brief Tracks the time left of a timeout.
+ */
+class Deadline {
+public:
+	explicit Deadline(uint32_t timeout_ms)
+		: m_forever(timeout_ms == MFLOW_OS_WAIT_FOREVER),
+		  m_end(clock_type::now() + std::chrono::milliseconds(m_forever ? 0U : timeout_ms))
+	{
+		// Nothing to do here...
+	}
+
+	// Remaining milliseconds rounded up, zero when expired
+	uint32_t remaining(void) const
+	{
+		if(m_forever) return MFLOW_OS_WAIT_FOREVER;
+
+		const auto left = std::chrono::duration_cast<std::chrono::microseconds>(m_end - clock_type::now()).count();
+		return left > 0 ? (uint32_t) ((left + 999) / 1000) : 0U;
+	}
+
+private:
+	bool                   m_forever;
+	clock_type::time_point m_end;
+};
+
+static os_thread* current_thread(void)
+{
+	if(t_current == nullptr)
+	{
+		t_foreign.reset(new os_thread());
+		t_current = t_foreign.get();
+	}
+
+	return t_current;
+}
+
+os_thread_t os_thread_create(os_thread_function_t function, void* p_argument, const char* name,
+                             std::size_t stack_size, unsigned priority)
+{
+	(void) stack_size;
+	(void) priority;
+
+	os_thread* thread = new os_thread();
+	thread->function  = function;
+	thread->argument  = p_argument;
+	std::strncpy(thread->name, name ? name : "", sizeof(thread->name) - 1);
+
+	// Running the entry function with the handle of the thread registered
+	std::thread([thread]() {
+		t_current = thread;
+		if(thread->name[0] != '\0') pthread_setname_np(pthread_self(), thread->name);
+		thread->function(thread->argument);
+	}).detach();
+
+	return thread;
+}
+
+void os_thread_exit(void)
+{
+	// The thread ends when its entry function returns
+	t_current = nullptr;
+}
+
+void os_thread_release(os_thread_t thread)
+{
+	delete thread;
+}
+
+void os_thread_notify(os_thread_t thread, uint32_t bits)
+{
+	uint32_t state;
+
+	// Publishing the bits and the pending state at once
+	{
+		std::lock_guard<std::mutex> guard(thread->lock);
+		thread->value.fetch_or(bits, std::memory_order_release);
+		state = thread->state.exchange(notify_pending, std::memory_order_acq_rel);
+	}
+
+	// Waking the thread only when it sleeps, notifying a busy thread costs no system call
+
+	if(state == notify_waiting)
+	{
+		futex_wake(&thread->state, 1);
+	}
+	else if(state == notify_polling)
+	{
+		const uint64_t increment = 1U;
+		if(write(thread->event_fd, &increment, sizeof(increment)) < 0) { /* The counter is already set */ }
+	}
+}
+
+bool os_thread_wait(uint32_t clear_on_entry, uint32_t clear_on_exit, uint32_t* p_value, uint32_t timeout_ms)
+{
+	os_thread*     self  = current_thread();
+	const Deadline deadline(timeout_ms);
+	uint32_t       state;
+
+	// Clearing the bits on entry only when no notification is pending
+	{
+		std::lock_guard<std::mutex> guard(self->lock);
+		state = self->state.load(std::memory_order_acquire);
+		if(state != notify_pending) self->value.fetch_and(~clear_on_entry, std::memory_order_relaxed);
+	}
+
+	while(state != notify_pending)
+	{
+		// Announcing the sleep, the notifier wakes the thread only in this state
+		if(state == notify_idle)
+		{
+			if(!self->state.compare_exchange_weak(state, notify_waiting, std::memory_order_acq_rel)) continue;
+			state = notify_waiting;
+		}
+
+		const uint32_t remaining = deadline.remaining();
+
+		if(remaining == 0)
+		{
+			// Withdrawing from waiting, unless a notification arrived meanwhile
+			if(self->state.compare_exchange_strong(state, notify_idle, std::memory_order_acq_rel))
+			{
+				if(p_value) *p_value = self->value.load(std::memory_order_acquire);
+				return false;
+			}
+
+			continue;
+		}
+
+		futex_wait(&self->state, notify_waiting, remaining);
+		state = self->state.load(std::memory_order_acquire);
+	}
+
+	// Consuming the notification
+	uint32_t value;
+	{
+		std::lock_guard<std::mutex> guard(self->lock);
+		self->state.store(notify_idle, std::memory_order_relaxed);
+		value = self->value.fetch_and(~clear_on_exit, std::memory_order_acq_rel);
+	}
+
+	if(p_value) *p_value = value;
+
+	return true;
+}
+
+void os_delay(uint32_t milliseconds)
+{
+	if(milliseconds == 0) std::this_thread::yield();
+	else std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+}
+
+void os_delay_until(os_tick_t* p_wake, uint32_t milliseconds)
+{
+	*p_wake += milliseconds;
+
+	// Only yielding when the wake time is already due, as for a zero period
+	const int32_t delta = (int32_t) (*p_wake - os_tick_count());
+	if(delta > 0) std::this_thread::sleep_for(std::chrono::milliseconds(delta));
+	else std::this_thread::yield();
+}
+
+os_tick_t os_tick_count(void)
+{
+	return (os_tick_t) std::chrono::duration_cast<std::chrono::milliseconds>(clock_type::now() - s_epoch).count();
+}
+
+os_tick_t os_ms_to_ticks(uint32_t milliseconds)
+{
+	return milliseconds;
+}
+
+uint32_t os_ticks_to_ms(os_tick_t ticks)
+{
+	return ticks;
+}
+
+os_queue_t os_queue_create(std::size_t element_size, std::size_t capacity)
+{
+	os_queue* queue     = new os_queue();
+	queue->element_size = element_size;
+	queue->capacity     = capacity ? capacity : 1U;
+	queue->sequence.reset(new os_queue::position_type[queue->capacity]);
+	queue->storage.reset(new uint8_t[queue->capacity * element_size]);
+	queue->head         = 0U;
+	queue->tail         = 0U;
+	queue->count        = 0U;
+	queue->pushed       = 0U;
+	queue->popped       = 0U;
+	queue->readers      = 0U;
+	queue->writers      = 0U;
+
+	// Every cell is free for the producer at its own position
+	for(std::size_t i = 0; i < queue->capacity; i++) queue->sequence[i] = 2U * i;
+
+	return queue;
+}
+
+void os_queue_delete(os_queue_t queue)
+{
+	delete queue;
+}
+
+// Writes a message without blocking, false when the queue is full
+static bool try_push(os_queue* queue, const void* p_message)
+{
+	std::size_t position = queue->head.load(std::memory_order_relaxed);
+
+	while(true)
+	{
+		const std::size_t cell     = position % queue->capacity;
+		const std::size_t sequence = queue->sequence[cell].load(std::memory_order_seq_cst);
+		const intptr_t    delta    = (intptr_t) sequence - (intptr_t) (2U * position);
+
+		if(delta == 0)
+		{
+			// Claiming the cell, then publishing the message in it
+			if(queue->head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				std::memcpy(queue->storage.get() + cell * queue->element_size, p_message, queue->element_size);
+				queue->sequence[cell].store(2U * position + 1U, std::memory_order_seq_cst);
+				queue->count.fetch_add(1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if(delta < 0) return false;
+		else position = queue->head.load(std::memory_order_relaxed);
+	}
+}
+
+// Reads a message without blocking, false when no message is published
+static bool try_pop(os_queue* queue, void* p_message)
+{
+	std::size_t position = queue->tail.load(std::memory_order_relaxed);
+
+	while(true)
+	{
+		const std::size_t cell     = position % queue->capacity;
+		const std::size_t sequence = queue->sequence[cell].load(std::memory_order_seq_cst);
+		const intptr_t    delta    = (intptr_t) sequence - (intptr_t) (2U * position + 1U);
+
+		if(delta == 0)
+		{
+			// Claiming the cell, then releasing it to the producers
+			if(queue->tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				std::memcpy(p_message, queue->storage.get() + cell * queue->element_size, queue->element_size);
+				queue->sequence[cell].store(2U * (position + queue->capacity), std::memory_order_seq_cst);
+				queue->count.fetch_sub(1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if(delta < 0) return false;
+		else position = queue->tail.load(std::memory_order_relaxed);
+	}
+}
+
+// Signals an event counter when anyone waits for it
+static void signal(std::atomic<uint32_t>* p_event, std::atomic<uint32_t>* p_waiters)
+{
+	if(p_waiters->load(std::memory_order_seq_cst) != 0)
+	{
+		p_event->fetch_add(1, std::memory_order_seq_cst);
+		futex_wake(p_event, INT_MAX);
+	}
+}
+
+// Repeats an operation until it succeeds, sleeping on the event counter in between
+template <class Operation>
+static bool retry(Operation operation, std::atomic<uint32_t>* p_event, std::atomic<uint32_t>* p_waiters, uint32_t timeout_ms)
+{
+	if(operation()) return true;
+	if(timeout_ms == 0) return false;
+
+	const Deadline deadline(timeout_ms);
+
+	while(true)
+	{
+		// Registering as a waiter before the last attempt, so no event can be missed
+		const uint32_t event = p_event->load(std::memory_order_seq_cst);
+		p_waiters->fetch_add(1, std::memory_order_seq_cst);
+
+		if(operation())
+		{
+			p_waiters->fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		const uint32_t remaining = deadline.remaining();
+		if(remaining != 0) futex_wait(p_event, event, remaining);
+
+		p_waiters->fetch_sub(1, std::memory_order_relaxed);
+
+		if(remaining == 0) return false;
+	}
+}
+
+bool os_queue_send(os_queue_t queue, const void* p_message, uint32_t timeout_ms)
+{
+	auto push = [queue, p_message]() { return try_push(queue, p_message); };
+
+	if(!retry(push, &queue->popped, &queue->writers, timeout_ms)) return false;
+
+	signal(&queue->pushed, &queue->readers);
+	return true;
+}
+
+bool os_queue_receive(os_queue_t queue, void* p_message, uint32_t timeout_ms)
+{
+	auto pop = [queue, p_message]() { return try_pop(queue, p_message); };
+
+	if(!retry(pop, &queue->pushed, &queue->readers, timeout_ms)) return false;
+
+	signal(&queue->popped, &queue->writers);
+	return true;
+}
+
+bool os_queue_empty(os_queue_t queue)
+{
+	return queue->count.load(std::memory_order_acquire) == 0;
+}
+
+std::size_t os_queue_count(os_queue_t queue)
+{
+	return queue->count.load(std::memory_order_acquire);
+}
+
+os_semaphore_t os_semaphore_create(void)
+{
+	os_semaphore* semaphore = new os_semaphore();
+	semaphore->given        = 0U;
+
+	return semaphore;
+}
+
+void os_semaphore_delete(os_semaphore_t semaphore)
+{
+	delete semaphore;
+}
+
+void os_semaphore_give(os_semaphore_t semaphore)
+{
+	if(semaphore->given.exchange(1U, std::memory_order_release) == 0U) futex_wake(&semaphore->given, 1);
+}
+
+bool os_semaphore_take(os_semaphore_t semaphore, uint32_t timeout_ms)
+{
+	const Deadline deadline(timeout_ms);
+
+	while(semaphore->given.exchange(0U, std::memory_order_acquire) == 0U)
+	{
+		const uint32_t remaining = deadline.remaining();
+		if(remaining == 0) return false;
+
+		futex_wait(&semaphore->given, 0U, remaining);
+	}
+
+	return true;
+}
+
+os_poll_t os_poll_create(void)
+{
+	const int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+	if(epoll_fd < 0) return nullptr;
+
+	os_poll* poll  = new os_poll();
+	poll->epoll_fd = epoll_fd;
+	poll->owner    = nullptr;
+
+	return poll;
+}
+
+void os_poll_delete(os_poll_t poll)
+{
+	if(poll == nullptr) return;
+
+	close(poll->epoll_fd);
+	delete poll;
+}
+
+bool os_poll_add(os_poll_t poll, int fd, uint32_t events)
+{
+	struct epoll_event event;
+	event.events  = events;
+	event.data.fd = fd;
+
+	return epoll_ctl(poll->epoll_fd, EPOLL_CTL_ADD, fd, &event) == 0;
+}
+
+bool os_poll_remove(os_poll_t poll, int fd)
+{
+	return epoll_ctl(poll->epoll_fd, EPOLL_CTL_DEL, fd, nullptr) == 0;
+}
+
+// Consumes a pending notification of the thread
+static void consume_notification(os_thread* self, uint32_t clear_on_exit)
+{
+	std::lock_guard<std::mutex> guard(self->lock);
+	self->state.store(notify_idle, std::memory_order_relaxed);
+	self->value.fetch_and(~clear_on_exit, std::memory_order_acq_rel);
+}
+
+// Registers the eventfd of the calling thread in the set, on the first wait of the thread
+static bool attach_thread(os_poll* poll, os_thread* self)
+{
+	if(poll->owner == self) return true;
+
+	if(self->event_fd < 0)
+	{
+		self->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+		if(self->event_fd < 0) return false;
+	}
+
+	if(poll->owner != nullptr) epoll_ctl(poll->epoll_fd, EPOLL_CTL_DEL, poll->owner->event_fd, nullptr);
+
+	struct epoll_event event;
+	event.events   = EPOLLIN;
+	event.data.fd  = self->event_fd;
+
+	if(epoll_ctl(poll->epoll_fd, EPOLL_CTL_ADD, self->event_fd, &event) != 0) return false;
+
+	poll->owner = self;
+	return true;
+}
+
+int os_poll_wait(os_poll_t poll, os_poll_event* p_events, int max_events, uint32_t clear_on_exit, uint32_t timeout_ms)
+{
+	os_thread* self = current_thread();
+	if(!attach_thread(poll, self)) return -1;
+
+	// Checking for descriptors only when a notification is already pending
+	uint32_t state = notify_idle;
+	if(!self->state.compare_exchange_strong(state, notify_polling, std::memory_order_acq_rel)) timeout_ms = 0;
+
+	struct epoll_event events[poll_batch];
+	const int          capacity = max_events + 1 < poll_batch ? max_events + 1 : poll_batch;
+	const int          timeout  = timeout_ms == MFLOW_OS_WAIT_FOREVER ? -1 : timeout_ms > INT_MAX ? INT_MAX : (int) timeout_ms;
+	const int          count    = epoll_wait(poll->epoll_fd, events, capacity, timeout);
+
+	// Leaving the polling state, unless a notifier already replaced it
+	state = notify_polling;
+	if(!self->state.compare_exchange_strong(state, notify_idle, std::memory_order_acq_rel)) state = self->state.load(std::memory_order_acquire);
+	if(state == notify_pending) consume_notification(self, clear_on_exit);
+
+	if(count < 0) return errno == EINTR ? 0 : -1;
+
+	int ready = 0;
+	for(int i = 0; i < count; i++)
+	{
+		if(events[i].data.fd == self->event_fd)
+		{
+			// Resetting the wake-up counter of the notifications
+			uint64_t counter;
+			if(read(self->event_fd, &counter, sizeof(counter)) < 0) { /* Already reset */ }
+		}
+		else if(ready < max_events)
+		{
+			p_events[ready].fd     = events[i].data.fd;
+			p_events[ready].events = events[i].events;
+			ready++;
+		}
+	}
+
+	return ready;
+}
+
+#endif // !ESP_PLATFORM
@@ -61,6 +61,11 @@ bool Port::is_closed(void) const
 	else return true;
 }
 
+bool Port::is_connected(void) const
+{
+	return m_queue != nullptr;
+}
+
 type_index Port::type_id(void) const
 {
 	return m_type_id;
@@ -5,13 +5,10 @@
 // Standard includes
 #include <memory>
 
-// FreeRTOS includes
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-
 // Project includes
 #include "mflow_config.h"
 #include "message_queue.h"
+#include "os.h"
 #include "utility.hpp"
 
 
@@ -69,6 +66,12 @@ public:
 	 */
 	bool is_closed(void) const;
 
+	/**
+	 * @brief  Checks whether a message queue is attached to the port.
+	 * @retval True when the port has a message queue attached, false otherwise.
+	 */
+	bool is_connected(void) const;
+
 	/**
 	 * @brief  Queries the type index of the Port's message type.
 	 * @retval The identifier of the Port's message type.
@@ -195,12 +198,9 @@ public:
 				return optional<Type>(message, MessageStatus::Okay);
 			}
 
-			// FreeRTOS task notification value to read into
-			uint32_t notification;
-
 			// Waiting for the receiving task to receive a notification (either message arrival or shutdown request)
 			// The message arrival notification bit is cleared when receiving the notification
-			xTaskNotifyWait(0x00000000, MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL, &notification, portMAX_DELAY);
+			os_thread_wait(0x00000000, MFLOW_NOTIFICATION_MASK_MESSAGE_ARRIVAL, nullptr, MFLOW_OS_WAIT_FOREVER);
 		}
 	}
 };
@@ -257,6 +257,37 @@ public:
 		// Indicate unsuccessful sending due to the sending Component being terminated
 		return MessageStatus::Terminated;
 	}
+
+	/**
+	 * @brief   Sends a message to the attached message queue without blocking.
+	 * @details When the message queue has no free space, the message is not
+	 *          sent and the status is "Full". Sources receiving data faster
+	 *          than the graph consumes it use this function to drop and count
+	 *          the excess instead of stalling. The other status values are
+	 *          the same as for send().
+	 * @param   value [in] The message to send to the attached message queue.
+	 * @retval  Status of the sending operation.
+	 */
+	template <class Type>
+	MessageStatus try_send(const Type& value) {
+
+		// Checking if the type of the message sent matches with the OutputPort's type
+		if(type_id() != ::type_id<Type>())
+		{
+			// Indicate unsuccessful sending due to type-mismatch
+			return MessageStatus::TypeMismatch;
+		}
+
+		// Checking if the sending Component is terminated
+		if(is_parent_terminating())
+		{
+			// Indicate unsuccessful sending due to the sending Component being terminated
+			return MessageStatus::Terminated;
+		}
+
+		// Attempting to send the message once, without waiting for free space
+		return send_to_message_queue(&value, 0) ? MessageStatus::Okay : MessageStatus::Full;
+	}
 };
 
 /**
@@ -0,0 +1,370 @@
+#pragma once
+#ifndef MFLOW_REPLICATED_HPP_INCLUDED
+#define MFLOW_REPLICATED_HPP_INCLUDED
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Project includes
+#include "component.h"
+#include "os.h"
+#include "wait_set.h"
+
+
+// Maximum number of messages in flight per replica
+#ifndef MFLOW_REPLICA_DEPTH
+#define MFLOW_REPLICA_DEPTH (4)
+#endif
+
+// First port index used internally to connect the replicas
+#ifndef MFLOW_REPLICA_PORT_BASE
+#define MFLOW_REPLICA_PORT_BASE (0x100)
+#endif
+
+// Maximum number of option ports of a replicated stage
+#ifndef MFLOW_REPLICA_MAX_OPTIONS
+#define MFLOW_REPLICA_MAX_OPTIONS (4)
+#endif
+
+// Interval of retrying the option messages a replica did not accept yet
+#ifndef MFLOW_REPLICA_RETRY_MS
+#define MFLOW_REPLICA_RETRY_MS (1)
+#endif
+
+/**
+ * @brief Policies selecting the replica of the next message.
+ */
+enum class ReplicaPolicy : uint8_t {
+	RoundRobin, /**< The replicas receive the messages in turn.               */
+	LeastLoaded /**< The replica with the fewest messages in flight is used. */
+};
+
+/**
+ * @brief   Component running several replicas of a stateless stage in parallel.
+ * @details The replicated stage must produce exactly one output message for
+ *          every input message. The composite exposes the input and output
+ *          port of the stage under the same indices, creates the replicas
+ *          with the factory of the stage and runs each of them in its own
+ *          task, so the scheduler can spread them across the cores.
+ *
+ *          Incoming messages are distributed by the selected policy. The
+ *          replica of every message is recorded in a reorder buffer indexed
+ *          by the dispatch sequence number, and the outputs are collected in
+ *          that order, so the output stream keeps the order of the input
+ *          stream. At most MFLOW_REPLICA_DEPTH messages are in flight per
+ *          replica, which bounds the buffering and guarantees that replicas
+ *          never block on their outputs.
+ *
+ *          Option ports of the stage are exposed with #add_option(), every
+ *          message arriving on such a port of the composite is broadcast to
+ *          the same port of all replicas, so initial messages and
+ *          configuration changes reach every replica. The broadcast never
+ *          blocks: a replica whose option port is full, typically because it
+ *          waits for its next input, keeps the message as undelivered, and
+ *          the composite retries it on its later calls while dispatching.
+ *          A newer message replaces the undelivered one, so each replica
+ *          always ends up with the latest option value.
+ */
+template <class In, class Out>
+class Replicated : public Component {
+public:
+
+	/**
+	 * @brief Creates the replicas of a stage.
+	 * @param factory      [in] The factory creating one replica of the stage.
+	 * @param replicas     [in] The number of replicas to create.
+	 * @param input_index  [in] Index of the input port of the stage.
+	 * @param output_index [in] Index of the output port of the stage.
+	 * @param policy       [in] The policy distributing the input messages.
+	 */
+	Replicated(Component* (*factory)(void), unsigned replicas, unsigned input_index, unsigned output_index,
+	           ReplicaPolicy policy = ReplicaPolicy::RoundRobin)
+		: m_replicas(new Component*[replicas ? replicas : 1U]),
+		  m_load(new unsigned[replicas ? replicas : 1U]),
+		  m_order(new unsigned[(replicas ? replicas : 1U) * MFLOW_REPLICA_DEPTH]),
+		  m_count(replicas ? replicas : 1U),
+		  m_input(input_index),
+		  m_output(output_index),
+		  m_policy(policy),
+		  m_next(0),
+		  m_head(0),
+		  m_pending(0),
+		  m_option_count(0),
+		  m_undelivered(false)
+	{
+		inputs.addPort<In>(m_input, MFLOW_REPLICA_DEPTH);
+		outputs.addPort<Out>(m_output);
+
+		for(unsigned r = 0; r < m_count; r++)
+		{
+			// Connecting the replica between a dispatch output and a return input
+			m_replicas[r] = factory();
+			m_load[r]     = 0;
+
+			outputs.addPort<In>(MFLOW_REPLICA_PORT_BASE + r);
+			inputs.addPort<Out>(MFLOW_REPLICA_PORT_BASE + r, MFLOW_REPLICA_DEPTH);
+
+			connect(*this, MFLOW_REPLICA_PORT_BASE + r, *m_replicas[r], input_index);
+			connect(*m_replicas[r], output_index, *this, MFLOW_REPLICA_PORT_BASE + r);
+		}
+	}
+
+	virtual ~Replicated()
+	{
+		for(unsigned r = 0; r < m_count; r++) delete m_replicas[r];
+		for(unsigned o = 0; o < m_option_count; o++) (this->*m_options[o].release)(o);
+
+		delete[] m_replicas;
+		delete[] m_load;
+		delete[] m_order;
+	}
+
+	/**
+	 * @brief   Exposes an option port of the stage, broadcasting its messages to every replica.
+	 * @details Must be called before the node is started. The capacity applies
+	 *          to the port of the composite, the ports of the replicas keep
+	 *          the capacity defined by the stage.
+	 * @param   index    [in] Index of the option port of the stage.
+	 * @param   capacity [in] Capacity of the option port of the composite.
+	 * @retval  True when the port was added, false when MFLOW_REPLICA_MAX_OPTIONS ports exist already.
+	 */
+	template <class Option>
+	bool add_option(unsigned index, unsigned capacity = 1)
+	{
+		if(m_option_count == MFLOW_REPLICA_MAX_OPTIONS) return false;
+
+		const unsigned slot = m_option_count++;
+		m_options[slot].index       = index;
+		m_options[slot].held        = new Option[m_count];
+		m_options[slot].undelivered = new bool[m_count];
+		m_options[slot].forward     = &Replicated::forward_option<Option>;
+		m_options[slot].release     = &Replicated::release_option<Option>;
+
+		for(unsigned r = 0; r < m_count; r++) m_options[slot].undelivered[r] = false;
+
+		inputs.addPort<Option>(index, capacity);
+
+		for(unsigned r = 0; r < m_count; r++)
+		{
+			outputs.addPort<Option>(option_port(slot, r));
+			connect(*this, option_port(slot, r), *m_replicas[r], index);
+		}
+
+		return true;
+	}
+
+	/**
+	 * @brief   Queries a replica.
+	 * @param   index [in] Index of the replica.
+	 * @retval  Reference to the replica.
+	 */
+	Component& replica(unsigned index)
+	{
+		return *m_replicas[index];
+	}
+
+	/**
+	 * @brief Queries the number of replicas.
+	 */
+	unsigned replicas(void) const
+	{
+		return m_count;
+	}
+
+	/**
+	 * @brief   Queries whether an option message has not reached every replica yet.
+	 * @details A message is delivered once it is in the option port of every
+	 *          replica, the replicas apply it when they read that port.
+	 * @retval  True while an option message waits in the composite, false otherwise.
+	 */
+	bool has_undelivered_options(void)
+	{
+		// The flag is raised before a message leaves the port of the composite, so it is read again after the ports
+		if(m_undelivered) return true;
+
+		for(unsigned o = 0; o < m_option_count; o++)
+		{
+			if(inputs[m_options[o].index].has_message()) return true;
+		}
+
+		return m_undelivered;
+	}
+
+	virtual void initialize(void) override
+	{
+		for(unsigned r = 0; r < m_count; r++) m_replicas[r]->start_process();
+	}
+
+	virtual void process(void) override
+	{
+		// Broadcasting the option messages to every replica, retrying the undelivered ones
+		bool undelivered = false;
+
+		for(unsigned o = 0; o < m_option_count; o++)
+		{
+			const optional<bool> status = (this->*m_options[o].forward)(o);
+			if(!status) return;
+
+			undelivered = undelivered || status.value();
+		}
+
+		m_undelivered = undelivered;
+
+		// Forwarding the outputs that are next in the input order
+		while(m_pending > 0 && inputs[MFLOW_REPLICA_PORT_BASE + m_order[m_head]].has_message())
+		{
+			const unsigned replica = m_order[m_head];
+
+			auto value = inputs[MFLOW_REPLICA_PORT_BASE + replica].template receive<Out>();
+			if(!value) return;
+
+			m_head = (m_head + 1) % (m_count * MFLOW_REPLICA_DEPTH);
+			m_pending--;
+			m_load[replica]--;
+
+			if(outputs[m_output].template send<Out>(value.value()) != MessageStatus::Okay) return;
+		}
+
+		// Dispatching the next input message when the selected replica has room
+		const unsigned replica  = select();
+		const bool     dispatch = m_load[replica] < MFLOW_REPLICA_DEPTH;
+
+		if(dispatch && inputs[m_input].has_message())
+		{
+			auto value = inputs[m_input].template receive<In>();
+			if(!value) return;
+
+			m_order[(m_head + m_pending) % (m_count * MFLOW_REPLICA_DEPTH)] = replica;
+			m_pending++;
+			m_load[replica]++;
+			m_next = (replica + 1) % m_count;
+
+			outputs[MFLOW_REPLICA_PORT_BASE + replica].template send<In>(value.value());
+			return;
+		}
+
+		// Waiting for new input, for the output that is next in order or for options
+		WaitSet wait_set;
+
+		if(dispatch)      wait_set.add_port(m_input);
+		if(m_pending > 0) wait_set.add_port(MFLOW_REPLICA_PORT_BASE + m_order[m_head]);
+
+		for(unsigned o = 0; o < m_option_count; o++) wait_set.add_port(m_options[o].index);
+
+		// Retrying the undelivered options even when no message arrives
+		if(undelivered) wait_set.set_timeout(MFLOW_REPLICA_RETRY_MS);
+
+		await(wait_set);
+	}
+
+	virtual void finalize(void) override
+	{
+		// Stopping the replicas and waiting for their tasks to exit, a replica
+		// counts as running from its start even before its task is scheduled
+		for(unsigned r = 0; r < m_count; r++) m_replicas[r]->stop_process();
+
+		for(unsigned r = 0; r < m_count; r++)
+		{
+			while(m_replicas[r]->is_running()) os_delay(1);
+		}
+	}
+
+private:
+
+	/**
+	 * @brief Option port of the stage, the messages not yet accepted by the replicas and their handlers.
+	 */
+	struct OptionPort {
+		unsigned index;                                       /**< Index of the option port.                   */
+		void*    held;                                        /**< The last message, one for each replica.     */
+		bool*    undelivered;                                 /**< Whether a replica has not accepted it yet.  */
+		optional<bool> (Replicated::*forward)(unsigned slot); /**< Broadcasts the messages, no value on stop.  */
+		void (Replicated::*release)(unsigned slot);           /**< Deletes the held messages of the port.      */
+	};
+
+	// Index of the output port connected to an option port of a replica
+	unsigned option_port(unsigned slot, unsigned replica) const
+	{
+		return MFLOW_REPLICA_PORT_BASE + (slot + 1) * m_count + replica;
+	}
+
+	// Broadcasts the arrived messages of an option port without blocking, the
+	// result tells whether a replica has an undelivered message, no value on stop
+	template <class Option>
+	optional<bool> forward_option(unsigned slot)
+	{
+		OptionPort& option = m_options[slot];
+		Option*     held   = static_cast<Option*>(option.held);
+
+		// Taking every arrived message, a newer one replaces the undelivered one
+		while(inputs[option.index].has_message())
+		{
+			m_undelivered = true;
+
+			auto value = inputs[option.index].template receive<Option>();
+			if(!value) return optional<bool>(value.status());
+
+			for(unsigned r = 0; r < m_count; r++)
+			{
+				held[r]               = value.value();
+				option.undelivered[r] = true;
+			}
+		}
+
+		// Offering the held message to every replica that has not accepted it yet
+		bool undelivered = false;
+
+		for(unsigned r = 0; r < m_count; r++)
+		{
+			if(!option.undelivered[r]) continue;
+
+			const MessageStatus status = outputs[option_port(slot, r)].template try_send<Option>(held[r]);
+
+			if(status == MessageStatus::Okay) option.undelivered[r] = false;
+			else if(status == MessageStatus::Full) undelivered = true;
+			else return optional<bool>(status);
+		}
+
+		return optional<bool>(undelivered, MessageStatus::Okay);
+	}
+
+	template <class Option>
+	void release_option(unsigned slot)
+	{
+		delete[] static_cast<Option*>(m_options[slot].held);
+		delete[] m_options[slot].undelivered;
+	}
+
+	unsigned select(void) const
+	{
+		if(m_policy == ReplicaPolicy::RoundRobin) return m_next;
+
+		// Finding the replica with the fewest messages in flight, starting after the last used one
+		unsigned best = m_next;
+		for(unsigned i = 1; i < m_count; i++)
+		{
+			const unsigned r = (m_next + i) % m_count;
+			if(m_load[r] < m_load[best]) best = r;
+		}
+
+		return best;
+	}
+
+	Component**       m_replicas;                           /**< The replicas of the stage.                         */
+	unsigned*         m_load;                               /**< Number of messages in flight per replica.          */
+	unsigned*         m_order;                              /**< Replica of each message in flight, in input order. */
+	unsigned          m_count;                              /**< Number of replicas.                                */
+	unsigned          m_input;                              /**< Index of the input port of the stage.              */
+	unsigned          m_output;                             /**< Index of the output port of the stage.             */
+	ReplicaPolicy     m_policy;                             /**< The policy distributing the input messages.        */
+	unsigned          m_next;                               /**< The replica after the last used one.               */
+	unsigned          m_head;                               /**< Position of the oldest message in flight.          */
+	unsigned          m_pending;                            /**< Number of messages in flight.                      */
+	OptionPort        m_options[MFLOW_REPLICA_MAX_OPTIONS]; /**< The exposed option ports.                          */
+	unsigned          m_option_count;                       /**< Number of option ports.                            */
+	std::atomic<bool> m_undelivered;                        /**< Whether an option message is not delivered yet.    */
+};
+
+#endif // MFLOW_REPLICATED_HPP_INCLUDED
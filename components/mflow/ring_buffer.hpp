@@ -0,0 +1,136 @@
+#pragma once
+#ifndef MFLOW_RING_BUFFER_HPP_INCLUDED
+#define MFLOW_RING_BUFFER_HPP_INCLUDED
+
+// Standard includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+
+/**
+ * @brief   Lock-free single producer, single consumer byte ring buffer.
+ * @details The producer and the consumer can run in different threads
+ *          without additional synchronization, as long as there is only
+ *          one of each. The capacity is rounded up to a power of two, so
+ *          the read and write positions can run freely and are masked on
+ *          access. Writes are all-or-nothing, the consumer reads the data
+ *          in contiguous chunks to support large, copy-free flushes.
+ */
+class RingBuffer {
+public:
+
+	/**
+	 * @brief Creates a ring buffer with at least the specified capacity.
+	 * @param capacity [in] The minimum number of bytes the buffer can store.
+	 */
+	explicit RingBuffer(std::size_t capacity)
+		: m_data(nullptr),
+		  m_size(1),
+		  m_head(0),
+		  m_tail(0)
+	{
+		// Rounding the capacity up to the next power of two
+		while(m_size < capacity) m_size <<= 1;
+
+		m_data = new uint8_t[m_size];
+	}
+
+	/**
+	 * @brief Destroys the ring buffer and releases the storage.
+	 */
+	~RingBuffer()
+	{
+		delete[] m_data;
+	}
+
+	// The ring buffer owns its storage, copying is not allowed
+	RingBuffer(const RingBuffer&) = delete;
+	RingBuffer& operator=(const RingBuffer&) = delete;
+
+	/**
+	 * @brief  Queries the number of bytes the buffer can store.
+	 * @retval The capacity of the buffer in bytes.
+	 */
+	std::size_t capacity(void) const
+	{
+		return m_size;
+	}
+
+	/**
+	 * @brief  Queries the number of bytes available for reading (consumer side).
+	 * @retval The number of bytes stored in the buffer.
+	 */
+	std::size_t read_available(void) const
+	{
+		return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_relaxed);
+	}
+
+	/**
+	 * @brief  Queries the number of bytes available for writing (producer side).
+	 * @retval The number of bytes that can be written without overflow.
+	 */
+	std::size_t write_available(void) const
+	{
+		return m_size - (m_head.load(std::memory_order_relaxed) - m_tail.load(std::memory_order_acquire));
+	}
+
+	/**
+	 * @brief  Writes a block of data into the buffer (producer side).
+	 * @param  p_data [in] Pointer to the data to write.
+	 * @param  length [in] The number of bytes to write.
+	 * @retval True when the whole block was written, false when it does not fit.
+	 */
+	bool write(const void* p_data, std::size_t length)
+	{
+		// Rejecting blocks that do not fit into the free space
+		if(length > write_available()) return false;
+
+		const std::size_t head  = m_head.load(std::memory_order_relaxed);
+		const std::size_t start = head & (m_size - 1);
+		const std::size_t first = length < m_size - start ? length : m_size - start;
+
+		// Copying the block, wrapping around at the end of the storage
+		std::memcpy(m_data + start, p_data, first);
+		std::memcpy(m_data, static_cast<const uint8_t*>(p_data) + first, length - first);
+
+		// Publishing the block to the consumer
+		m_head.store(head + length, std::memory_order_release);
+
+		return true;
+	}
+
+	/**
+	 * @brief  Queries the longest contiguous readable chunk (consumer side).
+	 * @param  length [out] The number of bytes readable at the returned address.
+	 * @retval Pointer to the first readable byte.
+	 */
+	const uint8_t* peek(std::size_t& length) const
+	{
+		const std::size_t tail  = m_tail.load(std::memory_order_relaxed);
+		const std::size_t start = tail & (m_size - 1);
+		const std::size_t used  = read_available();
+
+		length = used < m_size - start ? used : m_size - start;
+
+		return m_data + start;
+	}
+
+	/**
+	 * @brief Releases bytes previously read with #peek() (consumer side).
+	 * @param length [in] The number of bytes to release.
+	 */
+	void consume(std::size_t length)
+	{
+		m_tail.store(m_tail.load(std::memory_order_relaxed) + length, std::memory_order_release);
+	}
+
+private:
+	uint8_t*                 m_data; /**< The storage of the buffer.                 */
+	std::size_t              m_size; /**< The size of the storage, a power of two.   */
+	std::atomic<std::size_t> m_head; /**< Free-running write position (producer).    */
+	std::atomic<std::size_t> m_tail; /**< Free-running read position (consumer).     */
+};
+
+#endif // MFLOW_RING_BUFFER_HPP_INCLUDED
@@ -14,9 +14,24 @@ void add_node(const char* component_id, const char* name)
 	s_nodes[name] = s_factories[component_id]();
 }
 
+void add_instance(const char* name, Component* component)
+{
+	s_nodes[name] = component;
+}
+
+MFLOW_COMPONENT_FACTORY_FP find_component(const char* component_id)
+{
+	auto factory = s_factories.find(component_id);
+	return factory == s_factories.end() ? nullptr : factory->second;
+}
+
 void remove_node(const char* name)
 {
-	s_nodes.erase(name);
+	auto node = s_nodes.find(name);
+	if(node == s_nodes.end()) return;
+
+	delete node->second;
+	s_nodes.erase(node);
 }
 
 void add_edge(const char* source, unsigned output_index, const char* target, unsigned input_index)
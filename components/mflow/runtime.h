@@ -4,6 +4,7 @@
 
 // Project includes
 #include "component.h"
+#include "replicated.hpp"
 
 typedef Component* (*MFLOW_COMPONENT_FACTORY_FP)(void);
 
@@ -22,8 +23,48 @@ void register_component(const char* component_id, MFLOW_COMPONENT_FACTORY_FP p_f
 void add_node(const char* component_id, const char* name);
 
 /**
- * @brief Removes a Component node from the runtime.
- * @param name [in] Name of the Component instance to remove.
+ * @brief Adds an already created Component node to the runtime, which takes its ownership.
+ * @param name      [in] Name of the Component instance.
+ * @param component [in] Pointer to the Component instance.
+ */
+void add_instance(const char* name, Component* component);
+
+/**
+ * @brief  Queries the factory registered for a Component type.
+ * @param  component_id [in] Textual identifier of the Component type.
+ * @retval Pointer to the factory method, nullptr if the type is not registered.
+ */
+MFLOW_COMPONENT_FACTORY_FP find_component(const char* component_id);
+
+/**
+ * @brief   Creates and adds a node running several replicas of a stateless Component type.
+ * @details The option ports of the Component type are exposed by calling
+ *          Replicated::add_option() on the returned node, afterwards initial
+ *          messages sent to them with add_initial() reach every replica.
+ * @param   component_id [in] Textual identifier of the Component type.
+ * @param   name         [in] Name of the created node.
+ * @param   replicas     [in] The number of replicas to run in parallel.
+ * @param   input_index  [in] Index of the input port of the Component type.
+ * @param   output_index [in] Index of the output port of the Component type.
+ * @param   policy       [in] The policy distributing the input messages.
+ * @retval  Pointer to the created node, nullptr if the type is not registered.
+ */
+template <class In, class Out>
+Replicated<In, Out>* add_replicated_node(const char* component_id, const char* name, unsigned replicas,
+                                         unsigned input_index, unsigned output_index,
+                                         ReplicaPolicy policy = ReplicaPolicy::RoundRobin)
+{
+	MFLOW_COMPONENT_FACTORY_FP factory = find_component(component_id);
+	if(factory == nullptr) return nullptr;
+
+	Replicated<In, Out>* node = new Replicated<In, Out>(factory, replicas, input_index, output_index, policy);
+	add_instance(name, node);
+	return node;
+}
+
+/**
+ * @brief Removes a Component node from the runtime and destroys it.
+ * @param name [in] Name of the Component instance to remove, its task must have stopped.
  */
 void remove_node(const char* name);
 
@@ -0,0 +1,28 @@
+#pragma once
+#ifndef MFLOW_TEST_H_INCLUDED
+#define MFLOW_TEST_H_INCLUDED
+
+// Standard includes
+#include <cstdio>
+
+
+// Minimal checks of the host tests: every failed check is reported with
+// its location, and the test program exits with the failure count.
+
+// Number of failed checks of the test program
+static unsigned g_test_failures = 0;
+
+// Checks a condition, reporting it when false
+#define MFLOW_CHECK(condition)                                                                 \
+	do {                                                                                       \
+		if(!(condition))                                                                       \
+		{                                                                                      \
+			std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+			g_test_failures++;                                                                 \
+		}                                                                                      \
+	} while(0)
+
+// Exit status of the test program
+#define MFLOW_TEST_RESULT() (g_test_failures == 0 ? 0 : 1)
+
+#endif // MFLOW_TEST_H_INCLUDED
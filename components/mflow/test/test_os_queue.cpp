@@ -0,0 +1,177 @@
+// Standard includes
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Project includes
+#include "os.h"
+#include "test.h"
+
+
+// Message of the stress test, identifies the producer and its sequence number
+struct Message {
+	uint32_t producer;
+	uint32_t sequence;
+};
+
+// The queue is bounded, first-in first-out and reports its fill level
+static void test_bounds(void)
+{
+	os_queue_t queue = os_queue_create(sizeof(uint32_t), 4);
+
+	MFLOW_CHECK(os_queue_empty(queue));
+
+	for(uint32_t i = 0; i < 4; i++) MFLOW_CHECK(os_queue_send(queue, &i, 0));
+
+	const uint32_t extra = 4;
+	MFLOW_CHECK(!os_queue_send(queue, &extra, 0));
+	MFLOW_CHECK(os_queue_count(queue) == 4);
+
+	for(uint32_t i = 0; i < 4; i++)
+	{
+		uint32_t value = 0xFFFFFFFFU;
+		MFLOW_CHECK(os_queue_receive(queue, &value, 0));
+		MFLOW_CHECK(value == i);
+	}
+
+	uint32_t value;
+	MFLOW_CHECK(!os_queue_receive(queue, &value, 0));
+	MFLOW_CHECK(os_queue_empty(queue));
+
+	os_queue_delete(queue);
+}
+
+// Timed operations give up after their timeout
+static void test_timeouts(void)
+{
+	os_queue_t queue = os_queue_create(sizeof(uint32_t), 1);
+	uint32_t   value = 0;
+
+	os_tick_t start = os_tick_count();
+	MFLOW_CHECK(!os_queue_receive(queue, &value, 20));
+	MFLOW_CHECK(os_ticks_to_ms(os_tick_count() - start) >= 20);
+
+	MFLOW_CHECK(os_queue_send(queue, &value, 0));
+
+	start = os_tick_count();
+	MFLOW_CHECK(!os_queue_send(queue, &value, 20));
+	MFLOW_CHECK(os_ticks_to_ms(os_tick_count() - start) >= 20);
+
+	os_queue_delete(queue);
+}
+
+// Blocked receivers and senders are woken by the other side
+static void test_blocking(void)
+{
+	os_queue_t queue = os_queue_create(sizeof(uint32_t), 1);
+
+	std::thread sender([queue]() {
+		os_delay(10);
+		const uint32_t value = 42;
+		os_queue_send(queue, &value, MFLOW_OS_WAIT_FOREVER);
+	});
+
+	uint32_t value = 0;
+	MFLOW_CHECK(os_queue_receive(queue, &value, MFLOW_OS_WAIT_FOREVER));
+	MFLOW_CHECK(value == 42);
+	sender.join();
+
+	// Filling the queue, the next sender blocks until a message is read
+	MFLOW_CHECK(os_queue_send(queue, &value, 0));
+
+	std::atomic<bool> sent(false);
+	std::thread blocked([queue, &sent]() {
+		const uint32_t next = 43;
+		sent = os_queue_send(queue, &next, MFLOW_OS_WAIT_FOREVER);
+	});
+
+	os_delay(10);
+	MFLOW_CHECK(!sent);
+	MFLOW_CHECK(os_queue_receive(queue, &value, MFLOW_OS_WAIT_FOREVER));
+	blocked.join();
+
+	MFLOW_CHECK(sent);
+	MFLOW_CHECK(os_queue_receive(queue, &value, 0));
+	MFLOW_CHECK(value == 43);
+
+	os_queue_delete(queue);
+}
+
+// Every message of several producers reaches exactly one of several consumers, in order per producer
+static void test_stress(void)
+{
+	constexpr unsigned producers = 4;
+	constexpr unsigned consumers = 4;
+	constexpr uint32_t messages  = 100000;
+
+	os_queue_t queue = os_queue_create(sizeof(Message), 8);
+
+	std::vector<std::atomic<uint32_t>> received(producers * messages);
+	std::atomic<unsigned>              disorder(0);
+	std::vector<std::thread>           threads;
+
+	for(auto& count : received) count = 0;
+
+	for(unsigned c = 0; c < consumers; c++)
+	{
+		threads.emplace_back([&]() {
+			uint32_t last[producers];
+			bool     first[producers];
+			for(unsigned p = 0; p < producers; p++) first[p] = true;
+
+			Message message;
+			while(os_queue_receive(queue, &message, MFLOW_OS_WAIT_FOREVER) && message.producer < producers)
+			{
+				// Each consumer sees the messages of a producer in increasing order
+				if(!first[message.producer] && message.sequence <= last[message.producer]) disorder++;
+
+				first[message.producer] = false;
+				last[message.producer]  = message.sequence;
+				received[message.producer * messages + message.sequence]++;
+			}
+		});
+	}
+
+	std::vector<std::thread> senders;
+	for(uint32_t p = 0; p < producers; p++)
+	{
+		senders.emplace_back([queue, p]() {
+			for(uint32_t i = 0; i < messages; i++)
+			{
+				const Message message = { p, i };
+				os_queue_send(queue, &message, MFLOW_OS_WAIT_FOREVER);
+			}
+		});
+	}
+
+	for(auto& sender : senders) sender.join();
+
+	// Stopping the consumers with one end marker each
+	for(unsigned c = 0; c < consumers; c++)
+	{
+		const Message end = { producers, 0 };
+		os_queue_send(queue, &end, MFLOW_OS_WAIT_FOREVER);
+	}
+
+	for(auto& thread : threads) thread.join();
+
+	unsigned wrong = 0;
+	for(auto& count : received) if(count != 1) wrong++;
+
+	MFLOW_CHECK(wrong == 0);
+	MFLOW_CHECK(disorder == 0);
+	MFLOW_CHECK(os_queue_empty(queue));
+
+	os_queue_delete(queue);
+}
+
+int main()
+{
+	test_bounds();
+	test_timeouts();
+	test_blocking();
+	test_stress();
+
+	return MFLOW_TEST_RESULT();
+}
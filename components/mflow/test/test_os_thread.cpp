@@ -0,0 +1,303 @@
+// Standard includes
+#include <atomic>
+#include <cstdint>
+
+// Linux includes
+#include <unistd.h>
+
+// Project includes
+#include "os.h"
+#include "test.h"
+
+
+// Number of notifications passed back and forth in the ping-pong test
+static constexpr unsigned rounds = 100000;
+
+// State shared with the threads of the tests
+struct Shared {
+	std::atomic<os_thread_t> ping;      /**< Handle of the first thread.            */
+	std::atomic<os_thread_t> pong;      /**< Handle of the second thread.           */
+	std::atomic<uint32_t>    value;     /**< Notification value seen by a thread.   */
+	std::atomic<unsigned>    count[2];  /**< Notifications received by the threads. */
+	std::atomic<bool>        stage[2];  /**< Progress flags of the test.            */
+	std::atomic<bool>        done;      /**< Set by a thread when it finished.      */
+	os_semaphore_t           semaphore; /**< Semaphore of the semaphore test.       */
+	int                      fd;        /**< Descriptor of the polling test.        */
+
+	Shared(void) : ping(nullptr), pong(nullptr), value(0), count{ {0}, {0} }, stage{ {false}, {false} }, done(false), semaphore(nullptr), fd(-1) { }
+};
+
+static void wait_for(const std::atomic<bool>& flag)
+{
+	while(!flag) os_delay(1);
+}
+
+static void run_pending(void* p_argument)
+{
+	Shared*  shared = static_cast<Shared*>(p_argument);
+	uint32_t value  = 0;
+
+	// The notification arrives before the thread waits
+	wait_for(shared->stage[0]);
+
+	if(os_thread_wait(0, 0xFFFFFFFFU, &value, 0)) shared->value = value;
+
+	// The notification is consumed, the next wait times out
+	if(!os_thread_wait(0, 0xFFFFFFFFU, nullptr, 10)) shared->count[0]++;
+
+	shared->done = true;
+	os_thread_exit();
+}
+
+// A notification sent before the wait is not lost, and it is consumed by the wait
+static void test_pending(void)
+{
+	Shared      shared;
+	os_thread_t thread = os_thread_create(run_pending, &shared, "pending", 4096, 1);
+
+	os_thread_notify(thread, 0x5);
+	shared.stage[0] = true;
+	wait_for(shared.done);
+
+	MFLOW_CHECK(shared.value == 0x5);
+	MFLOW_CHECK(shared.count[0] == 1);
+
+	os_thread_release(thread);
+}
+
+static void run_blocked(void* p_argument)
+{
+	Shared*  shared = static_cast<Shared*>(p_argument);
+	uint32_t value  = 0;
+
+	if(os_thread_wait(0, 0xFFFFFFFFU, &value, MFLOW_OS_WAIT_FOREVER)) shared->value = value;
+
+	shared->done = true;
+	os_thread_exit();
+}
+
+// A thread blocked without timeout wakes up with the notified bits
+static void test_blocked(void)
+{
+	Shared      shared;
+	os_thread_t thread = os_thread_create(run_blocked, &shared, "blocked", 4096, 1);
+
+	os_delay(10);
+	MFLOW_CHECK(!shared.done);
+
+	os_thread_notify(thread, 0x3);
+	wait_for(shared.done);
+
+	MFLOW_CHECK(shared.value == 0x3);
+
+	os_thread_release(thread);
+}
+
+static void run_ping(void* p_argument)
+{
+	Shared* shared = static_cast<Shared*>(p_argument);
+	wait_for(shared->stage[0]);
+
+	for(unsigned i = 0; i < rounds; i++)
+	{
+		os_thread_notify(shared->pong, 0x1);
+		if(!os_thread_wait(0, 0xFFFFFFFFU, nullptr, 1000)) break;
+		shared->count[0]++;
+	}
+
+	shared->stage[1] = true;
+	os_thread_exit();
+}
+
+static void run_pong(void* p_argument)
+{
+	Shared* shared = static_cast<Shared*>(p_argument);
+	wait_for(shared->stage[0]);
+
+	for(unsigned i = 0; i < rounds; i++)
+	{
+		if(!os_thread_wait(0, 0xFFFFFFFFU, nullptr, 1000)) break;
+		shared->count[1]++;
+		os_thread_notify(shared->ping, 0x1);
+	}
+
+	shared->done = true;
+	os_thread_exit();
+}
+
+// Notifications passed back and forth between two threads are never lost
+static void test_ping_pong(void)
+{
+	Shared shared;
+
+	shared.ping     = os_thread_create(run_ping, &shared, "ping", 4096, 1);
+	shared.pong     = os_thread_create(run_pong, &shared, "pong", 4096, 1);
+	shared.stage[0] = true;
+
+	wait_for(shared.done);
+	wait_for(shared.stage[1]);
+
+	MFLOW_CHECK(shared.count[0] == rounds);
+	MFLOW_CHECK(shared.count[1] == rounds);
+
+	os_thread_release(shared.ping);
+	os_thread_release(shared.pong);
+}
+
+static void run_signaller(void* p_argument)
+{
+	Shared* shared = static_cast<Shared*>(p_argument);
+	wait_for(shared->stage[0]);
+
+	// Setting the bit as soon as the other thread is about to wait again
+	for(unsigned i = 0; i < rounds; i++)
+	{
+		if(!os_thread_wait(0, 0xFFFFFFFFU, nullptr, 1000)) break;
+		os_thread_notify(shared->pong, 0x4);
+	}
+
+	shared->stage[1] = true;
+	os_thread_exit();
+}
+
+static void run_clearer(void* p_argument)
+{
+	Shared* shared = static_cast<Shared*>(p_argument);
+	wait_for(shared->stage[0]);
+
+	for(unsigned i = 0; i < rounds; i++)
+	{
+		uint32_t value = 0;
+
+		// Waiting for the bit like a starting component, clearing it on entry
+		os_thread_notify(shared->ping, 0x1);
+		if(!os_thread_wait(0x4, 0x4, &value, 1000)) break;
+
+		if(value & 0x4) shared->count[0]++;
+		else            shared->count[1]++;
+	}
+
+	shared->done = true;
+	os_thread_exit();
+}
+
+// Clearing bits on entry never removes the bits of a notification arriving meanwhile
+static void test_clear_on_entry(void)
+{
+	Shared shared;
+
+	shared.ping     = os_thread_create(run_signaller, &shared, "signaller", 4096, 1);
+	shared.pong     = os_thread_create(run_clearer, &shared, "clearer", 4096, 1);
+	shared.stage[0] = true;
+
+	wait_for(shared.done);
+	wait_for(shared.stage[1]);
+
+	MFLOW_CHECK(shared.count[0] == rounds);
+	MFLOW_CHECK(shared.count[1] == 0);
+
+	os_thread_release(shared.ping);
+	os_thread_release(shared.pong);
+}
+
+static void run_taker(void* p_argument)
+{
+	Shared* shared = static_cast<Shared*>(p_argument);
+
+	if(os_semaphore_take(shared->semaphore, MFLOW_OS_WAIT_FOREVER)) shared->count[0]++;
+
+	shared->done = true;
+	os_thread_exit();
+}
+
+// The semaphore is binary, and a blocked taker wakes up when it is given
+static void test_semaphore(void)
+{
+	Shared shared;
+	shared.semaphore = os_semaphore_create();
+
+	MFLOW_CHECK(!os_semaphore_take(shared.semaphore, 0));
+
+	os_semaphore_give(shared.semaphore);
+	os_semaphore_give(shared.semaphore);
+	MFLOW_CHECK(os_semaphore_take(shared.semaphore, 0));
+	MFLOW_CHECK(!os_semaphore_take(shared.semaphore, 10));
+
+	os_thread_t thread = os_thread_create(run_taker, &shared, "taker", 4096, 1);
+
+	os_delay(10);
+	MFLOW_CHECK(!shared.done);
+
+	os_semaphore_give(shared.semaphore);
+	wait_for(shared.done);
+
+	MFLOW_CHECK(shared.count[0] == 1);
+
+	os_thread_release(thread);
+	os_semaphore_delete(shared.semaphore);
+}
+
+static void run_poller(void* p_argument)
+{
+	Shared*       shared = static_cast<Shared*>(p_argument);
+	os_poll_t     poll   = os_poll_create();
+	os_poll_event event;
+
+	os_poll_add(poll, shared->fd, EPOLLIN);
+
+	// Woken by the descriptor
+	if(os_poll_wait(poll, &event, 1, 0xFFFFFFFFU, MFLOW_OS_WAIT_FOREVER) == 1 && event.fd == shared->fd) shared->count[0]++;
+
+	char data;
+	if(read(shared->fd, &data, 1) != 1) shared->count[0] = 0;
+
+	// Woken by a notification, no descriptor is ready
+	shared->stage[1] = true;
+	if(os_poll_wait(poll, &event, 1, 0xFFFFFFFFU, MFLOW_OS_WAIT_FOREVER) == 0) shared->count[1]++;
+
+	os_poll_delete(poll);
+
+	shared->done = true;
+	os_thread_exit();
+}
+
+// A thread waiting on a descriptor set wakes up for ready descriptors and for notifications
+static void test_poll(void)
+{
+	int pipe_fds[2];
+	MFLOW_CHECK(pipe(pipe_fds) == 0);
+
+	Shared shared;
+	shared.fd = pipe_fds[0];
+
+	os_thread_t thread = os_thread_create(run_poller, &shared, "poller", 4096, 1);
+
+	os_delay(10);
+	MFLOW_CHECK(write(pipe_fds[1], "x", 1) == 1);
+
+	wait_for(shared.stage[1]);
+	os_delay(10);
+	MFLOW_CHECK(!shared.done);
+
+	os_thread_notify(thread, 0x1);
+	wait_for(shared.done);
+
+	MFLOW_CHECK(shared.count[0] == 1);
+	MFLOW_CHECK(shared.count[1] == 1);
+
+	os_thread_release(thread);
+	close(pipe_fds[0]);
+	close(pipe_fds[1]);
+}
+
+int main()
+{
+	test_pending();
+	test_blocked();
+	test_ping_pong();
+	test_clear_on_entry();
+	test_semaphore();
+	test_poll();
+
+	return MFLOW_TEST_RESULT();
+}
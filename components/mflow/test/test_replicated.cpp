@@ -0,0 +1,258 @@
+// Standard includes
+#include <atomic>
+#include <vector>
+
+// Project includes
+#include "os.h"
+#include "runtime.h"
+#include "test.h"
+
+
+// Number of values passed through the replicated node per phase
+static constexpr unsigned value_count = 200;
+
+/**
+ * @brief Stage multiplying its input by the gain received on its option port.
+ */
+class Scaler : public Component {
+public:
+
+	static constexpr unsigned in   = 0U;
+	static constexpr unsigned gain = 1U;
+	static constexpr unsigned out  = 0U;
+
+	Scaler(void) : m_gain(0)
+	{
+		inputs.addPort<unsigned>(in, 1);
+		inputs.addPort<unsigned>(gain, 1);
+		outputs.addPort<unsigned>(out);
+	}
+
+	static Component* create(void) { return new Scaler(); }
+
+	virtual void initialize(void) override
+	{
+		auto value = inputs[gain].receive<unsigned>();
+		if(value) m_gain = value.value();
+	}
+
+	virtual void process(void) override
+	{
+		auto index = await({in, gain});
+		if(!index) return;
+
+		if(index.value() == gain)
+		{
+			auto value = inputs[gain].receive<unsigned>();
+			if(value) m_gain = value.value();
+			return;
+		}
+
+		auto value = inputs[in].receive<unsigned>();
+		if(value) outputs[out].send<unsigned>(value.value() * m_gain);
+	}
+
+private:
+	unsigned m_gain;
+};
+
+/**
+ * @brief   Stage reading its gain only when one arrived, then blocking on its input.
+ * @details Follows the shape of BasicFrameScale and the other configured
+ *          components, the option port is not watched while waiting.
+ */
+class ConfiguredScaler : public Component {
+public:
+
+	static constexpr unsigned in   = 0U;
+	static constexpr unsigned gain = 1U;
+	static constexpr unsigned out  = 0U;
+
+	ConfiguredScaler(void) : m_gain(1)
+	{
+		inputs.addPort<unsigned>(in, 1);
+		inputs.addPort<unsigned>(gain, 1);
+		outputs.addPort<unsigned>(out);
+	}
+
+	static Component* create(void) { return new ConfiguredScaler(); }
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		if(inputs[gain].has_message())
+		{
+			auto value = inputs[gain].receive<unsigned>();
+			if(value) m_gain = value.value();
+		}
+
+		auto value = inputs[in].receive<unsigned>();
+		if(value) outputs[out].send<unsigned>(value.value() * m_gain);
+	}
+
+private:
+	unsigned m_gain;
+};
+
+/**
+ * @brief Sink collecting the received values.
+ */
+class Collector : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	Collector(void) : m_count(0)
+	{
+		inputs.addPort<unsigned>(in, 4);
+		m_values.reserve(2 * value_count);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		auto value = inputs[in].receive<unsigned>();
+		if(!value) return;
+
+		m_values.push_back(value.value());
+		m_count++;
+	}
+
+	unsigned                     count(void) const  { return m_count; }
+	const std::vector<unsigned>& values(void) const { return m_values; }
+
+private:
+	std::atomic<unsigned> m_count;
+	std::vector<unsigned> m_values;
+};
+
+static void wait_for(const Collector& collector, unsigned count)
+{
+	const os_tick_t start = os_tick_count();
+	while(collector.count() < count && os_ticks_to_ms(os_tick_count() - start) < 5000) os_delay(1);
+}
+
+// Initial messages and later changes of an option port reach every replica, the order of the stream is kept
+static void test_options(void)
+{
+	register_component("Scaler", Scaler::create);
+
+	Replicated<unsigned, unsigned>* node = add_replicated_node<unsigned, unsigned>("Scaler", "scaler", 3, Scaler::in, Scaler::out);
+	MFLOW_CHECK(node != nullptr);
+	MFLOW_CHECK(node->add_option<unsigned>(Scaler::gain));
+
+	Collector collector;
+	connect(*node, Scaler::out, collector, Collector::in);
+
+	// Every replica waits for its gain while initializing
+	add_initial("scaler", Scaler::gain, 3U);
+
+	collector.start_process();
+	start_network();
+
+	for(unsigned i = 0; i < value_count; i++) send_message(node->inputs[Scaler::in], i);
+	wait_for(collector, value_count);
+	MFLOW_CHECK(collector.count() == value_count);
+
+	// Changing the gain of every replica
+	add_initial("scaler", Scaler::gain, 5U);
+	os_delay(20);
+
+	for(unsigned i = 0; i < value_count; i++) send_message(node->inputs[Scaler::in], i);
+	wait_for(collector, 2 * value_count);
+	MFLOW_CHECK(collector.count() == 2 * value_count);
+
+	unsigned wrong = 0;
+	for(unsigned i = 0; i < collector.count(); i++)
+	{
+		const unsigned expected = i < value_count ? 3 * i : 5 * (i - value_count);
+		if(collector.values()[i] != expected) wrong++;
+	}
+	MFLOW_CHECK(wrong == 0);
+
+	stop_network();
+	collector.stop_process();
+
+	while(node->is_running() || collector.is_running()) os_delay(1);
+
+	remove_node("scaler");
+}
+
+// Option updates do not block the composite on replicas that wait for their input
+static void test_option_updates(void)
+{
+	register_component("ConfiguredScaler", ConfiguredScaler::create);
+
+	Replicated<unsigned, unsigned>* node = add_replicated_node<unsigned, unsigned>("ConfiguredScaler", "configured", 3,
+	                                                                               ConfiguredScaler::in, ConfiguredScaler::out);
+	MFLOW_CHECK(node != nullptr);
+	MFLOW_CHECK(node->add_option<unsigned>(ConfiguredScaler::gain));
+
+	Collector collector;
+	connect(*node, ConfiguredScaler::out, collector, Collector::in);
+
+	collector.start_process();
+	start_network();
+
+	// The gain fills the option port of every replica, only the first replica takes it after its frame
+	add_initial("configured", ConfiguredScaler::gain, 2U);
+	send_message(node->inputs[ConfiguredScaler::in], 1U);
+	wait_for(collector, 1);
+	MFLOW_CHECK(collector.count() == 1);
+
+	// Two updates back to back, the other replicas still hold the first gain
+	add_initial("configured", ConfiguredScaler::gain, 3U);
+	add_initial("configured", ConfiguredScaler::gain, 4U);
+
+	// Sending values until the latest gain is in the option port of every replica
+	unsigned sent = 1;
+	const os_tick_t start = os_tick_count();
+
+	while(node->has_undelivered_options() && os_ticks_to_ms(os_tick_count() - start) < 5000)
+	{
+		send_message(node->inputs[ConfiguredScaler::in], sent++);
+		wait_for(collector, sent);
+	}
+	MFLOW_CHECK(!node->has_undelivered_options());
+
+	// A replica blocked on its input takes the gain after its next value, one value per replica
+	for(unsigned r = 0; r < node->replicas(); r++) send_message(node->inputs[ConfiguredScaler::in], sent++);
+	wait_for(collector, sent);
+	MFLOW_CHECK(collector.count() == sent);
+
+	// Every output before the checked batch used one of the gains
+	unsigned wrong = 0;
+	for(unsigned i = 1; i < collector.count(); i++)
+	{
+		const unsigned out = collector.values()[i];
+		if(out != i && out != 2 * i && out != 3 * i && out != 4 * i) wrong++;
+	}
+	MFLOW_CHECK(wrong == 0);
+
+	// The latest gain reached every replica
+	const unsigned first = sent;
+	for(unsigned i = 0; i < value_count; i++) send_message(node->inputs[ConfiguredScaler::in], first + i);
+	wait_for(collector, first + value_count);
+	MFLOW_CHECK(collector.count() == first + value_count);
+
+	wrong = 0;
+	for(unsigned i = first; i < collector.count(); i++) if(collector.values()[i] != 4 * i) wrong++;
+	MFLOW_CHECK(wrong == 0);
+
+	stop_network();
+	collector.stop_process();
+
+	while(node->is_running() || collector.is_running()) os_delay(1);
+
+	remove_node("configured");
+}
+
+int main()
+{
+	test_options();
+	test_option_updates();
+
+	return MFLOW_TEST_RESULT();
+}
@@ -0,0 +1,249 @@
+// Standard includes
+#include <atomic>
+#include <cstdint>
+
+// Linux includes
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Project includes
+#include "component.h"
+#include "os.h"
+#include "test.h"
+
+
+// Number of periods waited in the periodic test
+static constexpr unsigned periods = 5;
+
+/**
+ * @brief   Component running the wait set checks from its own thread.
+ * @details The input port receives messages from the main thread, the
+ *          phase tells the main thread when the next message is expected.
+ *          A pipe and an eventfd are the descriptors of the wait sets.
+ */
+class Waiter : public Component {
+public:
+
+	static constexpr unsigned in = 0U;
+
+	Waiter(void) : phase(0), done(false)
+	{
+		inputs.addPort<unsigned>(in, 4);
+
+		m_pipe[0] = m_pipe[1] = -1;
+		MFLOW_CHECK(pipe(m_pipe) == 0);
+
+		m_event = eventfd(0, EFD_NONBLOCK);
+		MFLOW_CHECK(m_event >= 0);
+	}
+
+	virtual ~Waiter()
+	{
+		close(m_pipe[0]);
+		close(m_pipe[1]);
+		close(m_event);
+	}
+
+	virtual void initialize(void) override { }
+
+	virtual void process(void) override
+	{
+		if(done) { os_delay(1); return; }
+
+		test_one_shot();
+		test_periodic();
+		test_mixed();
+		test_descriptors();
+
+		done = true;
+	}
+
+	std::atomic<unsigned> phase; /**< Progress of the checks, read by the main thread. */
+	std::atomic<bool>     done;  /**< Set when the checks finished.                    */
+
+private:
+
+	// Milliseconds elapsed since a tick count
+	static uint32_t elapsed(os_tick_t start)
+	{
+		return os_ticks_to_ms(os_tick_count() - start);
+	}
+
+	// A one-shot timer fires once at its deadline
+	void test_one_shot(void)
+	{
+		WaitSet wait_set;
+		wait_set.set_timeout(20);
+
+		const os_tick_t start = os_tick_count();
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.timer_expired());
+		MFLOW_CHECK(elapsed(start) >= 20);
+		MFLOW_CHECK(elapsed(start) < 200);
+	}
+
+	// A periodic timer re-arms without drift and catches up after an overrun
+	void test_periodic(void)
+	{
+		WaitSet wait_set;
+		wait_set.set_period(10);
+
+		const os_tick_t start = os_tick_count();
+		for(unsigned p = 0; p < periods; p++)
+		{
+			MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+			MFLOW_CHECK(wait_set.timer_expired());
+		}
+		MFLOW_CHECK(elapsed(start) >= periods * 10);
+		MFLOW_CHECK(elapsed(start) < periods * 10 + 100);
+
+		// Overrunning three periods, the missed deadlines are reported without waiting
+		os_delay(35);
+
+		const os_tick_t overrun = os_tick_count();
+		for(unsigned p = 0; p < 3; p++)
+		{
+			MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+			MFLOW_CHECK(wait_set.timer_expired());
+		}
+		MFLOW_CHECK(elapsed(overrun) < 5);
+
+		// The next deadline stays on the original grid
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.timer_expired());
+		MFLOW_CHECK(elapsed(start) >= (periods + 4) * 10);
+		MFLOW_CHECK(elapsed(start) < (periods + 4) * 10 + 100);
+	}
+
+	// Ports and the timer are reported separately, an expired one-shot timer stays disarmed
+	void test_mixed(void)
+	{
+		WaitSet wait_set;
+		wait_set.add_port(in);
+		wait_set.set_timeout(1000);
+
+		// The message sent at the start is already waiting
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.port_ready(in));
+		MFLOW_CHECK(!wait_set.timer_expired());
+		MFLOW_CHECK(inputs[in].receive<unsigned>().value() == 1U);
+
+		// The timer fires while the port stays empty
+		wait_set.set_timeout(20);
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.timer_expired());
+		MFLOW_CHECK(!wait_set.port_ready(in));
+
+		// Only the next message ends the wait
+		const os_tick_t start = os_tick_count();
+		phase = 1;
+
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.port_ready(in));
+		MFLOW_CHECK(!wait_set.timer_expired());
+		MFLOW_CHECK(elapsed(start) >= 40);
+		MFLOW_CHECK(inputs[in].receive<unsigned>().value() == 2U);
+	}
+
+	// Descriptors are reported with the ports, messages wake a wait blocked in epoll
+	void test_descriptors(void)
+	{
+		WaitSet wait_set;
+		wait_set.add_port(in);
+		MFLOW_CHECK(wait_set.add_fd(m_pipe[0]));
+		MFLOW_CHECK(wait_set.add_fd(m_event));
+
+		// A readable descriptor alone
+		write_pipe();
+
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.fd_events(m_pipe[0]) & EPOLLIN);
+		MFLOW_CHECK(wait_set.fd_events(m_event) == 0);
+		MFLOW_CHECK(!wait_set.port_ready(in));
+		read_pipe();
+
+		// A descriptor and a port ready together are both reported
+		phase = 2;
+		while(!inputs[in].has_message()) os_delay(1);
+
+		const uint64_t increment = 1;
+		MFLOW_CHECK(write(m_event, &increment, sizeof(increment)) == (ssize_t) sizeof(increment));
+
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.fd_events(m_event) & EPOLLIN);
+		MFLOW_CHECK(wait_set.port_ready(in));
+		MFLOW_CHECK(inputs[in].receive<unsigned>().value() == 3U);
+
+		uint64_t count = 0;
+		MFLOW_CHECK(read(m_event, &count, sizeof(count)) == (ssize_t) sizeof(count));
+
+		// A message wakes the wait blocked in epoll, well before the timer
+		wait_set.set_timeout(1000);
+
+		const os_tick_t start = os_tick_count();
+		phase = 3;
+
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.port_ready(in));
+		MFLOW_CHECK(!wait_set.timer_expired());
+		MFLOW_CHECK(wait_set.fd_events(m_pipe[0]) == 0);
+		MFLOW_CHECK(wait_set.fd_events(m_event) == 0);
+		MFLOW_CHECK(elapsed(start) >= 40);
+		MFLOW_CHECK(inputs[in].receive<unsigned>().value() == 4U);
+
+		// A removed descriptor no longer ends the wait, the timer does
+		wait_set.remove_fd(m_pipe[0]);
+		wait_set.set_timeout(20);
+		write_pipe();
+
+		const os_tick_t removed = os_tick_count();
+		MFLOW_CHECK(await(wait_set) == MessageStatus::Okay);
+		MFLOW_CHECK(wait_set.timer_expired());
+		MFLOW_CHECK(wait_set.fd_events(m_pipe[0]) == 0);
+		MFLOW_CHECK(elapsed(removed) >= 20);
+		read_pipe();
+	}
+
+	void write_pipe(void)
+	{
+		const uint8_t byte = 1;
+		MFLOW_CHECK(write(m_pipe[1], &byte, 1) == 1);
+	}
+
+	void read_pipe(void)
+	{
+		uint8_t byte = 0;
+		MFLOW_CHECK(read(m_pipe[0], &byte, 1) == 1);
+	}
+
+	int m_pipe[2]; /**< Read and write ends of the pipe. */
+	int m_event;   /**< The eventfd.                      */
+};
+
+int main()
+{
+	Waiter waiter;
+	waiter.start_process();
+
+	send_message(waiter.inputs[Waiter::in], 1U);
+
+	// Sending the second message well after the waiter blocked on it
+	while(waiter.phase == 0) os_delay(1);
+	os_delay(50);
+	send_message(waiter.inputs[Waiter::in], 2U);
+
+	// The third message is sent right away, the fourth one while the waiter blocks in epoll
+	while(waiter.phase == 1) os_delay(1);
+	send_message(waiter.inputs[Waiter::in], 3U);
+
+	while(waiter.phase == 2) os_delay(1);
+	os_delay(50);
+	send_message(waiter.inputs[Waiter::in], 4U);
+
+	while(!waiter.done) os_delay(1);
+
+	waiter.stop_process();
+	while(waiter.is_running()) os_delay(1);
+
+	return MFLOW_TEST_RESULT();
+}
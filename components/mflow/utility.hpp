@@ -59,7 +59,8 @@ enum class MessageStatus {
 	Okay,         /**< The message was sent/received successfully.                            */
 	TypeMismatch, /**< The message send/receive failed due to type-mismatch.                  */
 	Terminated,   /**< The message send/receive failed due to the Component being terminated. */
-	Error         /**< The message send/receive failed due to an internal error.              */
+	Error,        /**< The message send/receive failed due to an internal error.              */
+	Full          /**< The message was not sent because the message queue was full.           */
 };
 
 /**
@@ -0,0 +1,143 @@
+#include "wait_set.h"
+
+
+WaitSet::WaitSet(void)
+	: m_port_count(0),
+	  m_deadline(0),
+	  m_period(0),
+	  m_timer_armed(false),
+	  m_timer_expired(false)
+#if !defined(ESP_PLATFORM)
+	, m_poll(nullptr),
+	  m_fd_count(0)
+#endif
+{
+	clear_ready();
+}
+
+WaitSet::~WaitSet()
+{
+#if !defined(ESP_PLATFORM)
+	os_poll_delete(m_poll);
+#endif
+}
+
+bool WaitSet::add_port(unsigned index)
+{
+	// Checking if the port is already in the set
+	for(unsigned i = 0; i < m_port_count; i++)
+	{
+		if(m_ports[i] == index) return true;
+	}
+
+	if(m_port_count == MFLOW_WAIT_MAX_PORTS) return false;
+
+	m_ports[m_port_count]      = index;
+	m_port_ready[m_port_count] = false;
+	m_port_count++;
+
+	return true;
+}
+
+void WaitSet::remove_port(unsigned index)
+{
+	for(unsigned i = 0; i < m_port_count; i++)
+	{
+		if(m_ports[i] != index) continue;
+
+		// Moving the last port into the freed slot
+		m_port_count--;
+		m_ports[i]      = m_ports[m_port_count];
+		m_port_ready[i] = m_port_ready[m_port_count];
+		return;
+	}
+}
+
+void WaitSet::set_timeout(uint32_t milliseconds)
+{
+	m_deadline    = os_tick_count() + os_ms_to_ticks(milliseconds);
+	m_period      = 0;
+	m_timer_armed = true;
+}
+
+void WaitSet::set_period(uint32_t milliseconds)
+{
+	m_period      = os_ms_to_ticks(milliseconds);
+	m_deadline    = os_tick_count() + m_period;
+	m_timer_armed = m_period != 0;
+}
+
+void WaitSet::cancel_timer(void)
+{
+	m_timer_armed = false;
+}
+
+#if !defined(ESP_PLATFORM)
+
+bool WaitSet::add_fd(int fd, uint32_t events)
+{
+	if(m_fd_count == MFLOW_WAIT_MAX_FDS) return false;
+
+	// Creating the epoll instance with the first descriptor
+	if(m_poll == nullptr) m_poll = os_poll_create();
+	if(m_poll == nullptr || !os_poll_add(m_poll, fd, events)) return false;
+
+	m_fds[m_fd_count]       = fd;
+	m_fd_events[m_fd_count] = 0;
+	m_fd_count++;
+
+	return true;
+}
+
+void WaitSet::remove_fd(int fd)
+{
+	for(unsigned i = 0; i < m_fd_count; i++)
+	{
+		if(m_fds[i] != fd) continue;
+
+		os_poll_remove(m_poll, fd);
+
+		// Moving the last descriptor into the freed slot
+		m_fd_count--;
+		m_fds[i]       = m_fds[m_fd_count];
+		m_fd_events[i] = m_fd_events[m_fd_count];
+		return;
+	}
+}
+
+uint32_t WaitSet::fd_events(int fd) const
+{
+	for(unsigned i = 0; i < m_fd_count; i++)
+	{
+		if(m_fds[i] == fd) return m_fd_events[i];
+	}
+
+	return 0;
+}
+
+#endif
+
+bool WaitSet::port_ready(unsigned index) const
+{
+	for(unsigned i = 0; i < m_port_count; i++)
+	{
+		if(m_ports[i] == index) return m_port_ready[i];
+	}
+
+	return false;
+}
+
+bool WaitSet::timer_expired(void) const
+{
+	return m_timer_expired;
+}
+
+void WaitSet::clear_ready(void)
+{
+	for(unsigned i = 0; i < MFLOW_WAIT_MAX_PORTS; i++) m_port_ready[i] = false;
+	m_timer_expired = false;
+
+#if !defined(ESP_PLATFORM)
+	for(unsigned i = 0; i < MFLOW_WAIT_MAX_FDS; i++) m_fd_events[i] = 0;
+#endif
+}
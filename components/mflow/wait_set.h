@@ -0,0 +1,142 @@
+#pragma once
+#ifndef MFLOW_WAIT_SET_H_INCLUDED
+#define MFLOW_WAIT_SET_H_INCLUDED
+
+// Standard includes
+#include <cstddef>
+#include <cstdint>
+
+// Project includes
+#include "os.h"
+
+
+// Maximum number of input ports in a wait set
+#ifndef MFLOW_WAIT_MAX_PORTS
+#define MFLOW_WAIT_MAX_PORTS (16)
+#endif
+
+// Maximum number of file descriptors in a wait set
+#ifndef MFLOW_WAIT_MAX_FDS
+#define MFLOW_WAIT_MAX_FDS (16)
+#endif
+
+/**
+ * @brief   Set of input ports, a timer and file descriptors a component waits on.
+ * @details Pass the set to Component::await() to block until any member is
+ *          ready, afterwards the set reports every member that was ready
+ *          when the call returned. The timer fires once at its deadline, or
+ *          periodically without drift when a period is set. File descriptors
+ *          are supported on Linux only, they are watched with epoll together
+ *          with the notifications of the component thread, so an I/O driven
+ *          component needs no helper thread. The descriptors stay registered
+ *          between calls, waiting costs one system call.
+ */
+class WaitSet {
+public:
+
+	// Component::await() evaluates and updates the members of the set
+	friend class Component;
+
+	/**
+	 * @brief Creates an empty wait set.
+	 */
+	WaitSet(void);
+
+	/**
+	 * @brief Destroys the wait set, the file descriptors are not closed.
+	 */
+	~WaitSet();
+
+	WaitSet(const WaitSet&)            = delete;
+	WaitSet& operator=(const WaitSet&) = delete;
+
+	/**
+	 * @brief  Adds an input port of the waiting component to the set.
+	 * @param  index [in] Index of the input port.
+	 * @retval True on success, false when the set is full.
+	 */
+	bool add_port(unsigned index);
+
+	/**
+	 * @brief Removes an input port from the set.
+	 * @param index [in] Index of the input port.
+	 */
+	void remove_port(unsigned index);
+
+	/**
+	 * @brief Arms the timer to fire once after the specified time.
+	 * @param milliseconds [in] The time until the deadline.
+	 */
+	void set_timeout(uint32_t milliseconds);
+
+	/**
+	 * @brief Arms the timer to fire periodically, the first time after one period.
+	 * @param milliseconds [in] The period of the timer, zero disarms it.
+	 */
+	void set_period(uint32_t milliseconds);
+
+	/**
+	 * @brief Disarms the timer.
+	 */
+	void cancel_timer(void);
+
+#if !defined(ESP_PLATFORM)
+
+	/**
+	 * @brief  Adds a file descriptor to the set.
+	 * @param  fd     [in] The file descriptor to watch.
+	 * @param  events [in] The epoll event flags to watch.
+	 * @retval True on success, false when the set is full or epoll failed.
+	 */
+	bool add_fd(int fd, uint32_t events = EPOLLIN);
+
+	/**
+	 * @brief Removes a file descriptor from the set.
+	 * @param fd [in] The file descriptor to remove.
+	 */
+	void remove_fd(int fd);
+
+	/**
+	 * @brief  Queries the events of a file descriptor after the last wait.
+	 * @param  fd [in] The file descriptor.
+	 * @retval The ready epoll event flags, zero when the descriptor was not ready.
+	 */
+	uint32_t fd_events(int fd) const;
+
+#endif
+
+	/**
+	 * @brief  Queries whether an input port had a message after the last wait.
+	 * @param  index [in] Index of the input port.
+	 * @retval True when the input port had a message, false otherwise.
+	 */
+	bool port_ready(unsigned index) const;
+
+	/**
+	 * @brief  Queries whether the timer fired during the last wait.
+	 * @retval True when the deadline was reached, false otherwise.
+	 */
+	bool timer_expired(void) const;
+
+private:
+
+	// Clears the results of the previous wait
+	void clear_ready(void);
+
+	unsigned  m_ports[MFLOW_WAIT_MAX_PORTS];      /**< Indices of the input ports.             */
+	bool      m_port_ready[MFLOW_WAIT_MAX_PORTS]; /**< Readiness of the input ports.           */
+	unsigned  m_port_count;                       /**< Number of input ports in the set.       */
+	os_tick_t m_deadline;                         /**< Deadline of the timer.                  */
+	os_tick_t m_period;                           /**< Period of the timer, zero for one-shot. */
+	bool      m_timer_armed;                      /**< Whether the timer is armed.             */
+	bool      m_timer_expired;                    /**< Whether the timer fired.                */
+
+#if !defined(ESP_PLATFORM)
+	os_poll_t m_poll;                             /**< Epoll instance of the descriptors.      */
+	int       m_fds[MFLOW_WAIT_MAX_FDS];          /**< The watched file descriptors.           */
+	uint32_t  m_fd_events[MFLOW_WAIT_MAX_FDS];    /**< Ready events of the descriptors.        */
+	unsigned  m_fd_count;                         /**< Number of descriptors in the set.       */
+#endif
+};
+
+#endif // MFLOW_WAIT_SET_H_INCLUDED
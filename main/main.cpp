@@ -3,42 +3,149 @@
 #include "esp_log.h"
 #include "driver/uart.h"
 
+#include "adder.h"
+#include "arithmetic.h"
+#include "biquad.h"
+#include "envelope.h"
+#include "fft.h"
+#include "fir.h"
+#include "goertzel.h"
+#include "histogram.h"
+#include "median.h"
 #include "moving_avg.h"
 #include "rect_wave.h"
 #include "plotter.h"
+#include "resample.h"
+#include "router.h"
+#include "statistics.h"
+#include "sync.h"
+#include "trigger.h"
 #include "runtime.h"
 
 #include "i2c/i2c.h"
+#include "i2c/i2c_poller.h"
 #include "sine.h"
 
 extern "C" {
 	void app_main(void);
 }
 
-class Adder : public Component {
-public:
-	Adder() {
-		inputs.addPort<double>(0, 10);
-		inputs.addPort<double>(1, 10);
-		outputs.addPort<double>(0);
-	}
-
-	virtual void initialize(void) { return; }
-
-	virtual void process(void) override {
-		outputs[0].send<double>((double) inputs[0].receive<double>() + (double) inputs[1].receive<double>());
-	}
-};
-
 void runtime_test(void)
 {
 	register_component("RectifiedWave", [](){ return (Component*) new RectifiedWave(); });
 	register_component("MovingAverage", [](){ return (Component*) new MovingAverage(); });
 	register_component("Plotter",       [](){ return (Component*) new Plotter();       });
 	//register_component("I2C",           [](){ return (Component*) new I2C_Master();    });
+	//register_component("I2C_Poller<4>", [](){ return (Component*) new I2C_Poller<4>(); });
 	register_component("SineWave",      [](){ return (Component*) new SineWave();      });
 	register_component("Adder",         [](){ return (Component*) new Adder();         });
 
+	// Single precision and fixed-point variants of the signal components
+	register_component("RectifiedWave<float>", [](){ return (Component*) new BasicRectifiedWave<float>(); });
+	register_component("RectifiedWave<q15>",   [](){ return (Component*) new BasicRectifiedWave<q15>();   });
+	register_component("RectifiedWave<q31>",   [](){ return (Component*) new BasicRectifiedWave<q31>();   });
+	register_component("MovingAverage<float>", [](){ return (Component*) new BasicMovingAverage<float>(); });
+	register_component("MovingAverage<q15>",   [](){ return (Component*) new BasicMovingAverage<q15>();   });
+	register_component("MovingAverage<q31>",   [](){ return (Component*) new BasicMovingAverage<q31>();   });
+	register_component("Plotter<float>",       [](){ return (Component*) new BasicPlotter<float>();       });
+	register_component("Plotter<q15>",         [](){ return (Component*) new BasicPlotter<q15>();         });
+	register_component("Plotter<q31>",         [](){ return (Component*) new BasicPlotter<q31>();         });
+	register_component("SineWave<float>",      [](){ return (Component*) new BasicSineWave<float>();      });
+	register_component("SineWave<q15>",        [](){ return (Component*) new BasicSineWave<q15>();        });
+	register_component("SineWave<q31>",        [](){ return (Component*) new BasicSineWave<q31>();        });
+	register_component("Adder<float>",         [](){ return (Component*) new BasicAdder<float>();         });
+	register_component("Adder<q15>",           [](){ return (Component*) new BasicAdder<q15>();           });
+	register_component("Adder<q31>",           [](){ return (Component*) new BasicAdder<q31>();           });
+
+	// Frame arithmetic components
+	register_component("FrameAdd2",            [](){ return (Component*) new BasicFrameAdd<double, 2>();      });
+	register_component("FrameAdd2<float>",     [](){ return (Component*) new BasicFrameAdd<float, 2>();       });
+	register_component("FrameAdd2<q15>",       [](){ return (Component*) new BasicFrameAdd<q15, 2>();         });
+	register_component("FrameAdd4<float>",     [](){ return (Component*) new BasicFrameAdd<float, 4>();       });
+	register_component("FrameSubtract",        [](){ return (Component*) new BasicFrameSubtract<double>();    });
+	register_component("FrameSubtract<float>", [](){ return (Component*) new BasicFrameSubtract<float>();     });
+	register_component("FrameSubtract<q15>",   [](){ return (Component*) new BasicFrameSubtract<q15>();       });
+	register_component("FrameMultiply2",       [](){ return (Component*) new BasicFrameMultiply<double, 2>(); });
+	register_component("FrameMultiply2<float>",[](){ return (Component*) new BasicFrameMultiply<float, 2>();  });
+	register_component("FrameMultiply2<q15>",  [](){ return (Component*) new BasicFrameMultiply<q15, 2>();    });
+	register_component("FrameScale",           [](){ return (Component*) new BasicFrameScale<double>();       });
+	register_component("FrameScale<float>",    [](){ return (Component*) new BasicFrameScale<float>();        });
+	register_component("FrameScale<q15>",      [](){ return (Component*) new BasicFrameScale<q15>();          });
+	register_component("FrameMix2",            [](){ return (Component*) new BasicFrameMix<double, 2>();      });
+	register_component("FrameMix2<float>",     [](){ return (Component*) new BasicFrameMix<float, 2>();       });
+	register_component("FrameMix4<float>",     [](){ return (Component*) new BasicFrameMix<float, 4>();       });
+	register_component("FrameMix4<q15>",       [](){ return (Component*) new BasicFrameMix<q15, 4>();         });
+
+	// FIR filter components
+	register_component("FirFilter",              [](){ return (Component*) new BasicFirFilter<double>();        });
+	register_component("FirFilter<float>",       [](){ return (Component*) new BasicFirFilter<float>();         });
+	register_component("FirFilter<q15>",         [](){ return (Component*) new BasicFirFilter<q15>();           });
+	register_component("FirDecimator",           [](){ return (Component*) new BasicFirDecimator<double>();     });
+	register_component("FirDecimator<float>",    [](){ return (Component*) new BasicFirDecimator<float>();      });
+	register_component("FirDecimator<q15>",      [](){ return (Component*) new BasicFirDecimator<q15>();        });
+	register_component("FirInterpolator",        [](){ return (Component*) new BasicFirInterpolator<double>();  });
+	register_component("FirInterpolator<float>", [](){ return (Component*) new BasicFirInterpolator<float>();   });
+	register_component("FirInterpolator<q15>",   [](){ return (Component*) new BasicFirInterpolator<q15>();     });
+
+	// IIR filter components
+	register_component("BiquadCascade",        [](){ return (Component*) new BasicBiquadCascade<double>(); });
+	register_component("BiquadCascade<float>", [](){ return (Component*) new BasicBiquadCascade<float>();  });
+	register_component("BiquadCascade<q15>",   [](){ return (Component*) new BasicBiquadCascade<q15>();    });
+
+	// Spectral analysis components
+	register_component("FftAnalyzer",        [](){ return (Component*) new BasicFftAnalyzer<double>(); });
+	register_component("FftAnalyzer<float>", [](){ return (Component*) new BasicFftAnalyzer<float>();  });
+	register_component("FftAnalyzer<q15>",   [](){ return (Component*) new BasicFftAnalyzer<q15>();    });
+
+	// Sample-rate converter components
+	register_component("Decimator",           [](){ return (Component*) new BasicDecimator<double>();    });
+	register_component("Decimator<float>",    [](){ return (Component*) new BasicDecimator<float>();     });
+	register_component("Decimator<q15>",      [](){ return (Component*) new BasicDecimator<q15>();       });
+	register_component("Interpolator",        [](){ return (Component*) new BasicInterpolator<double>(); });
+	register_component("Interpolator<float>", [](){ return (Component*) new BasicInterpolator<float>();  });
+	register_component("Interpolator<q15>",   [](){ return (Component*) new BasicInterpolator<q15>();    });
+
+	// Stream statistics components
+	register_component("Statistics",        [](){ return (Component*) new BasicStatistics<double>(); });
+	register_component("Statistics<float>", [](){ return (Component*) new BasicStatistics<float>();  });
+	register_component("Statistics<q15>",   [](){ return (Component*) new BasicStatistics<q15>();    });
+
+	// Median filter components
+	register_component("MedianFilter",        [](){ return (Component*) new BasicMedianFilter<double>(); });
+	register_component("MedianFilter<float>", [](){ return (Component*) new BasicMedianFilter<float>();  });
+	register_component("MedianFilter<q15>",   [](){ return (Component*) new BasicMedianFilter<q15>();    });
+
+	// Stream synchronization components
+	register_component("Timestamper",           [](){ return (Component*) new BasicTimestamper<double>();       });
+	register_component("Timestamper<float>",    [](){ return (Component*) new BasicTimestamper<float>();        });
+	register_component("Synchronizer2",         [](){ return (Component*) new BasicSynchronizer<double, 2>();   });
+	register_component("Synchronizer2<float>",  [](){ return (Component*) new BasicSynchronizer<float, 2>();    });
+	register_component("Synchronizer3",         [](){ return (Component*) new BasicSynchronizer<double, 3>();   });
+
+	// Content-based routers, frames are routed by their sequence number
+	register_component("FrameRouter2",        [](){ return (Component*) new Router<Frame<double>, 2>([](const Frame<double>& frame) { return frame.sequence % MFLOW_ROUTER_KEYS; }); });
+	register_component("FrameRouter2<float>", [](){ return (Component*) new Router<Frame<float>, 2>([](const Frame<float>& frame)   { return frame.sequence % MFLOW_ROUTER_KEYS; }); });
+
+	// Trigger and event detector components
+	register_component("Trigger",        [](){ return (Component*) new BasicTrigger<double>(); });
+	register_component("Trigger<float>", [](){ return (Component*) new BasicTrigger<float>();  });
+	register_component("Trigger<q15>",   [](){ return (Component*) new BasicTrigger<q15>();    });
+
+	// Tone detector components
+	register_component("GoertzelBank",        [](){ return (Component*) new BasicGoertzelBank<double>(); });
+	register_component("GoertzelBank<float>", [](){ return (Component*) new BasicGoertzelBank<float>();  });
+	register_component("GoertzelBank<q15>",   [](){ return (Component*) new BasicGoertzelBank<q15>();    });
+
+	// Envelope and RMS detector components
+	register_component("Envelope",        [](){ return (Component*) new BasicEnvelope<double>(); });
+	register_component("Envelope<float>", [](){ return (Component*) new BasicEnvelope<float>();  });
+	register_component("Envelope<q15>",   [](){ return (Component*) new BasicEnvelope<q15>();    });
+
+	// Histogram components
+	register_component("Histogram",        [](){ return (Component*) new BasicHistogram<double>(); });
+	register_component("Histogram<float>", [](){ return (Component*) new BasicHistogram<float>();  });
+	register_component("Histogram<q15>",   [](){ return (Component*) new BasicHistogram<q15>();    });
+
 	add_node("RectifiedWave", "PWM");
 	//add_node("MovingAverage",  "MA");
 	add_node("Plotter",      "PLOT");
@@ -96,9 +203,10 @@ void app_main(void)
 	MovingAverage sink;
 
 	// Sending initial messages to Components
-	send_message<unsigned>(source.inputs[RectifiedWave::period], 10);
-	send_message<unsigned>(source.inputs[RectifiedWave::duty],   40);
-	send_message<unsigned>(sink.inputs[MovingAverage::width],     4);
+	send_message<unsigned>(source.inputs[RectifiedWave::period],   10);
+	send_message<unsigned>(source.inputs[RectifiedWave::duty],     40);
+	send_message<unsigned>(source.inputs[RectifiedWave::interval],  0);
+	send_message<unsigned>(sink.inputs[MovingAverage::width],       4);
 
 	// Connecting the output of the first Component to the input of the second Component
 	connect(source, RectifiedWave::out, sink, MovingAverage::in);
@@ -107,14 +215,14 @@ void app_main(void)
 	source.start_process();
 	sink.start_process();
 
-	// Manually sending clock messages to the first component
-	for(int i = 0; i < 1000; i++) {
+	// Manually sending clock messages to the first component, each one generates a frame
+	for(std::size_t i = 0; i < 1000; i += Frame<double>::length) {
 
 		// Sending a message to act as a clock tick
 		send_message<bool>(source.inputs[RectifiedWave::clk], true);
 
-		// Waiting for the next clock cyle
-		vTaskDelay(10 / portTICK_RATE_MS);
+		// Waiting for the next clock cycle, 10 ms per generated sample
+		vTaskDelay(Frame<double>::length * 10 / portTICK_RATE_MS);
 	}
 
 	// Signalling the Components to stop